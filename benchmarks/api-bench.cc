@@ -0,0 +1,186 @@
+#include "sgl-bench.h"
+
+#include <string>
+
+// Per call cost of the SimpleGL API on a real driver: building resources,
+// binding, setting uniforms by name, uploading textures and building
+// vertex arrays. Buffer upload strategies are covered by bufferupdate-bench
+// and map-bench, and the CPU side alone by overhead-bench.
+//
+// Run on Mesa without a GPU with LIBGL_ALWAYS_SOFTWARE=1.
+
+static const size_t ITERATIONS = 5;
+
+using Point = sgl::vec4f;
+
+template <class F>
+static void run (const std::string& name, size_t ops, F&& op) {
+    double ms = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t i = 0; i < ops; i++) op(i);
+        });
+    });
+    bench::report(name.c_str(), ops, ms);
+}
+
+static sgl::TextureBuilder2D rgba8 () {
+    sgl::TextureBuilder2D builder;
+    builder.format(GL_RGBA, GL_RGBA8).dataType(GL_UNSIGNED_BYTE);
+    return builder;
+}
+
+static void creation () {
+    run("build Texture2D 64x64", 1000, [] (size_t) {
+        sgl::Texture2D texture = rgba8().build(64, 64);
+        texture.release();
+    });
+
+    run("build Surface2D 64x64", 1000, [] (size_t) {
+        sgl::Texture2D texture = rgba8().build(64, 64);
+        sgl::Surface2D surface(texture);
+        surface.release();
+    });
+
+    run("compile and link Shader", 100, [] (size_t) {
+        sgl::Shader shader = bench::pointShader();
+        shader.release();
+    });
+}
+
+static void binds () {
+    sgl::ArrayBuffer<Point> a;
+    sgl::ArrayBuffer<Point> b;
+    sgl::Texture2D texA = rgba8().build(4, 4);
+    sgl::Texture2D texB = rgba8().build(4, 4);
+    sgl::BindCache cache;
+
+    for (sgl::BindCache* c : {(sgl::BindCache*)nullptr, &cache}) {
+        sgl::setBindCache(c);
+        std::string suffix = c == nullptr ? "" : " (bind cache)";
+        run("bind same buffer" + suffix, 100000, [&] (size_t) {
+            a.bind();
+        });
+        run("bind alternating buffers" + suffix, 100000, [&] (size_t i) {
+            if (i & 1) a.bind();
+            else b.bind();
+        });
+        run("bind alternating textures" + suffix, 100000, [&] (size_t i) {
+            if (i & 1) texA.bind();
+            else texB.bind();
+        });
+        cache.invalidate();
+    }
+    sgl::setBindCache(nullptr);
+
+    texB.release();
+    texA.release();
+    b.release();
+    a.release();
+}
+
+static void uniforms () {
+    sgl::Shader shader = sgl::compileShader(
+        "#version 330 core\n"
+        "layout(location = 0) in vec4 pos;\n"
+        "uniform mat4 Transform;\n"
+        "void main () { gl_Position = Transform * pos; }\n",
+        "#version 330 core\n"
+        "uniform float Alpha;\n"
+        "uniform vec4 Color;\n"
+        "out vec4 color;\n"
+        "void main () { color = Color * Alpha; }\n");
+    shader.bind();
+
+    float matrix[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+    const size_t ops = 100000;
+
+    // What setUniform does without the lookup
+    GLint location = glGetUniformLocation(shader, "Alpha");
+    run("glUniform1f (cached location)", ops, [&] (size_t i) {
+        glUniform1f(location, float(i));
+    });
+    run("setUniform1f", ops, [&] (size_t i) {
+        shader.setUniform1f("Alpha", float(i));
+    });
+    run("setUniform4fv", ops, [&] (size_t i) {
+        shader.setUniform4fv("Color", float(i), 0, 0, 1);
+    });
+    run("setUniformMatrix4f", ops, [&] (size_t i) {
+        matrix[12] = float(i);
+        shader.setUniformMatrix4f("Transform", matrix);
+    });
+
+    shader.release();
+}
+
+static void textureUploads () {
+    sgl::PBOUploader uploader(3);
+
+    for (size_t size : {64, 512, 2048}) {
+        std::vector<uint8_t> pixels(size * size * 4, 127);
+        sgl::Texture2D texture = rgba8().build(size, size);
+        std::string suffix = " " + std::to_string(size) + "x" + std::to_string(size);
+        size_t ops = std::max<size_t>(8, 4096 * 4096 / (size * size) / 4);
+
+        run("updateTexture" + suffix, ops, [&] (size_t) {
+            sgl::updateTexture(texture, pixels.data());
+        });
+        run("PBOUploader::upload" + suffix, ops, [&] (size_t) {
+            uploader.upload(texture, pixels.data());
+        });
+        run("build with data" + suffix, ops, [&] (size_t) {
+            sgl::Texture2D fresh = rgba8().build(pixels.data(), size, size);
+            fresh.release();
+        });
+        texture.release();
+    }
+}
+
+static void vertexArrays () {
+    sgl::ArrayBuffer<Point> positions;
+    sgl::ArrayBuffer<Point> normals;
+    sgl::ArrayBuffer<Point> frames[2];
+    sgl::ElementArrayBuffer<uint32_t> elements;
+
+    run("VertexArray build and commit", 10000, [&] (size_t) {
+        sgl::VertexArray vao;
+        sgl::VertexAttribBuilder(vao)
+            .addElementBuffer(elements)
+            .addBuffer<Point>(positions)
+            .addBuffer<Point>(normals)
+            .addBuffer<sgl::vec2f, sgl::vec2f>(frames[0])
+            .commit();
+        vao.release();
+    });
+
+    sgl::VertexArray vao;
+    sgl::VertexAttribBuilder builder(vao);
+    builder.addElementBuffer(elements)
+           .addBuffer<Point>(positions)
+           .addBuffer<Point>(normals)
+           .addBuffer<sgl::vec2f, sgl::vec2f>(frames[0])
+           .commit();
+    run("VertexAttribBuilder::commit", 10000, [&] (size_t) {
+        builder.commit();
+    });
+    run("replaceBuffer and commit", 10000, [&] (size_t i) {
+        builder.replaceBuffer(frames[i & 1], frames[(i + 1) & 1]).commit();
+    });
+
+    vao.release();
+    elements.release();
+    frames[1].release();
+    frames[0].release();
+    normals.release();
+    positions.release();
+}
+
+int main () {
+    sgl::Context ctx = bench::createContext("api-bench");
+
+    creation();
+    binds();
+    uniforms();
+    textureUploads();
+    vertexArrays();
+}
@@ -0,0 +1,118 @@
+#include "sgl-bench.h"
+
+#include <string>
+
+// Per frame buffer updates across payload sizes. Each frame uploads the
+// payload and draws from it, so strategies that overwrite storage the GPU
+// is still reading pay for the implicit synchronization.
+//
+// Run on Mesa without a GPU with LIBGL_ALWAYS_SOFTWARE=1.
+
+static const size_t FRAMES = 200;
+static const size_t ITERATIONS = 5;
+
+using Point = sgl::vec4f;
+using Interface = sgl::detail::GLBufferInterface<GL_ARRAY_BUFFER>;
+
+template <class F>
+static void run (const std::string& name, size_t count, F&& upload) {
+    std::vector<Point> data(count, Point{{0,0,0,1}});
+    double ms = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t i = 0; i < FRAMES; i++) {
+                data[i % count].values[0] = i;
+                upload(data, i);
+                glDrawArrays(GL_POINTS, 0, count);
+            }
+        });
+    });
+    bench::report((name + " " + std::to_string(count * sizeof(Point)) + "B").c_str(), FRAMES, ms);
+}
+
+static void attach (GLuint buffer) {
+    sgl::bind<GL_ARRAY_BUFFER>(buffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+}
+
+int main () {
+    sgl::Context ctx = bench::createContext("bufferupdate-bench");
+    sgl::Shader shader = bench::pointShader();
+    shader.bind();
+
+    sgl::VertexArray vao;
+    vao.bind();
+    glEnableVertexAttribArray(0);
+
+    for (size_t count : {64, 4096, 65536, 1048576}) {
+        {
+            // Reallocate every frame, what sgl::bufferData does
+            sgl::ArrayBufferMut<Point> buffer;
+            Interface::initializeMut(buffer, NULL, count * sizeof(Point), GL_DYNAMIC_DRAW);
+            attach(buffer);
+            run("bufferData", count, [&] (std::vector<Point>& d, size_t) {
+                sgl::bufferData(buffer, d, GL_DYNAMIC_DRAW);
+            });
+            buffer.release();
+        }
+        {
+            // Always write in place
+            sgl::ArrayBufferMut<Point> buffer;
+            Interface::initializeMut(buffer, NULL, count * sizeof(Point), GL_DYNAMIC_DRAW);
+            attach(buffer);
+            run("subdata", count, [&] (std::vector<Point>& d, size_t) {
+                Interface::update(buffer, reinterpret_cast<const char*>(&d[0]), 0, d.size() * sizeof(Point));
+            });
+            buffer.release();
+        }
+        {
+            // Whole buffer rewrites orphan
+            sgl::ArrayBufferSized<Point> buffer(count, GL_DYNAMIC_DRAW);
+            attach(buffer);
+            run("update", count, [&] (std::vector<Point>& d, size_t) {
+                buffer.update(d);
+            });
+            buffer.release();
+        }
+        {
+            // One element changes per frame
+            sgl::ArrayBufferSized<Point> buffer(count, GL_DYNAMIC_DRAW);
+            attach(buffer);
+            buffer.update(std::vector<Point>(count, Point{{0,0,0,1}}));
+            run("update dirty range", count, [&] (std::vector<Point>& d, size_t frame) {
+                buffer.markDirty(frame % count, 1);
+                buffer.flush(&d[0]);
+            });
+            buffer.release();
+        }
+    }
+
+    // The array grows by one element every frame
+    const size_t appends = FRAMES * 50;
+    std::vector<Point> data;
+    sgl::ArrayBufferMut<Point> mut;
+    double mutMs = bench::timeMs([&] () {
+        for (size_t i = 0; i < appends; i++) {
+            data.push_back(Point{{0,0,0,1}});
+            sgl::bufferData(mut, data, GL_DYNAMIC_DRAW);
+        }
+    });
+
+    data.clear();
+    sgl::ArrayBufferSized<Point> sized;
+    double sizedMs = bench::timeMs([&] () {
+        for (size_t i = 0; i < appends; i++) {
+            data.push_back(Point{{0,0,0,1}});
+            sized.update(data);
+        }
+    });
+
+    bench::report("append bufferData", appends, mutMs);
+    bench::report("append update", appends, sizedMs);
+    printf("  update: %lu grows, %lu orphans, %lu subdata\n",
+           (unsigned long)sized.stats().grows, (unsigned long)sized.stats().orphans, (unsigned long)sized.stats().subdata);
+
+    mut.release();
+    sized.release();
+    vao.release();
+    shader.release();
+}
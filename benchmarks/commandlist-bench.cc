@@ -0,0 +1,126 @@
+#include "sgl-bench.h"
+
+#include <SimpleGL/helpers/slab.h>
+
+// A fixed chain of ping-pong passes, like the fluid solver's jacobi
+// iterations, issued immediately through Shader and bind_guard against the
+// same chain recorded once into a CommandList and replayed, with and without
+// a BindCache installed. Surfaces are tiny so CPU submission dominates.
+//
+// Run on Mesa without a GPU with LIBGL_ALWAYS_SOFTWARE=1.
+
+static const size_t FRAMES = 200;
+static const size_t PASSES = 40;
+static const size_t ITERATIONS = 5;
+static const size_t SIZE = 16;
+
+static const char* VERTEX_SRC =
+    "#version 330 core\n"
+    "void main () {\n"
+    "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* FRAGMENT_SRC =
+    "#version 330 core\n"
+    "uniform sampler2D Pressure;\n"
+    "uniform sampler2D Divergence;\n"
+    "uniform float Alpha;\n"
+    "uniform float InverseBeta;\n"
+    "out vec4 color;\n"
+    "void main () {\n"
+    "    ivec2 c = ivec2(gl_FragCoord.xy);\n"
+    "    color = (texelFetch(Pressure, c, 0) + Alpha * texelFetch(Divergence, c, 0)) * InverseBeta;\n"
+    "}\n";
+
+struct Scene {
+    sgl::Shader shader;
+    sgl::VertexArray vao;
+    sgl::Slab2D pressure;
+    sgl::Surface2D divergence;
+};
+
+static sgl::Texture2D surfaceTexture () {
+    return sgl::TextureBuilder2D()
+        .format(GL_RGBA, GL_RGBA32F)
+        .dataType(GL_FLOAT)
+        .build(SIZE, SIZE);
+}
+
+static void immediate (Scene& scene) {
+    for (size_t i = 0; i < PASSES; i++) {
+        sgl::Surface2D& dest = scene.pressure.ping();
+        auto bg = sgl::bind_guard(dest.fbo);
+        glViewport(0, 0, SIZE, SIZE);
+        scene.shader.bind();
+        scene.shader.setTexture("Pressure", scene.pressure.pong().texture, 0);
+        scene.shader.setTexture("Divergence", scene.divergence.texture, 1);
+        scene.shader.setUniform1f("Alpha", -1.0f);
+        scene.shader.setUniform1f("InverseBeta", 0.25f);
+        scene.vao.bind();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        scene.pressure.swap();
+    }
+}
+
+// PASSES is even, so one recording covers every frame
+static void record (Scene& scene, sgl::CommandList& list) {
+    for (size_t i = 0; i < PASSES; i++) {
+        sgl::Surface2D& dest = scene.pressure.ping();
+        list.bind(dest.fbo);
+        list.viewport(0, 0, SIZE, SIZE);
+        list.bind(scene.shader);
+        list.texture(scene.shader, "Pressure", scene.pressure.pong().texture, 0);
+        list.texture(scene.shader, "Divergence", scene.divergence.texture, 1);
+        list.uniform(scene.shader, "Alpha", -1.0f);
+        list.uniform(scene.shader, "InverseBeta", 0.25f);
+        list.bind(scene.vao);
+        list.drawArrays(GL_TRIANGLES, 0, 3);
+        scene.pressure.swap();
+    }
+    list.bind(GL_FRAMEBUFFER, 0);
+    list.end();
+}
+
+template <class F>
+static void run (const char* name, F&& frame) {
+    double ms = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t i = 0; i < FRAMES; i++) frame();
+        });
+    });
+    bench::report(name, FRAMES * PASSES, ms);
+}
+
+int main () {
+    sgl::Context ctx = bench::createContext("commandlist-bench");
+
+    sgl::Texture2D a = surfaceTexture();
+    sgl::Texture2D b = surfaceTexture();
+    sgl::Texture2D d = surfaceTexture();
+    Scene scene{
+        sgl::compileShader(VERTEX_SRC, FRAGMENT_SRC),
+        sgl::VertexArray(),
+        sgl::Slab2D(a, b),
+        sgl::Surface2D(d)
+    };
+
+    sgl::CommandList list;
+    record(scene, list);
+    printf("recorded %lu commands, %lu after collapsing\n",
+           (unsigned long)list.stats().recorded, (unsigned long)list.size());
+
+    run("immediate", [&] () { immediate(scene); });
+    run("command list", [&] () { list.replay(); });
+
+    sgl::BindCache cache;
+    sgl::setBindCache(&cache);
+    run("immediate (bind cache)", [&] () { immediate(scene); });
+    run("command list (bind cache)", [&] () { list.replay(); });
+    sgl::setBindCache(nullptr);
+
+    scene.pressure.release();
+    scene.divergence.release();
+    scene.vao.release();
+    scene.shader.release();
+}
@@ -0,0 +1,55 @@
+#include "sgl-bench.h"
+
+#include <string>
+
+// Load time throughput of GLResource construction and release, with and
+// without a HandlePool installed.
+
+static const size_t COUNT = 100000;
+static const size_t ITERATIONS = 5;
+
+template <GLenum kind>
+static void run (const char* name, sgl::HandlePool* pool) {
+    sgl::setHandlePool(pool);
+    std::vector<sgl::GLResource<kind>> resources;
+    resources.reserve(COUNT);
+
+    double create = bench::medianMs(ITERATIONS, [&] () {
+        resources.clear();
+        double ms = bench::timeMs([&] () {
+            for (size_t i = 0; i < COUNT; i++) resources.emplace_back();
+        });
+        for (auto& res : resources) res.release();
+        if (pool != nullptr) pool->flush();
+        return ms;
+    });
+
+    double release = bench::medianMs(ITERATIONS, [&] () {
+        resources.clear();
+        for (size_t i = 0; i < COUNT; i++) resources.emplace_back();
+        return bench::timeMs([&] () {
+            for (auto& res : resources) res.release();
+            if (pool != nullptr) pool->flush();
+        });
+    });
+
+    std::string label(name);
+    bench::report((label + " create").c_str(), COUNT, create);
+    bench::report((label + " release").c_str(), COUNT, release);
+    sgl::setHandlePool(nullptr);
+}
+
+int main () {
+    sgl::Context ctx = bench::createContext("handlepool-bench");
+
+    run<GL_ARRAY_BUFFER>("buffer (no pool)", nullptr);
+    run<GL_TEXTURE_2D>("texture (no pool)", nullptr);
+
+    for (size_t chunk : {64, 1024}) {
+        sgl::HandlePool pool(chunk);
+        std::string suffix = " (pool " + std::to_string(chunk) + ")";
+        run<GL_ARRAY_BUFFER>(("buffer" + suffix).c_str(), &pool);
+        run<GL_TEXTURE_2D>(("texture" + suffix).c_str(), &pool);
+        pool.clear();
+    }
+}
@@ -0,0 +1,88 @@
+#include "sgl-bench.h"
+
+#include <string>
+
+// count small meshes sharing one vertex array, drawn with a loop of
+// glDrawElements against a single glMultiDrawElementsIndirect call over an
+// IndirectBatch. Triangles are tiny so per draw CPU cost dominates.
+//
+// Run on Mesa without a GPU with LIBGL_ALWAYS_SOFTWARE=1.
+
+static const size_t FRAMES = 50;
+static const size_t ITERATIONS = 5;
+
+using Point = sgl::vec4f;
+
+static void run (size_t count) {
+    // Every mesh is a quad with its own four vertices and pre offset indices
+    std::vector<Point> vertices;
+    std::vector<GLuint> indices;
+    for (size_t i = 0; i < count; i++) {
+        float x = (i % 256) / 128.0f - 1.0f;
+        float y = (i / 256 % 256) / 128.0f - 1.0f;
+        float d = 1.0f / 256;
+        GLuint base = vertices.size();
+        vertices.push_back(Point{{x, y, 0, 1}});
+        vertices.push_back(Point{{x + d, y, 0, 1}});
+        vertices.push_back(Point{{x + d, y + d, 0, 1}});
+        vertices.push_back(Point{{x, y + d, 0, 1}});
+        for (GLuint idx : {0, 1, 2, 0, 2, 3}) indices.push_back(base + idx);
+    }
+
+    sgl::VertexArray vao;
+    sgl::ArrayBuffer<Point> vbo(vertices.data(), vertices.size());
+    sgl::ElementArrayBuffer<> ebo(indices.data(), indices.size());
+    sgl::bind<GL_VERTEX_ARRAY>(vao);
+    sgl::bind<GL_ARRAY_BUFFER>(vbo);
+    sgl::bind<GL_ELEMENT_ARRAY_BUFFER>(ebo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+
+    sgl::IndirectBatch<sgl::DrawElementsIndirectCommand> batch(GL_STATIC_DRAW);
+    for (size_t i = 0; i < count; i++) batch.add(sgl::drawElementsCommand(6, i * 6));
+    batch.upload();
+
+    double loop = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t f = 0; f < FRAMES; f++) {
+                sgl::bind<GL_VERTEX_ARRAY>(vao);
+                for (size_t i = 0; i < count; i++) {
+                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (GLvoid*)(i * 6 * sizeof(GLuint)));
+                }
+            }
+        });
+    });
+
+    double indirect = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t f = 0; f < FRAMES; f++) batch.submit(vao, GL_TRIANGLES);
+        });
+    });
+
+    std::string suffix = " " + std::to_string(count) + " meshes";
+    bench::report(("glDrawElements loop" + suffix).c_str(), FRAMES * count, loop);
+    bench::report(("multi draw indirect" + suffix).c_str(), FRAMES * count, indirect);
+
+    batch.release();
+    ebo.release();
+    vbo.release();
+    vao.release();
+}
+
+int main () {
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setTitle("indirect-bench")
+        .setSize(256, 256)
+        .setVisible(false)
+        .setGLVersion(4, 3)
+        .build();
+
+    sgl::Shader shader = bench::pointShader();
+    shader.bind();
+
+    if (!SGL_MULTIDRAWINDIRECT_SUPPORTED) printf("glMultiDrawElementsIndirect unsupported, falling back to glDrawElementsIndirect\n");
+
+    for (size_t count : {1000, 10000, 50000}) run(count);
+
+    shader.release();
+}
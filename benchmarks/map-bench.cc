@@ -0,0 +1,97 @@
+#include "sgl-bench.h"
+
+#include <string.h>
+#include <string>
+
+// Cost of writing a buffer the GPU reads every frame through each BufferView
+// mapping policy, against glMapBuffer and glBufferSubData. Policies that
+// synchronize stall on the previous frame's draw.
+//
+// Run on Mesa without a GPU with LIBGL_ALWAYS_SOFTWARE=1.
+
+static const size_t FRAMES = 200;
+static const size_t ITERATIONS = 5;
+
+// Unsynchronized writes append into one of SEGMENTS slices so they never
+// touch data a queued draw is reading
+static const size_t SEGMENTS = 4;
+
+using Point = sgl::vec4f;
+using Buffer = sgl::GLResource<GL_ARRAY_BUFFER>;
+
+template <class F>
+static void run (const std::string& name, size_t count, F&& write) {
+    Buffer buffer;
+    sgl::detail::GLBufferInterface<GL_ARRAY_BUFFER>::initializeMut(buffer, NULL, count * SEGMENTS * sizeof(Point), GL_STREAM_DRAW);
+    sgl::bind<GL_ARRAY_BUFFER>(buffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+
+    std::vector<Point> data(count, Point{{0,0,0,1}});
+    double ms = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t i = 0; i < FRAMES; i++) {
+                data[i % count].values[0] = i;
+                size_t first = write(buffer, data, i);
+                glDrawArrays(GL_POINTS, first, count);
+            }
+        });
+    });
+    bench::report((name + " " + std::to_string(count * sizeof(Point)) + "B").c_str(), FRAMES, ms);
+    buffer.release();
+}
+
+// Write the whole first segment with policy
+template <sgl::MapPolicy policy>
+static size_t writeWith (Buffer& buffer, std::vector<Point>& data, size_t) {
+    auto bv = sgl::buffer_view<Point>(buffer, 0, data.size() * sizeof(Point), policy);
+    memcpy(bv.data(), &data[0], data.size() * sizeof(Point));
+    return 0;
+}
+
+int main () {
+    sgl::Context ctx = bench::createContext("map-bench");
+    sgl::Shader shader = bench::pointShader();
+    shader.bind();
+
+    sgl::VertexArray vao;
+    vao.bind();
+    glEnableVertexAttribArray(0);
+
+    for (size_t count : {64, 4096, 65536, 1048576}) {
+        size_t bytes = count * sizeof(Point);
+
+        run("glBufferSubData", count, [&] (Buffer& buffer, std::vector<Point>& data, size_t) {
+            sgl::detail::GLBufferInterface<GL_ARRAY_BUFFER>::update(buffer, reinterpret_cast<const char*>(&data[0]), 0, bytes);
+            return (size_t)0;
+        });
+
+        run("glMapBuffer", count, [&] (Buffer& buffer, std::vector<Point>& data, size_t) {
+            auto bv = sgl::buffer_view<Point>(buffer, GL_WRITE_ONLY);
+            memcpy(&bv[0], &data[0], bytes);
+            return (size_t)0;
+        });
+
+        run("MAP_WRITE", count, writeWith<sgl::MAP_WRITE>);
+        run("MAP_WRITE_INVALIDATE_RANGE", count, writeWith<sgl::MAP_WRITE_INVALIDATE_RANGE>);
+        run("MAP_WRITE_INVALIDATE_BUFFER", count, writeWith<sgl::MAP_WRITE_INVALIDATE_BUFFER>);
+
+        run("MAP_WRITE_UNSYNCHRONIZED", count, [&] (Buffer& buffer, std::vector<Point>& data, size_t frame) {
+            size_t segment = frame % SEGMENTS;
+            auto bv = sgl::buffer_view<Point>(buffer, segment * bytes, bytes, sgl::MAP_WRITE_UNSYNCHRONIZED);
+            memcpy(bv.data(), &data[0], bytes);
+            return segment * count;
+        });
+
+        // One element changes per frame; only it is flushed
+        run("MAP_WRITE_FLUSH_EXPLICIT", count, [&] (Buffer& buffer, std::vector<Point>& data, size_t frame) {
+            size_t idx = frame % count;
+            auto bv = sgl::buffer_view<Point>(buffer, 0, bytes, sgl::MAP_WRITE_FLUSH_EXPLICIT);
+            bv[idx] = data[idx];
+            bv.flush(idx, 1);
+            return (size_t)0;
+        });
+    }
+
+    vao.release();
+    shader.release();
+}
@@ -0,0 +1,84 @@
+#include "sgl-bench.h"
+
+#include <SimpleGL/nulldriver.h>
+
+#include <string>
+
+// CPU overhead of SimpleGL itself, measured against the null driver: no
+// context or GPU is needed and every GL call returns immediately, so the
+// times are those of SimpleGL's own bookkeeping. GL calls per operation are
+// counted by the driver and don't depend on the machine.
+
+static const size_t OPS = 100000;
+static const size_t ITERATIONS = 5;
+
+using Point = sgl::vec4f;
+
+template <class F>
+static void run (sgl::NullDriver& driver, const char* name, F&& op) {
+    driver.resetCalls();
+    for (size_t i = 0; i < OPS; i++) op(i);
+    double calls = double(driver.totalCalls()) / OPS;
+
+    double ms = bench::medianMs(ITERATIONS, [&] () {
+        return bench::timeMs([&] () {
+            for (size_t i = 0; i < OPS; i++) op(i);
+        });
+    });
+    bench::report(name, OPS, ms, calls);
+}
+
+int main () {
+    bench::begin("overhead-bench");
+    sgl::NullDriver driver;
+    driver.install();
+
+    sgl::ArrayBuffer<Point> positions;
+    sgl::ArrayBuffer<Point> colors;
+    sgl::VertexArray vao;
+    sgl::VertexAttribBuilder builder(vao);
+    builder.addBuffer<Point>(positions)
+           .addBuffer<sgl::vec2f>(colors)
+           .addBuffer<sgl::vec2f>(colors);
+    run(driver, "VertexAttribBuilder::commit", [&] (size_t) {
+        builder.commit();
+    });
+
+    sgl::Shader shader = bench::pointShader();
+    shader.bind();
+    run(driver, "Shader::setUniform1f", [&] (size_t i) {
+        shader.setUniform1f("Alpha", float(i));
+    });
+    run(driver, "Shader::setUniform4fv", [&] (size_t i) {
+        shader.setUniform4fv("Color", float(i), 0, 0, 1);
+    });
+
+    sgl::ArrayBufferMut<Point> buffer;
+    for (size_t count : {16, 4096}) {
+        std::vector<Point> data(count, Point{{0,0,0,1}});
+        std::string name = "bufferData " + std::to_string(count * sizeof(Point)) + "B";
+        run(driver, name.c_str(), [&] (size_t) {
+            sgl::bufferData(buffer, data, GL_DYNAMIC_DRAW);
+        });
+    }
+
+    run(driver, "TextureBuilder2D::build", [&] (size_t) {
+        sgl::Texture2D texture = sgl::TextureBuilder2D()
+            .format(GL_RGBA, GL_RGBA8)
+            .build(64, 64);
+        texture.release();
+    });
+
+    buffer.release();
+    shader.release();
+    vao.release();
+    colors.release();
+    positions.release();
+
+    if (!driver.errors().empty()) {
+        for (const auto& error : driver.errors()) {
+            fprintf(stderr, "%s: %s\n", sgl::NullDriver::callName(error.call), error.message.c_str());
+        }
+        return 1;
+    }
+}
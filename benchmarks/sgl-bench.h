@@ -0,0 +1,147 @@
+#pragma once
+
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Every benchmark prints a table of its results. When SGL_BENCH_JSON names
+// a directory, the results are also written to <directory>/<benchmark>.json
+// on exit, for tracking regressions across releases:
+//
+//     {"benchmark": "map-bench", "renderer": GL_RENDERER, "version": GL_VERSION,
+//      "results": [{"name": ..., "ops": ..., "ms": ..., "ns_per_op": ..., "ops_per_s": ...}, ...]}
+//
+// Results counted against the NullDriver also carry "gl_calls_per_op".
+
+namespace bench {
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct Result {
+    std::string name;
+    size_t ops;
+    double ms;
+    double glCalls;     // GL calls per op, negative if not counted
+
+    // 0 when there's nothing to divide by, JSON has no inf or nan
+    double nsPerOp () const { return ops == 0 ? 0 : ms * 1e6 / ops; }
+    double opsPerSecond () const { return ms <= 0 ? 0 : ops / (ms / 1000.0); }
+};
+
+struct Results {
+    std::string benchmark;
+    std::string renderer;
+    std::string version;
+    std::vector<Result> results;
+
+    ~Results () {
+        const char* dir = std::getenv("SGL_BENCH_JSON");
+        if (dir == nullptr || benchmark.empty()) return;
+        std::string path = std::string(dir) + "/" + benchmark + ".json";
+        FILE* out = fopen(path.c_str(), "w");
+        if (out == nullptr) {
+            fprintf(stderr, "unable to write %s\n", path.c_str());
+            return;
+        }
+        fprintf(out, "{\"benchmark\": %s, \"renderer\": %s, \"version\": %s, \"results\": [",
+                quote(benchmark).c_str(), quote(renderer).c_str(), quote(version).c_str());
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            fprintf(out, "%s\n  {\"name\": %s, \"ops\": %zu, \"ms\": %.6f, \"ns_per_op\": %.3f, \"ops_per_s\": %.3f",
+                    i == 0 ? "" : ",", quote(r.name).c_str(), r.ops, r.ms, r.nsPerOp(), r.opsPerSecond());
+            if (r.glCalls >= 0) fprintf(out, ", \"gl_calls_per_op\": %.3f", r.glCalls);
+            fprintf(out, "}");
+        }
+        fprintf(out, "\n]}\n");
+        fclose(out);
+    }
+
+    static std::string quote (const std::string& str) {
+        std::string res = "\"";
+        for (char c : str) {
+            if (c == '"' || c == '\\') res += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) res += c;
+        }
+        return res + "\"";
+    }
+};
+
+// Written out when the program exits
+inline Results& results () {
+    static Results res;
+    return res;
+}
+
+// Name the results of this program. createContext does it for you.
+inline void begin (const char* benchmark) {
+    results().benchmark = benchmark;
+}
+
+// Hidden window, or a headless context when built with SGL_HEADLESS_CONTEXT,
+// large enough for render target benchmarks
+inline sgl::Context createContext (const char* name, size_t poolChunk = 0) {
+    begin(name);
+    return sgl::ContextBuilder()
+        .setTitle(name)
+        .setSize(256, 256)
+        .setVisible(false)
+        .setHeadless(SGL_HEADLESS_CONTEXT != 0)
+        .setHandlePool(poolChunk)
+        .build();
+}
+
+// Time fn in milliseconds. glFinish is included so deferred driver work is counted.
+template <class F>
+double timeMs (F&& fn) {
+    auto start = Clock::now();
+    fn();
+    glFinish();
+    auto end = Clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Median of iterations runs of fn
+template <class F>
+double medianMs (size_t iterations, F&& fn) {
+    std::vector<double> times;
+    for (size_t i = 0; i < iterations; i++) times.push_back(fn());
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Minimal program drawing vec4 points from attribute 0, for benchmarks that
+// need the GPU to actually read the data they upload
+inline sgl::Shader pointShader () {
+    return sgl::compileShader(
+        "#version 330 core\n"
+        "layout(location = 0) in vec4 pos;\n"
+        "void main () { gl_Position = pos; gl_PointSize = 1.0; }\n",
+        "#version 330 core\n"
+        "out vec4 color;\n"
+        "void main () { color = vec4(1.0); }\n");
+}
+
+// Print a result and keep it for the JSON output. Needs a current context
+// (or an installed NullDriver) the first time, to read the renderer.
+inline void report (const char* name, size_t ops, double ms, double glCalls = -1) {
+    Results& res = results();
+    if (res.renderer.empty()) {
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        const GLubyte* version = glGetString(GL_VERSION);
+        res.renderer = renderer != nullptr ? reinterpret_cast<const char*>(renderer) : "unknown";
+        res.version = version != nullptr ? reinterpret_cast<const char*>(version) : "unknown";
+    }
+    res.results.push_back({name, ops, ms, glCalls});
+    const Result& r = res.results.back();
+
+    printf("%-40s %10zu ops %10.3f ms %12.1f ns/op %14.0f ops/s", name, ops, ms, r.nsPerOp(), r.opsPerSecond());
+    if (glCalls >= 0) printf(" %8.2f GL calls/op", glCalls);
+    printf("\n");
+}
+
+} // end namespace
@@ -5,10 +5,12 @@
 #include "context.h"
 #include "camera.h"
 #include "event.h"
+#include "loader.h"
 #include "mesh.h"
 #include "param.h"
 #include "pbo.h"
 #include "slab.h"
+#include "surfacepool.h"
 #include "transform.h"
 
 namespace sgl {
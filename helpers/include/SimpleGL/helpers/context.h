@@ -1,7 +1,14 @@
 #pragma once
 
 #include <SimpleGL/sglconfig.h>
+#include <SimpleGL/bindcache.h>
+#include <SimpleGL/counters.h>
+#include <SimpleGL/handlepool.h>
+#include <SimpleGL/deletionqueue.h>
+#include <SimpleGL/gpuprofiler.h>
+#include <SimpleGL/trace.h>
 #include "event.h"
+#include "loader.h"
 
 #include <vector>
 #include <string>
@@ -9,6 +16,13 @@
 #define GLFW_STATIC
 #include <GLFW/glfw3.h>
 
+/**
+* Compile Time configuration flags:
+* SGL_HEADLESS_CONTEXT - 1 when built with EGL (cmake -DSGL_HEADLESS_CONTEXT=ON), enabling ContextBuilder::setHeadless
+*/
+#ifndef SGL_HEADLESS_CONTEXT
+#   define SGL_HEADLESS_CONTEXT 0
+#endif
 
 namespace sgl {
 
@@ -40,8 +54,32 @@ namespace detail {
         bool debug;
         bool fullscreen;
         size_t monitor;
+        bool bindCache;
+        bool bindCacheValidate;
+        size_t handlePoolChunk;
+        bool deferredDeletion;
+        size_t loaderThreads;
+        bool gpuProfiler;
+        bool gpuPipelineStatistics;
+        size_t traceEvents;
+        bool headless;
     };
 
+    // Display-less EGL context rendering into framebuffer, see context-headless.cc
+    struct HeadlessContext {
+        void* display;          // EGLDisplay
+        void* context;          // EGLContext
+        GLuint framebuffer;
+        GLuint color;           // Renderbuffers attached to framebuffer, 0 if none
+        GLuint depthStencil;
+        bool closed;
+    };
+
+    // Create the context and its framebuffer, and make it current. Throws std::runtime_error on failure.
+    HeadlessContext* createHeadlessContext (const ContextConfig& config);
+    void makeHeadlessCurrent (HeadlessContext* headless);
+    void destroyHeadlessContext (HeadlessContext* headless);
+
     void getDefaultWindowConfig (ContextConfig& dest, int width = 0, int height = 0, const std::string& title = "", int major = SGL_OPENGL_MAX_MAJOR, int minor = SGL_OPENGL_MAX_MINOR);
 } // namespace
 
@@ -50,9 +88,33 @@ private:
     detail::UserState _userState;
 
     // TODO: This should support other windowing APIs
+    // nullptr for headless contexts
     GLFWwindow * _windowState;
 
+    // Only allocated when attrs.headless is set
+    detail::HeadlessContext* _headless;
+
+    // Only installed when attrs.bindCache is set
+    sgl::BindCache _bindCache;
+
+    // Only installed when attrs.handlePoolChunk is non zero
+    sgl::HandlePool _handlePool;
+
+    // Only allocated when attrs.deferredDeletion is set
+    sgl::DeletionQueue* _deletionQueue;
+
+    // Only allocated when attrs.loaderThreads is non zero
+    sgl::Loader* _loader;
+
+    // Only allocated when attrs.gpuProfiler is set
+    sgl::GpuProfiler* _gpuProfiler;
+
+    // Only allocated when attrs.traceEvents is non zero
+    sgl::Tracer* _tracer;
+
     void initialize ();
+    void initializeWindow ();
+    void makeCurrent ();
 
 public:
     detail::ContextConfig attrs;
@@ -69,6 +131,12 @@ public:
         initialize();
     }
 
+    // Contexts own their window and the objects they install, so they can
+    // only be moved. The moved from context is left empty.
+    Context (Context&& other);
+    Context (const Context&) = delete;
+    Context& operator= (const Context&) = delete;
+
     ~Context () {
         destroy();
     }
@@ -93,6 +161,31 @@ public:
     bool isAlive ();
     void close ();
 
+    // Binding statistics are reset every swapBuffers
+    sgl::BindCache& bindCache () { return _bindCache; }
+
+    // Released names are deleted every swapBuffers
+    sgl::HandlePool& handlePool () { return _handlePool; }
+
+    // Released resources are retired every swapBuffers. nullptr unless deferred deletion is enabled.
+    sgl::DeletionQueue* deletionQueue () { return _deletionQueue; }
+
+    // Finished background loads are handed over every swapBuffers. nullptr unless loader threads are enabled.
+    sgl::Loader* loader () { return _loader; }
+
+    // Frames are ended every swapBuffers. nullptr unless the GPU profiler is enabled.
+    sgl::GpuProfiler* gpuProfiler () { return _gpuProfiler; }
+
+    // Frames are ended every swapBuffers, importing the GPU profiler's scopes. nullptr unless tracing is enabled.
+    sgl::Tracer* tracer () { return _tracer; }
+
+    // Framebuffer standing in for the default framebuffer: 0 for windows, an
+    // offscreen framebuffer of attrs.width x attrs.height for headless contexts.
+    // It is bound on creation; bind it where you would bind 0.
+    GLuint framebuffer () const { return _headless != nullptr ? _headless->framebuffer : 0; }
+
+    bool headless () const { return _headless != nullptr; }
+
 };
 
 
@@ -184,6 +277,55 @@ public:
         return *this;
     }
 
+    // Skip redundant sgl::bind calls. validate cross checks the cache with glGet. See bindcache.h
+    ContextBuilder& setBindCache (bool enabled, bool validate = false) {
+        _config.bindCache = enabled;
+        _config.bindCacheValidate = validate;
+        return *this;
+    }
+
+    // Pre-generate OpenGL names chunk at a time. 0 disables pooling. See handlepool.h
+    ContextBuilder& setHandlePool (size_t chunk) {
+        _config.handlePoolChunk = chunk;
+        return *this;
+    }
+
+    // Defer GLResource::release until the GPU has finished the frame. See deletionqueue.h
+    ContextBuilder& setDeferredDeletion (bool enabled) {
+        _config.deferredDeletion = enabled;
+        return *this;
+    }
+
+    // Create threads hidden contexts sharing objects with this one, each
+    // running a loader thread. 0 disables background loading. See loader.h
+    ContextBuilder& setLoaderThreads (size_t threads) {
+        _config.loaderThreads = threads;
+        return *this;
+    }
+
+    // Time sglGpuScope blocks with GPU timer queries, optionally collecting
+    // pipeline statistics. See gpuprofiler.h
+    ContextBuilder& setGpuProfiler (bool enabled, bool pipelineStatistics = false) {
+        _config.gpuProfiler = enabled;
+        _config.gpuPipelineStatistics = pipelineStatistics;
+        return *this;
+    }
+
+    // Record SimpleGL's spans and sglTraceScope blocks into a ring of events
+    // entries, for export as a Chrome trace. 0 disables tracing. See trace.h
+    ContextBuilder& setTracer (size_t events = SGL_TRACE_EVENTS) {
+        _config.traceEvents = events;
+        return *this;
+    }
+
+    // Create a display-less EGL context (EGL_MESA_platform_surfaceless where
+    // available) rendering into an offscreen framebuffer instead of a window.
+    // Needs SGL_HEADLESS_CONTEXT, a size, and no loader threads. See Context::framebuffer
+    ContextBuilder& setHeadless (bool enabled) {
+        _config.headless = enabled;
+        return *this;
+    }
+
     Context build () {
         return {_config};
     }
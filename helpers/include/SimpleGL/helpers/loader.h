@@ -0,0 +1,124 @@
+#pragma once
+
+#include <SimpleGL/sglconfig.h>
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+namespace sgl {
+
+namespace detail {
+    struct LoadJob {
+        std::function<void()> work;      // Runs on a loader thread
+        std::function<void()> complete;  // Runs on the render thread once fenced work is done
+        GLsync fence = nullptr;
+        std::exception_ptr error;
+    };
+} // end namespace
+
+struct LoaderStats {
+    uint64_t submitted;
+    uint64_t completed;
+};
+
+/**
+* Loader creates and uploads OpenGL resources on background threads so the
+* render thread never blocks on large assets. Each thread owns a hidden
+* context sharing objects with the main one. A job runs on a loader thread,
+* is fenced and flushed, and its completion callback runs on the render
+* thread in poll() once the fence has signaled, so the resource is complete
+* when it is handed over.
+*
+* Jobs return the resources they create by value. Exceptions thrown by a job
+* are rethrown from poll().
+*
+* sgl::Context creates a Loader and polls it every swapBuffers when built
+* with ContextBuilder::setLoaderThreads. Contexts must be created on the main
+* thread, so a Loader must be constructed and released there too.
+*
+* ex:
+*
+*     sgl::Context ctx = sgl::ContextBuilder().setLoaderThreads(2).build();
+*     std::vector<sgl::Texture2D> textures;
+*     for (auto& path : paths) {
+*         ctx.loader()->load(
+*             [=] () { return loadTexture(path); },                          // Loader thread
+*             [&] (sgl::Texture2D& tex) { textures.push_back(tex); });      // Render thread
+*     }
+*     while (ctx.isAlive()) {
+*         draw(textures);
+*         ctx.swapBuffers();  // Polls the loader
+*     }
+*/
+class Loader {
+private:
+    std::vector<GLFWwindow*> _contexts;
+    std::vector<std::thread> _threads;
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    std::deque<detail::LoadJob> _queued;
+    std::deque<detail::LoadJob> _fenced;
+    size_t _running;
+    bool _quit;
+    LoaderStats _stats;
+
+    void work (GLFWwindow* context);
+    void enqueue (detail::LoadJob&& job);
+
+public:
+    // Create threads loader threads whose contexts share objects with share.
+    // Must be called on the main thread.
+    Loader (GLFWwindow* share, size_t threads = 1);
+    ~Loader ();
+
+    Loader (const Loader&) = delete;
+    Loader& operator= (const Loader&) = delete;
+
+    // Run fn on a loader thread and pass its result to onReady on the render
+    // thread once OpenGL has finished with it
+    template <class F, class C>
+    void load (F fn, C onReady) {
+        using R = decltype(fn());
+        auto result = std::make_shared<std::unique_ptr<R>>();
+        detail::LoadJob job;
+        job.work = [result, fn] () mutable { result->reset(new R(fn())); };
+        job.complete = [result, onReady] () mutable { onReady(**result); };
+        enqueue(std::move(job));
+    }
+
+    // Run fn on a loader thread with no completion callback
+    template <class F>
+    void run (F fn) {
+        detail::LoadJob job;
+        job.work = fn;
+        enqueue(std::move(job));
+    }
+
+    // Run completion callbacks of finished jobs. Never blocks.
+    void poll ();
+
+    // Block until every submitted job has completed, then poll
+    void finish ();
+
+    // Jobs submitted but not yet completed
+    size_t pending ();
+
+    LoaderStats stats ();
+
+    // Stop the threads and destroy their contexts. Must be called on the main thread.
+    void release ();
+};
+
+} // end namespace
@@ -2,6 +2,8 @@
 #include <SimpleGL/sglconfig.h>
 #include <SimpleGL/traits.h>
 #include <SimpleGL/resource.h>
+#include <SimpleGL/allocator.h>
+#include <SimpleGL/indirect.h>
 
 #include <glm/glm.hpp>
 #include <vector>
@@ -16,6 +18,14 @@ struct MeshVertex {
     glm::vec3 normal;
 };
 
+namespace traits {
+    template <>
+    struct VertexFormat<MeshVertex> : VertexFields<MeshVertex,
+        SGL_VERTEX_FIELD_AS(MeshVertex, position, sgl::vec3f),
+        SGL_VERTEX_FIELD_AS(MeshVertex, uvcoord, sgl::vec2f),
+        SGL_VERTEX_FIELD_AS(MeshVertex, normal, sgl::vec3f)> {};
+} // end namespace
+
 struct MeshData {
 public:
     std::vector<GLuint> indices;
@@ -55,6 +65,87 @@ public:
 };
 
 
+class MeshArena;
+
+// A mesh living in a MeshArena. Draw with the arena bound.
+struct ArenaMesh {
+    MeshArena* arena;
+    GLint baseVertex;
+    GLuint firstIndex;
+    GLsizei count;
+    GLsizei vertexCount;
+
+    void draw (GLenum mode = GL_TRIANGLES) const {
+        glDrawElementsBaseVertex(mode, count, GL_UNSIGNED_INT, (GLvoid*)(firstIndex * sizeof(GLuint)), baseVertex);
+        sglCountDraw();
+    }
+
+    // Indirect command drawing this mesh, for an IndirectBatch over the arena
+    DrawElementsIndirectCommand command (GLuint instances = 1, GLuint baseInstance = 0) const {
+        return sgl::drawElementsCommand(count, firstIndex, baseVertex, instances, baseInstance);
+    }
+
+    // Return the mesh's ranges to its arena
+    void release ();
+};
+
+/**
+* MeshArena packs many meshes into one vertex buffer and one index buffer
+* shared by a single vertex array. Ranges are carved out with a
+* RangeAllocator and meshes are drawn with glDrawElementsBaseVertex, so
+* drawing thousands of small meshes needs one VAO bind instead of one per
+* mesh. Indices stay relative to each mesh.
+*
+* When an arena runs out of room its buffers are reallocated with twice the
+* capacity and the contents copied on the GPU. defragment compacts the live
+* meshes after many removals; every live mesh must be passed in so its
+* offsets can be updated.
+*
+* ex:
+*
+*     sgl::MeshArena arena;
+*     std::vector<sgl::ArenaMesh> meshes;
+*     for (auto& data : meshData) meshes.push_back(arena.add(data));
+*
+*     arena.bind();
+*     for (auto& mesh : meshes) mesh.draw();
+*
+*     meshes.back().release(); meshes.pop_back();
+*     arena.defragment(meshes);
+*/
+class MeshArena : public GLResource<GL_VERTEX_ARRAY> {
+private:
+    GLBufferMut<GL_ARRAY_BUFFER, MeshVertex> _vbo;
+    GLBufferMut<GL_ELEMENT_ARRAY_BUFFER, GLuint> _ebo;
+    RangeAllocator _vertices;
+    RangeAllocator _indices;
+
+    void attach ();
+    void reallocate (size_t vertexCapacity, size_t indexCapacity,
+                     const std::vector<RangeMove>& vertexMoves, const std::vector<RangeMove>& indexMoves);
+
+public:
+    MeshArena (size_t vertexCapacity = 65536, size_t indexCapacity = 3 * 65536);
+
+    ArenaMesh add (const MeshData& data);
+    void remove (ArenaMesh& mesh);
+
+    // Compact the arena. meshes must hold every live mesh.
+    void defragment (ArenaMesh* meshes, size_t len);
+    void defragment (std::vector<ArenaMesh>& meshes) { defragment(meshes.data(), meshes.size()); }
+
+    const RangeAllocator& vertices () const { return _vertices; }
+    const RangeAllocator& indices () const { return _indices; }
+
+    void release () {
+        GLResource<GL_VERTEX_ARRAY>::release();
+        _vbo.release();
+        _ebo.release();
+        _vertices.reset();
+        _indices.reset();
+    }
+};
+
 //using MMeshResource = GLResourceM<MeshResource>;
 
 MeshResource createPlane (int divs = 1);
@@ -5,39 +5,178 @@
 #include <SimpleGL/resource.h>
 #include <SimpleGL/texture.h>
 
+#include <stdint.h>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 namespace sgl {
 
-// TODO: this is not generalized enough
+// Texel rectangle (or box) of one mip level. For cube maps z is the first
+// face and depth the number of faces; for 1D and 2D arrays the last used
+// coordinate is the layer.
+struct UploadRegion {
+    GLint x = 0, y = 0, z = 0;
+    GLsizei width = 1, height = 1, depth = 1;
+    GLint level = 0;
+
+    UploadRegion () {}
+    UploadRegion (GLsizei w, GLsizei h = 1, GLsizei d = 1) : width(w), height(h), depth(d) {}
+    UploadRegion (GLint x, GLint y, GLsizei w, GLsizei h) : x(x), y(y), width(w), height(h) {}
+    UploadRegion (GLint x, GLint y, GLint z, GLsizei w, GLsizei h, GLsizei d) : x(x), y(y), z(z), width(w), height(h), depth(d) {}
+};
+
+struct PBOUploaderStats {
+    uint64_t uploads;
+    uint64_t bytes;
+    uint64_t stalls;  // Uploads that waited for the GPU to release a buffer
+    double seconds;   // Time spent in upload, including waits
+
+    // Bytes per second handed to OpenGL
+    double bandwidth () const { return seconds > 0 ? bytes / seconds : 0; }
+};
+
+namespace detail {
+    // Region covering level 0 of a texture
+    template <GLenum kind>
+    traits::IfTex1D<kind, UploadRegion> fullRegion (const GLTextureInfo<kind>& info) {
+        return UploadRegion(info.width);
+    }
+
+    template <GLenum kind>
+    traits::IfTex2D<kind, UploadRegion> fullRegion (const GLTextureInfo<kind>& info) {
+        return UploadRegion(info.width, info.height);
+    }
+
+    template <GLenum kind>
+    traits::IfTex2DArray<kind, UploadRegion> fullRegion (const GLTextureInfo<kind>& info) {
+        return UploadRegion(info.width, info.height, 6);
+    }
+
+    template <GLenum kind>
+    traits::IfTex3D<kind, UploadRegion> fullRegion (const GLTextureInfo<kind>& info) {
+        return UploadRegion(info.width, info.height, info.depth);
+    }
+
+    // glTex(ture)SubImage* for target, sourcing from the bound unpack buffer at offset
+    void texSubImage (GLenum target, GLuint texture, const UploadRegion& region, GLenum format, GLenum type, size_t offset);
+
+    // Bytes between rows of width texels with the current GL_UNPACK_ALIGNMENT
+    size_t rowPitch (GLsizei width, GLenum format, GLenum type);
+
+    // Bytes OpenGL reads for region in format/type with the current GL_UNPACK_ALIGNMENT
+    size_t regionSize (const UploadRegion& region, GLenum format, GLenum type);
+
+    // Splits large memcpys across a fixed set of worker threads
+    class CopyPool {
+    private:
+        std::vector<std::thread> _threads;
+        std::mutex _lock;
+        std::condition_variable _start;
+        std::condition_variable _done;
+        char* _dst;
+        const char* _src;
+        size_t _chunk;
+        size_t _size;
+        uint64_t _job;
+        size_t _remaining;
+        bool _quit;
+
+        void work (size_t idx);
+
+    public:
+        // workers threads besides the caller. Copies are only split when
+        // every part would be at least minChunk bytes.
+        CopyPool (size_t workers, size_t minChunk = 1 << 20);
+        ~CopyPool ();
+
+        CopyPool (const CopyPool&) = delete;
+        CopyPool& operator= (const CopyPool&) = delete;
+
+        void copy (void* dst, const void* src, size_t size);
+
+        const size_t minChunk;
+    };
+} // end namespace
+
+/**
+* PBOUploader streams pixel data into textures through a ring of pixel
+* unpack buffers. An upload copies the data into the next buffer and issues
+* glTexSubImage from it, so OpenGL transfers it asynchronously instead of
+* blocking on client memory. Each buffer is fenced after use and only
+* rewritten once the GPU has finished reading it.
+*
+* Any texture kind works: 1D, 2D, rectangle, 3D, cube maps (one or more
+* faces) and, through the target overload, 1D and 2D arrays. Regions may be
+* any sub-rectangle of any level. Source data is laid out as OpenGL expects
+* it with the current GL_UNPACK_ALIGNMENT.
+*
+* Large copies are split across worker threads. stats() reports the
+* bandwidth achieved.
+*
+* ex:
+*
+*     sgl::PBOUploader uploader(3, std::thread::hardware_concurrency() - 1);
+*     uploader.upload(videoTexture, frame.data());                          // Whole level 0
+*     uploader.upload(atlas, tile.data(), sgl::UploadRegion(64, 64, 32, 32));
+*     uploader.upload(skybox, face.data(), sgl::UploadRegion(0, 0, 2, w, h, 1)); // +Y face
+*     printf("%f MB/s\n", uploader.stats().bandwidth() / 1e6);
+*/
 class PBOUploader {
 private:
-    sgl::Texture2D _destTexture;
-    sgl::GLResourceArray<GL_PIXEL_UNPACK_BUFFER> _pbos;
-    size_t _delay;
-    size_t _pboIdx;
-    size_t _pboIdxNext;
-    size_t _frameSize;
+    struct Slot {
+        sgl::UnpackBuffer buffer;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+    };
+
+    std::vector<Slot> _slots;
+    size_t _next;
+    detail::CopyPool* _pool;
+    PBOUploaderStats _stats;
+
+    // Target used by the single texture constructor and update
+    GLenum _destKind;
+    GLuint _destTexture;
+    UploadRegion _destRegion;
+    GLenum _destFormat;
+    GLenum _destType;
 
 public:
+    PBOUploader (size_t buffers = 3, size_t workers = 0);
 
-    PBOUploader (sgl::Texture2D texture, size_t delay = 2) :
-        _destTexture(texture),
-        _pbos(delay),
-        _delay(delay),
-        _pboIdx(0),
-        _pboIdxNext(1),
-        _frameSize(texture.attrs.size())
+    // Uploader bound to one texture, for update
+    PBOUploader (sgl::Texture2D texture, size_t buffers = 3) :
+        PBOUploader(buffers)
     {
-        for (size_t i = 0; i < _delay; i++){
-            sgl::bufferData(_pbos[i], static_cast<const char*>(0), _frameSize, GL_STREAM_DRAW);
-            _pbos[i].unbind();
-        }
-        sglDbgCatchGLError();
+        _destKind = GL_TEXTURE_2D;
+        _destTexture = texture;
+        _destRegion = detail::fullRegion(texture.attrs);
+        _destFormat = texture.attrs.format;
+        _destType = texture.attrs.data_type;
+    }
+
+    PBOUploader (const PBOUploader&) = delete;
+    PBOUploader& operator= (const PBOUploader&) = delete;
+
+    ~PBOUploader ();
+
+    void upload (GLenum target, GLuint texture, const void* data, const UploadRegion& region, GLenum format, GLenum type);
+
+    template <GLenum kind>
+    void upload (Texture<kind>& texture, const void* data, const UploadRegion& region) {
+        upload(kind, texture, data, region, texture.attrs.format, texture.attrs.data_type);
     }
 
-    void release () {
-        _pbos.release();
+    template <GLenum kind>
+    void upload (Texture<kind>& texture, const void* data) {
+        upload(texture, data, detail::fullRegion(texture.attrs));
     }
 
+    // Upload to the texture given at construction
     template <class T, size_t len>
     void update (std::array<T,len>& data) {
         update(&data[0], len);
@@ -48,28 +187,19 @@ public:
         update(&data[0], data.size());
     }
 
+    // count elements of T must cover the whole texture
     template <class T>
     void update (T * data, size_t count) {
-        _pboIdx = (_pboIdx + 1) % _delay;
-        _pboIdxNext = (_pboIdxNext + 1 ) % _delay;
-
-        auto pbo1 = _pbos[_pboIdx];
-        auto pbo2 = _pbos[_pboIdxNext];
-
-        _destTexture.bind();
-        pbo1.bind();
-
-        glTexSubImage2D(_destTexture.type, 0, 0, 0, _destTexture.attrs.width, _destTexture.attrs.height, _destTexture.attrs.format, _destTexture.attrs.data_type, 0);
+        if (count * sizeof(T) < detail::regionSize(_destRegion, _destFormat, _destType)) {
+            throw std::runtime_error("PBOUploader: update data is smaller than the texture");
+        }
+        upload(_destKind, _destTexture, data, _destRegion, _destFormat, _destType);
+    }
 
-        sglDbgCatchGLError();
+    const PBOUploaderStats& stats () const { return _stats; }
+    void resetStats ();
 
-        pbo2.bind();
-        void * dest = glMapBufferRange(pbo2.type, 0, sizeof(T) * count, GL_MAP_WRITE_BIT);
-        memcpy(dest, data, sizeof(T) * count);
-        glUnmapBuffer(pbo2.type);
-        pbo2.unbind();
-        sglDbgCatchGLError();
-    }
+    void release ();
 };
 
 } // end namespace
@@ -0,0 +1,122 @@
+#ifndef SURFACEPOOL_H
+#define SURFACEPOOL_H
+
+#include <SimpleGL/resource.h>
+#include <SimpleGL/texture.h>
+#include "slab.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace sgl {
+
+struct SurfaceKey {
+    GLsizei width;
+    GLsizei height;
+    GLenum format;
+    GLenum internalFormat;
+    GLenum type;
+
+    bool operator== (const SurfaceKey& other) const {
+        return width == other.width && height == other.height && format == other.format &&
+               internalFormat == other.internalFormat && type == other.type;
+    }
+};
+
+struct SurfacePoolStats {
+    uint64_t requests;
+    uint64_t hits;      // Requests served by a recycled surface
+    uint64_t created;
+    uint64_t evicted;
+    size_t live;        // Surfaces handed out and not yet returned
+    size_t idle;        // Surfaces waiting in the pool
+    size_t bytes;       // Texture memory held by the pool, live and idle
+};
+
+/**
+* SurfacePool hands out transient render targets (a texture and a
+* framebuffer with it attached) keyed by size, format and data type.
+* Returned surfaces are recycled by the next request with the same key,
+* so a multi pass pipeline allocates its intermediate targets once and
+* reuses them every frame instead of owning one pair per quantity.
+* Surfaces left idle for more than maxIdleFrames calls to endFrame() are
+* released.
+*
+* The contents of an acquired surface are undefined; clear it or write
+* every texel before reading.
+*
+* ex:
+*
+*     sgl::SurfacePool pool;
+*     while (running) {
+*         sgl::Surface2D divergence = pool.acquire(w, h, GL_RED, GL_R32F, GL_FLOAT);
+*         sgl::Slab2D pressure = pool.acquireSlab(w, h, GL_RED, GL_R32F, GL_FLOAT);
+*         ...
+*         pool.release(pressure);
+*         pool.release(divergence);
+*         pool.endFrame();
+*     }
+*     printf("hit rate: %f\n", pool.hitRate());
+*/
+class SurfacePool {
+private:
+    struct Entry {
+        SurfaceKey key;
+        Surface2D surface;
+        uint64_t lastUsed;
+        bool live;
+    };
+
+    std::vector<Entry> _entries;
+    uint64_t _frame;
+    uint32_t _maxIdleFrames;
+    SurfacePoolStats _stats;
+
+    Surface2D create (const SurfaceKey& key);
+    void evict (bool all);
+
+public:
+    SurfacePool (uint32_t maxIdleFrames = 2);
+
+    // A surface of the given size and format, recycled if one is idle
+    Surface2D acquire (const SurfaceKey& key);
+
+    Surface2D acquire (GLsizei width, GLsizei height, GLenum format, GLenum internalFormat, GLenum type) {
+        return acquire({width, height, format, internalFormat, type});
+    }
+
+    // Two surfaces of the same key, for ping-pong passes
+    Slab2D acquireSlab (GLsizei width, GLsizei height, GLenum format, GLenum internalFormat, GLenum type) {
+        SurfaceKey key = {width, height, format, internalFormat, type};
+        return {acquire(key), acquire(key)};
+    }
+
+    // Return a surface to the pool. It may be handed out by the next acquire.
+    void release (const Surface2D& surface);
+
+    void release (Slab2D& slab) {
+        release(slab.ping());
+        release(slab.pong());
+    }
+
+    // Advance the frame counter and release surfaces idle for longer than maxIdleFrames
+    void endFrame ();
+
+    // Release every idle surface
+    void trim ();
+
+    // Release every surface, including live ones
+    void clear ();
+
+    const SurfacePoolStats& stats () const { return _stats; }
+
+    // Fraction of requests served without creating a surface
+    double hitRate () const {
+        return _stats.requests == 0 ? 0 : double(_stats.hits) / double(_stats.requests);
+    }
+};
+
+} // end namespace
+
+#endif // SURFACEPOOL_H
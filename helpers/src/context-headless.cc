@@ -0,0 +1,182 @@
+#include "../include/SimpleGL/helpers/context.h"
+#include <SimpleGL/utils.h>
+
+#include <stdexcept>
+
+#if SGL_HEADLESS_CONTEXT
+#   include <EGL/egl.h>
+#   include <EGL/eglext.h>
+#   include <string.h>
+#endif
+
+using namespace sgl;
+
+#if SGL_HEADLESS_CONTEXT
+
+// Headless contexts share one display, terminated with the last of them
+static size_t __sglHeadlessContexts = 0;
+
+static bool hasExtension (const char* extensions, const char* name) {
+    if (extensions == nullptr) return false;
+    size_t len = strlen(name);
+    for (const char* ext = strstr(extensions, name); ext != nullptr; ext = strstr(ext + len, name)) {
+        if ((ext == extensions || ext[-1] == ' ') && (ext[len] == ' ' || ext[len] == '\0')) return true;
+    }
+    return false;
+}
+
+// Mesa's surfaceless platform needs neither a display server nor a DRM
+// device; otherwise fall back to whatever the default display is.
+static EGLDisplay getDisplay () {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != nullptr && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY) return display;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static void releaseDisplay (EGLDisplay display) {
+    if (__sglHeadlessContexts == 0) eglTerminate(display);
+}
+
+static EGLint getProfile (GLProfile profile) {
+    if (profile == GLProfile::COMPAT) return EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT_KHR;
+    return EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR;
+}
+
+static GLenum colorFormat (const detail::ContextConfig& config) {
+    if (config.redBits > 8) return config.alphaBits > 0 ? GL_RGBA16F : GL_RGB16F;
+    return config.alphaBits > 0 ? GL_RGBA8 : GL_RGB8;
+}
+
+static GLenum depthStencilFormat (const detail::ContextConfig& config) {
+    if (config.stencilBits > 0) return config.depthBits > 24 ? GL_DEPTH32F_STENCIL8 : GL_DEPTH24_STENCIL8;
+    if (config.depthBits > 24) return GL_DEPTH_COMPONENT32F;
+    if (config.depthBits > 16) return GL_DEPTH_COMPONENT24;
+    if (config.depthBits > 0) return GL_DEPTH_COMPONENT16;
+    return GL_NONE;
+}
+
+static GLenum depthStencilAttachment (GLenum format) {
+    if (format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8) return GL_DEPTH_STENCIL_ATTACHMENT;
+    return GL_DEPTH_ATTACHMENT;
+}
+
+static GLuint createRenderbuffer (GLenum format, GLsizei width, GLsizei height) {
+    GLuint renderbuffer;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    return renderbuffer;
+}
+
+// Stands in for the default framebuffer, which surfaceless contexts lack
+static void createFramebuffer (detail::HeadlessContext* headless, const detail::ContextConfig& config) {
+    headless->color = createRenderbuffer(colorFormat(config), config.width, config.height);
+
+    GLenum depthFormat = depthStencilFormat(config);
+    if (depthFormat != GL_NONE) headless->depthStencil = createRenderbuffer(depthFormat, config.width, config.height);
+
+    glGenFramebuffers(1, &headless->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, headless->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, headless->color);
+    if (headless->depthStencil != 0) {
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, depthStencilAttachment(depthFormat), GL_RENDERBUFFER, headless->depthStencil);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Headless context: incomplete framebuffer");
+    }
+    glViewport(0, 0, config.width, config.height);
+    sglCatchGLError();
+}
+
+detail::HeadlessContext* detail::createHeadlessContext (const ContextConfig& config) {
+    if (config.width == 0 || config.height == 0) throw std::runtime_error("Headless context: width and height must be set");
+
+    EGLDisplay display = getDisplay();
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        throw std::runtime_error("Headless context: failed to initialize EGL");
+    }
+    if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        releaseDisplay(display);
+        throw std::runtime_error("Headless context: EGL_KHR_surfaceless_context is unsupported");
+    }
+
+    // Nothing is drawn to EGL surfaces, so any surface type will do
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, 0,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig eglConfig;
+    EGLint configs = 0;
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttribs, &eglConfig, 1, &configs) || configs == 0) {
+        releaseDisplay(display);
+        throw std::runtime_error("Headless context: no EGL config supports desktop OpenGL");
+    }
+
+    EGLint flags = 0;
+    if (config.forwardCompat) flags |= EGL_CONTEXT_OPENGL_FORWARD_COMPATIBLE_BIT_KHR;
+    if (config.debug) flags |= EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR;
+    EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, (EGLint)config.glVersionMajor,
+        EGL_CONTEXT_MINOR_VERSION_KHR, (EGLint)config.glVersionMinor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, getProfile(config.glProfile),
+        EGL_CONTEXT_FLAGS_KHR, flags,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, eglConfig, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        releaseDisplay(display);
+        throw std::runtime_error("Headless context: failed to create an OpenGL " + std::to_string(config.glVersionMajor) + "." + std::to_string(config.glVersionMinor) + " context");
+    }
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        eglDestroyContext(display, context);
+        releaseDisplay(display);
+        throw std::runtime_error("Headless context: failed to make the context current");
+    }
+
+    __sglHeadlessContexts += 1;
+    HeadlessContext* headless = new HeadlessContext{display, context, 0, 0, 0, false};
+    try {
+        createFramebuffer(headless, config);
+    } catch (...) {
+        destroyHeadlessContext(headless);
+        throw;
+    }
+    return headless;
+}
+
+void detail::makeHeadlessCurrent (HeadlessContext* headless) {
+    eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, headless->context);
+}
+
+void detail::destroyHeadlessContext (HeadlessContext* headless) {
+    makeHeadlessCurrent(headless);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (headless->framebuffer != 0) glDeleteFramebuffers(1, &headless->framebuffer);
+    if (headless->color != 0) glDeleteRenderbuffers(1, &headless->color);
+    if (headless->depthStencil != 0) glDeleteRenderbuffers(1, &headless->depthStencil);
+
+    eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(headless->display, headless->context);
+    __sglHeadlessContexts -= 1;
+    releaseDisplay(headless->display);
+    delete headless;
+}
+
+#else
+
+detail::HeadlessContext* detail::createHeadlessContext (const ContextConfig&) {
+    throw std::runtime_error("Headless context: SimpleGL was built without EGL (SGL_HEADLESS_CONTEXT)");
+}
+
+void detail::makeHeadlessCurrent (HeadlessContext*) {}
+
+void detail::destroyHeadlessContext (HeadlessContext*) {}
+
+#endif
@@ -1,6 +1,7 @@
 #include "../include/SimpleGL/helpers/context.h"
 #include <SimpleGL/utils.h>
 #include <stdexcept>
+#include <utility>
 #include <iostream>
 
 
@@ -77,9 +78,97 @@ void detail::getDefaultWindowConfig(detail::ContextConfig& config, int width, in
     config.debug = false;
     config.fullscreen = false;
     config.monitor = 0;
+    config.bindCache = false;
+    config.bindCacheValidate = false;
+    config.handlePoolChunk = 0;
+    config.deferredDeletion = false;
+    config.loaderThreads = 0;
+    config.gpuProfiler = false;
+    config.gpuPipelineStatistics = false;
+    config.traceEvents = 0;
+    config.headless = false;
 }
 
 void Context::initialize () {
+    _windowState = nullptr;
+    _headless = nullptr;
+    _deletionQueue = nullptr;
+    _loader = nullptr;
+    _gpuProfiler = nullptr;
+    _tracer = nullptr;
+
+    if (attrs.headless) {
+        // Loaders share objects through hidden GLFW windows
+        if (attrs.loaderThreads != 0) throw std::runtime_error("Headless contexts don't support loader threads");
+        _headless = detail::createHeadlessContext(attrs);
+        sgl::setDefaultFramebuffer(_headless->framebuffer);
+    } else {
+        initializeWindow();
+    }
+
+    sgl::sglInitialize(attrs.glVersionMajor, attrs.glVersionMinor);
+    if (attrs.bindCache) {
+        _bindCache.validate = attrs.bindCacheValidate;
+        sgl::setBindCache(&_bindCache);
+    }
+    if (attrs.handlePoolChunk != 0) {
+        _handlePool = sgl::HandlePool(attrs.handlePoolChunk);
+        sgl::setHandlePool(&_handlePool);
+    }
+    if (attrs.deferredDeletion) {
+        _deletionQueue = new sgl::DeletionQueue();
+        sgl::setDeletionQueue(_deletionQueue);
+    }
+    if (attrs.loaderThreads != 0) {
+        _loader = new sgl::Loader(_windowState, attrs.loaderThreads);
+    }
+    if (attrs.gpuProfiler) {
+        _gpuProfiler = new sgl::GpuProfiler(attrs.gpuPipelineStatistics);
+        sgl::setGpuProfiler(_gpuProfiler);
+    }
+    if (attrs.traceEvents != 0) {
+        _tracer = new sgl::Tracer(attrs.traceEvents);
+        sgl::setTracer(_tracer);
+    }
+
+    if (_windowState != nullptr) {
+        int w, h;
+        glfwGetFramebufferSize(_windowState, &w, &h);
+        attrs.width = w;
+        attrs.height = h;
+    }
+
+    sglClearGLError();
+
+}
+
+Context::Context (Context&& other) :
+    _userState(std::move(other._userState)),
+    _windowState(other._windowState),
+    _headless(other._headless),
+    _bindCache(other._bindCache),
+    _handlePool(std::move(other._handlePool)),
+    _deletionQueue(other._deletionQueue),
+    _loader(other._loader),
+    _gpuProfiler(other._gpuProfiler),
+    _tracer(other._tracer),
+    attrs(other.attrs)
+{
+    other._windowState = nullptr;
+    other._headless = nullptr;
+    other._deletionQueue = nullptr;
+    other._loader = nullptr;
+    other._gpuProfiler = nullptr;
+    other._tracer = nullptr;
+    other.attrs.handlePoolChunk = 0;
+
+    // Event callbacks and the installed cache and pool point into other
+    if (_windowState != nullptr) glfwSetWindowUserPointer(_windowState, (void*)&_userState);
+    if (sgl::getBindCache() == &other._bindCache) sgl::setBindCache(&_bindCache);
+    if (sgl::getHandlePool() == &other._handlePool) sgl::setHandlePool(&_handlePool);
+}
+
+void Context::initializeWindow () {
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, attrs.glVersionMajor);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, attrs.glVersionMinor);
@@ -121,34 +210,65 @@ void Context::initialize () {
     glfwSetCursorEnterCallback(_windowState,__handleMouseEnter);
     glfwSetScrollCallback(_windowState, __handleMouseScroll);
     glfwSetKeyCallback(_windowState, __handleKeyEvent);
+}
 
-    sgl::sglInitialize(attrs.glVersionMajor, attrs.glVersionMinor);
-    int w, h;
-    glfwGetFramebufferSize(_windowState, &w, &h);
-
-    attrs.width = w;
-    attrs.height = h;
-
-    sglClearGLError();
-
+void Context::makeCurrent () {
+    if (_headless != nullptr) detail::makeHeadlessCurrent(_headless);
+    else glfwMakeContextCurrent(_windowState);
 }
 
 void Context::destroy () {
+    // Already destroyed, or moved from
+    if (_windowState == nullptr && _headless == nullptr) return;
+
+    if (_tracer != nullptr) {
+        if (sgl::getTracer() == _tracer) sgl::setTracer(nullptr);
+        delete _tracer;
+        _tracer = nullptr;
+    }
+    if (_loader != nullptr) {
+        _loader->release();
+        delete _loader;
+        _loader = nullptr;
+    }
+    if (_deletionQueue != nullptr || _gpuProfiler != nullptr || attrs.handlePoolChunk != 0) makeCurrent();
+    if (_gpuProfiler != nullptr) {
+        if (sgl::getGpuProfiler() == _gpuProfiler) sgl::setGpuProfiler(nullptr);
+        _gpuProfiler->release();
+        delete _gpuProfiler;
+        _gpuProfiler = nullptr;
+    }
+    if (_deletionQueue != nullptr) {
+        _deletionQueue->flush();
+        delete _deletionQueue;
+        _deletionQueue = nullptr;
+    }
+    if (attrs.handlePoolChunk != 0) _handlePool.clear();
+    if (sgl::getHandlePool() == &_handlePool) sgl::setHandlePool(nullptr);
+    if (sgl::getBindCache() == &_bindCache) sgl::setBindCache(nullptr);
+    if (_headless != nullptr) {
+        if (sgl::getDefaultFramebuffer() == _headless->framebuffer) sgl::setDefaultFramebuffer(0);
+        detail::destroyHeadlessContext(_headless);
+        _headless = nullptr;
+        return;
+    }
     glfwDestroyWindow(_windowState);
+    _windowState = nullptr;
     glfwTerminate();
 }
 
 void Context::pollEvents () {
-    glfwPollEvents();
+    if (_windowState != nullptr) glfwPollEvents();
 }
 
 void Context::setTitle (const std::string& title) {
     attrs.title = title;
-    glfwSetWindowTitle(_windowState, title.c_str());
+    if (_windowState != nullptr) glfwSetWindowTitle(_windowState, title.c_str());
 }
 
 void Context::setWindowVisible (bool visible) {
     attrs.windowVisible = visible;
+    if (_windowState == nullptr) return;
     if (visible) glfwShowWindow(_windowState);
     else glfwHideWindow(_windowState);
 }
@@ -174,19 +294,43 @@ void Context::addMouseHandler (sgl::MouseHandler&& handler) {
 */
 
 void Context::swapBuffers () {
-    glfwSwapBuffers(_windowState);
+    {
+        sglTraceScope("frame", "swapBuffers");
+        if (_headless != nullptr) glFlush();
+        else glfwSwapBuffers(_windowState);
+        if (attrs.bindCache) _bindCache.endFrame();
+        if (attrs.handlePoolChunk != 0) _handlePool.flush();
+        if (_deletionQueue != nullptr) _deletionQueue->endFrame();
+        if (_loader != nullptr) _loader->poll();
+        if (_gpuProfiler != nullptr) _gpuProfiler->endFrame();
+    }
+    sgl::endCounterFrame();
+
+    sgl::Tracer* tracer = sgl::getTracer();
+    if (tracer != nullptr) {
+        if (_gpuProfiler != nullptr) tracer->addGpuFrame(*_gpuProfiler);
+        tracer->endFrame();
+    }
 }
 
 void Context::setCurrent() {
-    glfwMakeContextCurrent(_windowState);
+    makeCurrent();
+    sgl::setDefaultFramebuffer(framebuffer());
+    if (attrs.bindCache) sgl::setBindCache(&_bindCache);
+    if (attrs.handlePoolChunk != 0) sgl::setHandlePool(&_handlePool);
+    if (_deletionQueue != nullptr) sgl::setDeletionQueue(_deletionQueue);
+    if (_gpuProfiler != nullptr) sgl::setGpuProfiler(_gpuProfiler);
+    if (_tracer != nullptr) sgl::setTracer(_tracer);
 }
 
 bool Context::isAlive () {
+    if (_headless != nullptr) return !_headless->closed;
     return !glfwWindowShouldClose(_windowState);
 }
 
 void Context::close () {
-    glfwSetWindowShouldClose(_windowState, true);
+    if (_headless != nullptr) _headless->closed = true;
+    else glfwSetWindowShouldClose(_windowState, true);
 }
 
 
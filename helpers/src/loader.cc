@@ -0,0 +1,157 @@
+#include "../include/SimpleGL/helpers/loader.h"
+#include <SimpleGL/utils.h>
+#include <SimpleGL/streambuffer.h>
+
+#define GLFW_STATIC
+#include <GLFW/glfw3.h>
+
+#include <string.h>
+#include <stdexcept>
+
+using namespace sgl;
+
+Loader::Loader (GLFWwindow* share, size_t threads) :
+    _running(0),
+    _quit(false)
+{
+    memset(&_stats, 0, sizeof(_stats));
+
+    // Hidden windows only exist to own a context. Creation must happen on the main thread.
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    for (size_t i = 0; i < threads; i++) {
+        GLFWwindow* context = glfwCreateWindow(1, 1, "", nullptr, share);
+        if (context == nullptr) break;
+        _contexts.push_back(context);
+    }
+    glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+    if (_contexts.size() != threads) {
+        for (GLFWwindow* context : _contexts) glfwDestroyWindow(context);
+        throw std::runtime_error("Failed to create shared loader context");
+    }
+    for (GLFWwindow* context : _contexts) {
+        _threads.emplace_back(&Loader::work, this, context);
+    }
+}
+
+Loader::~Loader () {
+    release();
+}
+
+void Loader::enqueue (detail::LoadJob&& job) {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _queued.push_back(std::move(job));
+        _stats.submitted += 1;
+    }
+    _wake.notify_one();
+}
+
+void Loader::work (GLFWwindow* context) {
+    glfwMakeContextCurrent(context);
+
+    while (true) {
+        detail::LoadJob job;
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            _wake.wait(guard, [&] () { return _quit || !_queued.empty(); });
+            if (_quit) break;
+            job = std::move(_queued.front());
+            _queued.pop_front();
+            _running += 1;
+        }
+
+        try {
+            job.work();
+        } catch (...) {
+            job.error = std::current_exception();
+        }
+
+        // The flush makes the fence visible to the render thread's context
+        if (SGL_SYNC_SUPPORTED) {
+            job.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+        } else {
+            glFinish();
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _fenced.push_back(std::move(job));
+            _running -= 1;
+        }
+        _idle.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+void Loader::poll () {
+    std::vector<detail::LoadJob> ready;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _fenced.begin();
+        while (it != _fenced.end()) {
+            if (it->fence != nullptr && glClientWaitSync(it->fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+                it++;
+                continue;
+            }
+            ready.push_back(std::move(*it));
+            it = _fenced.erase(it);
+        }
+        _stats.completed += ready.size();
+    }
+
+    for (auto& job : ready) {
+        if (job.fence != nullptr) glDeleteSync(job.fence);
+        job.fence = nullptr;
+    }
+    std::exception_ptr error;
+    for (auto& job : ready) {
+        if (job.error) error = job.error;
+        else if (job.complete) job.complete();
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void Loader::finish () {
+    {
+        std::unique_lock<std::mutex> guard(_lock);
+        _idle.wait(guard, [&] () { return _queued.empty() && _running == 0; });
+    }
+    std::vector<GLsync> fences;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        for (auto& job : _fenced) fences.push_back(job.fence);
+    }
+    for (GLsync fence : fences) detail::waitFence(fence);
+    poll();
+}
+
+size_t Loader::pending () {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _queued.size() + _running + _fenced.size();
+}
+
+LoaderStats Loader::stats () {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _stats;
+}
+
+void Loader::release () {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (auto& thread : _threads) thread.join();
+    _threads.clear();
+
+    for (auto& job : _fenced) {
+        if (job.fence != nullptr) glDeleteSync(job.fence);
+    }
+    _fenced.clear();
+    _queued.clear();
+
+    for (GLFWwindow* context : _contexts) glfwDestroyWindow(context);
+    _contexts.clear();
+}
@@ -1,5 +1,9 @@
 #include "../include/SimpleGL/helpers/mesh.h"
 
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
 using namespace sgl;
 
 
@@ -56,10 +60,129 @@ MeshResource::MeshResource (MeshData& data) :
     sgl::bufferData(VBO, data.vertices, GL_STATIC_DRAW);
     sgl::bufferData(EBO, data.indices, GL_STATIC_DRAW);
 
-    sgl::VertexAttribBuilder(*this)
-        .addElementBuffer(EBO)
-        .addBuffer<sgl::vec3f, sgl::vec2f, sgl::vec3f>(VBO)
-        .commit();
+    sgl::applyVertexFormat<MeshVertex>(*this, VBO, EBO);
+}
+
+// Buffer edits go through the copy targets so the element array binding of
+// whatever vertex array is bound is left alone.
+using CopyWrite = detail::GLBufferInterface<GL_COPY_WRITE_BUFFER>;
+
+static void copyBuffer (GLuint src, GLuint dst, size_t from, size_t to, size_t len) {
+    if (len == 0) return;
+    if (SGL_DSA_SUPPORTED) {
+        glCopyNamedBufferSubData(src, dst, from, to, len);
+    } else {
+        sgl::bind<GL_COPY_READ_BUFFER>(src);
+        sgl::bind<GL_COPY_WRITE_BUFFER>(dst);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, to, len);
+    }
+    sglDbgCatchGLError();
+}
+
+void ArenaMesh::release () {
+    if (arena != nullptr) arena->remove(*this);
+}
+
+MeshArena::MeshArena (size_t vertexCapacity, size_t indexCapacity) :
+    GLResource<GL_VERTEX_ARRAY>(),
+    _vertices(vertexCapacity),
+    _indices(indexCapacity)
+{
+    CopyWrite::initializeMut(_vbo, NULL, vertexCapacity * sizeof(MeshVertex), GL_DYNAMIC_DRAW);
+    CopyWrite::initializeMut(_ebo, NULL, indexCapacity * sizeof(GLuint), GL_DYNAMIC_DRAW);
+    attach();
+}
+
+void MeshArena::attach () {
+    sgl::applyVertexFormat<MeshVertex>(*this, _vbo, _ebo);
+}
+
+void MeshArena::reallocate (size_t vertexCapacity, size_t indexCapacity,
+                            const std::vector<RangeMove>& vertexMoves, const std::vector<RangeMove>& indexMoves)
+{
+    GLBufferMut<GL_ARRAY_BUFFER, MeshVertex> vbo;
+    GLBufferMut<GL_ELEMENT_ARRAY_BUFFER, GLuint> ebo;
+    CopyWrite::initializeMut(vbo, NULL, vertexCapacity * sizeof(MeshVertex), GL_DYNAMIC_DRAW);
+    CopyWrite::initializeMut(ebo, NULL, indexCapacity * sizeof(GLuint), GL_DYNAMIC_DRAW);
+
+    // Copy everything in place, then the ranges that moved. Sources are
+    // always the old buffers so overlapping moves are fine.
+    size_t vertexBytes = std::min(vertexCapacity, _vertices.capacity()) * sizeof(MeshVertex);
+    size_t indexBytes = std::min(indexCapacity, _indices.capacity()) * sizeof(GLuint);
+    copyBuffer(_vbo, vbo, 0, 0, vertexBytes);
+    copyBuffer(_ebo, ebo, 0, 0, indexBytes);
+    for (const auto& move : vertexMoves) {
+        copyBuffer(_vbo, vbo, move.from * sizeof(MeshVertex), move.to * sizeof(MeshVertex), move.size * sizeof(MeshVertex));
+    }
+    for (const auto& move : indexMoves) {
+        copyBuffer(_ebo, ebo, move.from * sizeof(GLuint), move.to * sizeof(GLuint), move.size * sizeof(GLuint));
+    }
+
+    _vbo.release();
+    _ebo.release();
+    _vbo = vbo;
+    _ebo = ebo;
+    attach();
+}
+
+ArenaMesh MeshArena::add (const MeshData& data) {
+    size_t vertexCount = data.vertices.size();
+    size_t indexCount = data.indices.size();
+    if (vertexCount == 0 || indexCount == 0) {
+        throw std::runtime_error("MeshArena: can't add an empty mesh");
+    }
+
+    size_t baseVertex = _vertices.allocate(vertexCount);
+    size_t firstIndex = _indices.allocate(indexCount);
+    if (baseVertex == RangeAllocator::npos || firstIndex == RangeAllocator::npos) {
+        if (baseVertex != RangeAllocator::npos) _vertices.free(baseVertex);
+        if (firstIndex != RangeAllocator::npos) _indices.free(firstIndex);
+
+        size_t vertexCapacity = std::max(_vertices.capacity() * 2, _vertices.capacity() + vertexCount);
+        size_t indexCapacity = std::max(_indices.capacity() * 2, _indices.capacity() + indexCount);
+        reallocate(vertexCapacity, indexCapacity, {}, {});
+        _vertices.grow(vertexCapacity);
+        _indices.grow(indexCapacity);
+
+        baseVertex = _vertices.allocate(vertexCount);
+        firstIndex = _indices.allocate(indexCount);
+    }
+
+    CopyWrite::update(_vbo, reinterpret_cast<const char*>(&data.vertices[0]), baseVertex * sizeof(MeshVertex), vertexCount * sizeof(MeshVertex));
+    CopyWrite::update(_ebo, reinterpret_cast<const char*>(&data.indices[0]), firstIndex * sizeof(GLuint), indexCount * sizeof(GLuint));
+
+    return ArenaMesh{this, (GLint)baseVertex, (GLuint)firstIndex, (GLsizei)indexCount, (GLsizei)vertexCount};
+}
+
+void MeshArena::remove (ArenaMesh& mesh) {
+    if (mesh.arena != this) return;
+    _vertices.free(mesh.baseVertex);
+    _indices.free(mesh.firstIndex);
+    mesh.arena = nullptr;
+    mesh.count = 0;
+}
+
+void MeshArena::defragment (ArenaMesh* meshes, size_t len) {
+    if (len != _vertices.allocations()) {
+        throw std::runtime_error("MeshArena: defragment needs every live mesh");
+    }
+
+    std::vector<RangeMove> vertexMoves = _vertices.defragment();
+    std::vector<RangeMove> indexMoves = _indices.defragment();
+    if (vertexMoves.empty() && indexMoves.empty()) return;
+    reallocate(_vertices.capacity(), _indices.capacity(), vertexMoves, indexMoves);
+
+    std::map<size_t, size_t> vertexOffsets;
+    std::map<size_t, size_t> indexOffsets;
+    for (const auto& move : vertexMoves) vertexOffsets[move.from] = move.to;
+    for (const auto& move : indexMoves) indexOffsets[move.from] = move.to;
+    for (size_t i = 0; i < len; i++) {
+        ArenaMesh& mesh = meshes[i];
+        auto v = vertexOffsets.find(mesh.baseVertex);
+        auto e = indexOffsets.find(mesh.firstIndex);
+        if (v != vertexOffsets.end()) mesh.baseVertex = v->second;
+        if (e != indexOffsets.end()) mesh.firstIndex = e->second;
+    }
 }
 
 sgl::MeshResource sgl::createPlane (int divs) {
@@ -0,0 +1,227 @@
+#include "../include/SimpleGL/helpers/pbo.h"
+
+#include <SimpleGL/streambuffer.h>
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+using namespace sgl;
+
+using Clock = std::chrono::high_resolution_clock;
+
+static bool isCubeFace (GLenum target) {
+    return target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
+}
+
+void sgl::detail::texSubImage (GLenum target, GLuint texture, const UploadRegion& r, GLenum format, GLenum type, size_t offset) {
+    const GLvoid* pixels = (const GLvoid*)offset;
+    bool dsa = SGL_DSA_SUPPORTED && target != GL_PROXY_TEXTURE_1D && target != GL_PROXY_TEXTURE_2D && !isCubeFace(target);
+
+    switch (target) {
+#ifndef SGL_USE_GLES
+    case GL_TEXTURE_1D:
+        if (dsa) {
+            glTextureSubImage1D(texture, r.level, r.x, r.width, format, type, pixels);
+        } else {
+            sgl::bind<GL_TEXTURE_1D>(texture);
+            glTexSubImage1D(target, r.level, r.x, r.width, format, type, pixels);
+        }
+        break;
+    case GL_TEXTURE_1D_ARRAY:
+#endif
+    case GL_TEXTURE_2D:
+    case GL_TEXTURE_RECTANGLE:
+        if (dsa) {
+            glTextureSubImage2D(texture, r.level, r.x, r.y, r.width, r.height, format, type, pixels);
+        } else {
+            sgl::bindTexture(target, texture);
+            glTexSubImage2D(target, r.level, r.x, r.y, r.width, r.height, format, type, pixels);
+        }
+        break;
+    case GL_TEXTURE_CUBE_MAP:
+        if (dsa) {
+            glTextureSubImage3D(texture, r.level, r.x, r.y, r.z, r.width, r.height, r.depth, format, type, pixels);
+        } else {
+            // One face at a time, faces are consecutive in the buffer
+            sgl::bind<GL_TEXTURE_CUBE_MAP>(texture);
+            size_t faceStride = rowPitch(r.width, format, type) * r.height;
+            for (GLsizei i = 0; i < r.depth; i++) {
+                glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + r.z + i, r.level, r.x, r.y, r.width, r.height,
+                                format, type, (const GLvoid*)(offset + i * faceStride));
+            }
+        }
+        break;
+    case GL_TEXTURE_3D:
+    case GL_TEXTURE_2D_ARRAY:
+        if (dsa) {
+            glTextureSubImage3D(texture, r.level, r.x, r.y, r.z, r.width, r.height, r.depth, format, type, pixels);
+        } else {
+            sgl::bindTexture(target, texture);
+            glTexSubImage3D(target, r.level, r.x, r.y, r.z, r.width, r.height, r.depth, format, type, pixels);
+        }
+        break;
+    default:
+        if (isCubeFace(target)) {
+            sgl::bind<GL_TEXTURE_CUBE_MAP>(texture);
+            glTexSubImage2D(target, r.level, r.x, r.y, r.width, r.height, format, type, pixels);
+            break;
+        }
+        throw std::runtime_error("PBOUploader: unsupported texture target");
+    }
+    sglDbgCatchGLError();
+}
+
+size_t sgl::detail::rowPitch (GLsizei width, GLenum format, GLenum type) {
+    GLint align = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &align);
+    return detail::alignUp(width * traits::formatSize(traits::sizedFormat(format, type)), align);
+}
+
+// OpenGL doesn't read past the last texel, so the last row isn't padded
+size_t sgl::detail::regionSize (const UploadRegion& region, GLenum format, GLenum type) {
+    size_t rows = region.height * region.depth;
+    if (rows == 0 || region.width == 0) return 0;
+    size_t row = region.width * traits::formatSize(traits::sizedFormat(format, type));
+    return (rows - 1) * rowPitch(region.width, format, type) + row;
+}
+
+detail::CopyPool::CopyPool (size_t workers, size_t minChunk) :
+    _dst(nullptr),
+    _src(nullptr),
+    _chunk(0),
+    _size(0),
+    _job(0),
+    _remaining(0),
+    _quit(false),
+    minChunk(minChunk)
+{
+    for (size_t i = 0; i < workers; i++) {
+        _threads.emplace_back(&CopyPool::work, this, i + 1);
+    }
+}
+
+detail::CopyPool::~CopyPool () {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _quit = true;
+    }
+    _start.notify_all();
+    for (auto& thread : _threads) thread.join();
+}
+
+void detail::CopyPool::work (size_t idx) {
+    uint64_t seen = 0;
+    while (true) {
+        std::unique_lock<std::mutex> guard(_lock);
+        _start.wait(guard, [&] () { return _quit || _job != seen; });
+        if (_quit) return;
+        seen = _job;
+        size_t start = idx * _chunk;
+        size_t len = start < _size ? std::min(_chunk, _size - start) : 0;
+        char* dst = _dst;
+        const char* src = _src;
+        guard.unlock();
+
+        if (len > 0) memcpy(dst + start, src + start, len);
+
+        guard.lock();
+        if (--_remaining == 0) _done.notify_one();
+    }
+}
+
+void detail::CopyPool::copy (void* dst, const void* src, size_t size) {
+    size_t parts = std::min(_threads.size() + 1, size / std::max<size_t>(minChunk, 1));
+    if (parts <= 1) {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    size_t chunk = (size + _threads.size()) / (_threads.size() + 1);
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _dst = static_cast<char*>(dst);
+        _src = static_cast<const char*>(src);
+        _chunk = chunk;
+        _size = size;
+        _remaining = _threads.size();
+        _job += 1;
+    }
+    _start.notify_all();
+
+    // The caller copies the first chunk
+    memcpy(dst, src, std::min(chunk, size));
+
+    std::unique_lock<std::mutex> guard(_lock);
+    _done.wait(guard, [&] () { return _remaining == 0; });
+}
+
+PBOUploader::PBOUploader (size_t buffers, size_t workers) :
+    _slots(std::max<size_t>(buffers, 1)),
+    _next(0),
+    _pool(workers > 0 ? new detail::CopyPool(workers) : nullptr),
+    _destKind(GL_TEXTURE_2D),
+    _destTexture(0),
+    _destFormat(GL_RGB),
+    _destType(GL_UNSIGNED_BYTE)
+{
+    resetStats();
+}
+
+PBOUploader::~PBOUploader () {
+    delete _pool;
+}
+
+void PBOUploader::upload (GLenum target, GLuint texture, const void* data, const UploadRegion& region, GLenum format, GLenum type) {
+    auto start = Clock::now();
+    size_t size = detail::regionSize(region, format, type);
+
+    Slot& slot = _slots[_next];
+    _next = (_next + 1) % _slots.size();
+
+    if (detail::waitFence(slot.fence)) _stats.stalls += 1;
+    if (slot.fence != nullptr) glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    if (slot.capacity < size) {
+        detail::GLBufferInterface<GL_PIXEL_UNPACK_BUFFER>::initializeMut(slot.buffer, NULL, size, GL_STREAM_DRAW);
+        slot.capacity = size;
+    }
+
+    // The fence guarantees the GPU is done with this buffer
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    if (SGL_SYNC_SUPPORTED) access |= GL_MAP_UNSYNCHRONIZED_BIT;
+    void* dst = detail::mapBufferRange<GL_PIXEL_UNPACK_BUFFER>(slot.buffer, 0, size, access);
+    if (_pool != nullptr) _pool->copy(dst, data, size);
+    else memcpy(dst, data, size);
+    detail::unmapBuffer<GL_PIXEL_UNPACK_BUFFER>(slot.buffer);
+
+    sgl::bind<GL_PIXEL_UNPACK_BUFFER>(slot.buffer);
+    detail::texSubImage(target, texture, region, format, type, 0);
+    sglCountTextureUpload(size);
+    // Leave unpack buffer unbound so client memory uploads keep working
+    sgl::bind<GL_PIXEL_UNPACK_BUFFER>(0);
+
+    if (SGL_SYNC_SUPPORTED) slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    sglDbgCatchGLError();
+
+    _stats.uploads += 1;
+    _stats.bytes += size;
+    _stats.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void PBOUploader::resetStats () {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void PBOUploader::release () {
+    for (auto& slot : _slots) {
+        if (slot.fence != nullptr) glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        slot.buffer.release();
+        slot.capacity = 0;
+    }
+    delete _pool;
+    _pool = nullptr;
+}
@@ -0,0 +1,92 @@
+#include "../include/SimpleGL/helpers/surfacepool.h"
+
+#include <string.h>
+#include <stdexcept>
+
+using namespace sgl;
+
+static size_t surfaceBytes (const SurfaceKey& key) {
+    return size_t(key.width) * size_t(key.height) * traits::formatSize(key.internalFormat);
+}
+
+SurfacePool::SurfacePool (uint32_t maxIdleFrames) :
+    _frame(0),
+    _maxIdleFrames(maxIdleFrames)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+Surface2D SurfacePool::create (const SurfaceKey& key) {
+    Texture2D texture = TextureBuilder2D()
+        .format(key.format, key.internalFormat)
+        .dataType(key.type)
+        .build(key.width, key.height);
+    return Surface2D(texture);
+}
+
+Surface2D SurfacePool::acquire (const SurfaceKey& key) {
+    _stats.requests += 1;
+    _stats.live += 1;
+    for (auto& entry : _entries) {
+        if (entry.live || !(entry.key == key)) continue;
+        entry.live = true;
+        entry.lastUsed = _frame;
+        _stats.hits += 1;
+        _stats.idle -= 1;
+        return entry.surface;
+    }
+
+    Entry entry = { key, create(key), _frame, true };
+    _entries.push_back(entry);
+    _stats.created += 1;
+    _stats.bytes += surfaceBytes(key);
+    return entry.surface;
+}
+
+void SurfacePool::release (const Surface2D& surface) {
+    for (auto& entry : _entries) {
+        if (entry.surface.fbo != surface.fbo) continue;
+        if (!entry.live) return;
+        entry.live = false;
+        entry.lastUsed = _frame;
+        _stats.live -= 1;
+        _stats.idle += 1;
+        return;
+    }
+    throw std::runtime_error("SurfacePool: surface was not acquired from this pool");
+}
+
+void SurfacePool::evict (bool all) {
+    size_t kept = 0;
+    for (size_t i = 0; i < _entries.size(); i++) {
+        Entry& entry = _entries[i];
+        if (!entry.live && (all || _frame - entry.lastUsed > _maxIdleFrames)) {
+            entry.surface.release();
+            _stats.evicted += 1;
+            _stats.idle -= 1;
+            _stats.bytes -= surfaceBytes(entry.key);
+            continue;
+        }
+        if (kept != i) _entries[kept] = entry;
+        kept += 1;
+    }
+    _entries.erase(_entries.begin() + kept, _entries.end());
+}
+
+void SurfacePool::endFrame () {
+    _frame += 1;
+    evict(false);
+}
+
+void SurfacePool::trim () {
+    evict(true);
+}
+
+void SurfacePool::clear () {
+    for (auto& entry : _entries) entry.surface.release();
+    _stats.evicted += _entries.size();
+    _entries.clear();
+    _stats.live = 0;
+    _stats.idle = 0;
+    _stats.bytes = 0;
+}
@@ -3,7 +3,23 @@
 #include "sglconfig.h"
 
 #include "utils.h"
+#include "allocator.h"
+#include "bindcache.h"
+#include "commandlist.h"
+#include "counters.h"
+#include "gpuprofiler.h"
+#include "handlepool.h"
+#include "deletionqueue.h"
 #include "resource.h"
+#include "indirect.h"
+#include "nulldriver.h"
 #include "shader.h"
+#include "streambuffer.h"
 #include "texture.h"
+#include "trace.h"
+#include "readback.h"
+#include "renderpass.h"
+#include "renderqueue.h"
 #include "traits.h"
+#include "uniformarena.h"
+#include "vertexlayout.h"
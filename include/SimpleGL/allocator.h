@@ -0,0 +1,96 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+#include <map>
+#include <vector>
+
+namespace sgl {
+
+namespace detail {
+    // Round value up to a multiple of alignment
+    inline size_t alignUp (size_t value, size_t alignment) {
+        if (alignment <= 1) return value;
+        return ((value + alignment - 1) / alignment) * alignment;
+    }
+} // end namespace
+
+// A block moved by RangeAllocator::defragment
+struct RangeMove {
+    size_t from;
+    size_t to;
+    size_t size;
+};
+
+/**
+* RangeAllocator hands out ranges of an address space it doesn't own, such
+* as the elements of a GLBuffer. It keeps an offset ordered free list,
+* allocates best fit so small ranges don't split large holes, and merges
+* neighbouring free blocks on free.
+*
+* Sizes, offsets and alignments are in whatever unit the caller uses
+* (bytes, vertices, indices).
+*
+* defragment packs the live ranges to the front of the address space and
+* returns the moves the caller must apply to its storage.
+*
+* ex:
+*
+*     sgl::RangeAllocator alloc(1024);
+*     size_t a = alloc.allocate(100);
+*     size_t b = alloc.allocate(64, 16);    // b % 16 == 0
+*     if (b == sgl::RangeAllocator::npos) alloc.grow(2048);
+*     alloc.free(a);
+*     for (auto& move : alloc.defragment()) copy(move.from, move.to, move.size);
+*/
+class RangeAllocator {
+private:
+    struct Allocation {
+        size_t size;
+        size_t alignment;
+    };
+
+    size_t _capacity;
+    size_t _used;
+    std::map<size_t, size_t> _free;           // offset -> size
+    std::map<size_t, Allocation> _allocations; // offset -> allocation
+
+    void insertFree (size_t offset, size_t size);
+
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    RangeAllocator (size_t capacity = 0);
+
+    // Offset of a range of size units aligned to alignment, or npos if no
+    // free block is large enough.
+    size_t allocate (size_t size, size_t alignment = 1);
+
+    // Release the range starting at offset
+    void free (size_t offset);
+
+    // Extend the address space. Shrinking isn't supported.
+    void grow (size_t capacity);
+
+    // Pack live ranges to the front, preserving their order and alignment.
+    // Moves are returned in ascending order; a move's destination may overlap
+    // its source.
+    std::vector<RangeMove> defragment ();
+
+    // Forget every range
+    void reset ();
+
+    size_t capacity () const { return _capacity; }
+    size_t used () const { return _used; }
+    size_t available () const { return _capacity - _used; }
+    size_t allocations () const { return _allocations.size(); }
+
+    // Number of free blocks. More than one means the free space is fragmented.
+    size_t fragments () const { return _free.size(); }
+
+    size_t largestFree () const;
+};
+
+} // end namespace
+
+#endif // ALLOCATOR_H
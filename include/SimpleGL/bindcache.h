@@ -0,0 +1,293 @@
+#ifndef BINDCACHE_H
+#define BINDCACHE_H
+
+#include "sglconfig.h"
+#include "utils.h"
+#include "counters.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Compile Time configuration flags:
+* SGL_BINDCACHE_TEXTURE_UNITS - Number of texture units tracked by BindCache. Binds on
+*                               higher units are always forwarded to OpenGL.
+*/
+#ifndef SGL_BINDCACHE_TEXTURE_UNITS
+#   define SGL_BINDCACHE_TEXTURE_UNITS 32
+#endif
+
+namespace sgl {
+
+namespace detail {
+
+    // Dense index for every binding point BindCache knows about.
+    enum BindSlot {
+        SLOT_ARRAY_BUFFER = 0,
+        SLOT_ELEMENT_ARRAY_BUFFER,
+        SLOT_COPY_READ_BUFFER,
+        SLOT_COPY_WRITE_BUFFER,
+        SLOT_PIXEL_PACK_BUFFER,
+        SLOT_PIXEL_UNPACK_BUFFER,
+        SLOT_QUERY_BUFFER,
+        SLOT_TEXTURE_BUFFER,
+        SLOT_TRANSFORM_FEEDBACK_BUFFER,
+        SLOT_DRAW_INDIRECT_BUFFER,
+        SLOT_ATOMIC_COUNTER_BUFFER,
+        SLOT_DISPATCH_INDIRECT_BUFFER,
+        SLOT_SHADER_STORAGE_BUFFER,
+        SLOT_UNIFORM_BUFFER,
+        SLOT_DRAW_FRAMEBUFFER,
+        SLOT_READ_FRAMEBUFFER,
+        SLOT_RENDERBUFFER,
+        SLOT_VERTEX_ARRAY,
+        SLOT_PROGRAM,
+        SLOT_GLOBAL_COUNT,
+
+        // Texture slots are tracked per texture unit
+        SLOT_TEXTURE_1D = SLOT_GLOBAL_COUNT,
+        SLOT_TEXTURE_2D,
+        SLOT_TEXTURE_3D,
+        SLOT_TEXTURE_RECTANGLE,
+        SLOT_TEXTURE_CUBE_MAP,
+        SLOT_TEXTURE_1D_ARRAY,
+        SLOT_TEXTURE_2D_ARRAY,
+        SLOT_TEXTURE_CUBE_MAP_ARRAY,
+        SLOT_TEXTURE_2D_MULTISAMPLE,
+        SLOT_TEXTURE_2D_MULTISAMPLE_ARRAY,
+        SLOT_COUNT,
+
+        // GL_FRAMEBUFFER binds both the draw and read framebuffer
+        SLOT_FRAMEBUFFER = SLOT_COUNT,
+        SLOT_NONE = -1
+    };
+
+    const int SLOT_TEXTURE_COUNT = SLOT_COUNT - SLOT_GLOBAL_COUNT;
+
+    inline int bindSlot (GLenum kind) {
+        switch (kind) {
+        case GL_ARRAY_BUFFER:              return SLOT_ARRAY_BUFFER;
+        case GL_ELEMENT_ARRAY_BUFFER:      return SLOT_ELEMENT_ARRAY_BUFFER;
+        case GL_COPY_READ_BUFFER:          return SLOT_COPY_READ_BUFFER;
+        case GL_COPY_WRITE_BUFFER:         return SLOT_COPY_WRITE_BUFFER;
+        case GL_PIXEL_PACK_BUFFER:         return SLOT_PIXEL_PACK_BUFFER;
+        case GL_PIXEL_UNPACK_BUFFER:       return SLOT_PIXEL_UNPACK_BUFFER;
+        case GL_QUERY_BUFFER:              return SLOT_QUERY_BUFFER;
+        case GL_TEXTURE_BUFFER:            return SLOT_TEXTURE_BUFFER;
+        case GL_TRANSFORM_FEEDBACK_BUFFER: return SLOT_TRANSFORM_FEEDBACK_BUFFER;
+        case GL_DRAW_INDIRECT_BUFFER:      return SLOT_DRAW_INDIRECT_BUFFER;
+        case GL_ATOMIC_COUNTER_BUFFER:     return SLOT_ATOMIC_COUNTER_BUFFER;
+        case GL_DISPATCH_INDIRECT_BUFFER:  return SLOT_DISPATCH_INDIRECT_BUFFER;
+        case GL_SHADER_STORAGE_BUFFER:     return SLOT_SHADER_STORAGE_BUFFER;
+        case GL_UNIFORM_BUFFER:            return SLOT_UNIFORM_BUFFER;
+        case GL_FRAMEBUFFER:               return SLOT_FRAMEBUFFER;
+        case GL_DRAW_FRAMEBUFFER:          return SLOT_DRAW_FRAMEBUFFER;
+        case GL_READ_FRAMEBUFFER:          return SLOT_READ_FRAMEBUFFER;
+        case GL_RENDERBUFFER:              return SLOT_RENDERBUFFER;
+        case GL_VERTEX_ARRAY:              return SLOT_VERTEX_ARRAY;
+        case GL_PROGRAM:                   return SLOT_PROGRAM;
+        case GL_TEXTURE_1D:                return SLOT_TEXTURE_1D;
+        case GL_TEXTURE_2D:                return SLOT_TEXTURE_2D;
+        case GL_TEXTURE_3D:                return SLOT_TEXTURE_3D;
+        case GL_TEXTURE_RECTANGLE:         return SLOT_TEXTURE_RECTANGLE;
+        case GL_TEXTURE_CUBE_MAP:          return SLOT_TEXTURE_CUBE_MAP;
+        case GL_TEXTURE_1D_ARRAY:          return SLOT_TEXTURE_1D_ARRAY;
+        case GL_TEXTURE_2D_ARRAY:          return SLOT_TEXTURE_2D_ARRAY;
+        case GL_TEXTURE_CUBE_MAP_ARRAY:    return SLOT_TEXTURE_CUBE_MAP_ARRAY;
+        case GL_TEXTURE_2D_MULTISAMPLE:    return SLOT_TEXTURE_2D_MULTISAMPLE;
+        case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return SLOT_TEXTURE_2D_MULTISAMPLE_ARRAY;
+        default:                           return SLOT_NONE;
+        }
+    }
+
+    // glGet enum used to validate the given binding point
+    GLenum bindingQuery (int slot);
+
+} // end namespace
+
+struct BindCacheStats {
+    uint64_t binds;      // Binds forwarded to OpenGL
+    uint64_t elided;     // Binds skipped because the name was already bound
+    uint64_t mismatches; // Validation failures. Non zero means someone bound behind our back.
+};
+
+/**
+* BindCache remembers the name bound to every binding point of a single
+* context and lets sgl::bind skip binds that wouldn't change anything.
+* It is opt-in: nothing is cached until a cache is installed on the
+* current thread with sgl::setBindCache (sgl::Context does this for you
+* when built with ContextBuilder::setBindCache).
+*
+* Raw OpenGL calls made behind SimpleGL's back will desynchronize the cache.
+* Call BindCache::invalidate after such code, or enable validation to have
+* every elided bind cross-checked with glGet.
+*
+* ex:
+*
+*     sgl::BindCache cache;
+*     sgl::setBindCache(&cache);
+*     buffer.bind();         // glBindBuffer
+*     buffer.bind();         // skipped
+*     thirdPartyRender();    // Binds who knows what
+*     cache.invalidate();
+*     buffer.bind();         // glBindBuffer
+*/
+class BindCache {
+private:
+    static const GLuint UNKNOWN = 0xffffffff;
+
+    GLuint _bound[detail::SLOT_GLOBAL_COUNT];
+    GLuint _textures[SGL_BINDCACHE_TEXTURE_UNITS][detail::SLOT_TEXTURE_COUNT];
+    GLuint _activeUnit;
+    bool _activeUnitKnown;
+
+    BindCacheStats _frame;
+    BindCacheStats _lastFrame;
+
+    GLuint* slotPtr (int slot) {
+        if (slot < detail::SLOT_GLOBAL_COUNT) return &_bound[slot];
+        if (!_activeUnitKnown || _activeUnit >= SGL_BINDCACHE_TEXTURE_UNITS) return nullptr;
+        return &_textures[_activeUnit][slot - detail::SLOT_GLOBAL_COUNT];
+    }
+
+    bool validateSlot (int slot, GLuint res);
+
+public:
+    // Cross check every elided bind against glGet. Slow, meant for debugging.
+    bool validate;
+
+    BindCache (bool validate = false);
+
+    // Returns true if res is already bound to kind and the bind can be skipped.
+    // Otherwise records res as bound, expecting the caller to perform the bind.
+    bool elide (GLenum kind, GLuint res) {
+        int slot = detail::bindSlot(kind);
+        if (slot == detail::SLOT_NONE) return false;
+
+        if (slot == detail::SLOT_FRAMEBUFFER) {
+            if (_bound[detail::SLOT_DRAW_FRAMEBUFFER] == res && _bound[detail::SLOT_READ_FRAMEBUFFER] == res) {
+                if (!validate || (validateSlot(detail::SLOT_DRAW_FRAMEBUFFER, res) && validateSlot(detail::SLOT_READ_FRAMEBUFFER, res))) {
+                    _frame.elided += 1;
+                    return true;
+                }
+            }
+            _bound[detail::SLOT_DRAW_FRAMEBUFFER] = res;
+            _bound[detail::SLOT_READ_FRAMEBUFFER] = res;
+            _frame.binds += 1;
+            return false;
+        }
+
+        GLuint* bound = slotPtr(slot);
+        if (bound == nullptr) {
+            _frame.binds += 1;
+            return false;
+        }
+
+        if (*bound == res && (!validate || validateSlot(slot, res))) {
+            _frame.elided += 1;
+            return true;
+        }
+
+        *bound = res;
+        // Element array binding is part of vertex array state
+        if (slot == detail::SLOT_VERTEX_ARRAY) _bound[detail::SLOT_ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+        _frame.binds += 1;
+        return false;
+    }
+
+    // Same as elide but for glActiveTexture. unit is zero based.
+    bool elideActiveTexture (GLuint unit) {
+        if (_activeUnitKnown && _activeUnit == unit) {
+            _frame.elided += 1;
+            return true;
+        }
+        _activeUnit = unit;
+        _activeUnitKnown = true;
+        _frame.binds += 1;
+        return false;
+    }
+
+    // Record a binding made outside of sgl::bind (eg: glBindBufferBase also binds the generic target)
+    void note (GLenum kind, GLuint res);
+
+    // Forget deleted names. Deletion may be deferred (see HandlePool), so binding
+    // points holding one of the names become unknown rather than 0.
+    void forget (GLenum kind, size_t len, const GLuint* ids);
+
+    // Mark all binding points as unknown. Call after raw OpenGL interop.
+    void invalidate ();
+
+    // Mark a single binding point as unknown
+    void invalidate (GLenum kind);
+
+    // Close the current frame's statistics
+    void endFrame ();
+
+    const BindCacheStats& frameStats () const { return _frame; }
+    const BindCacheStats& lastFrameStats () const { return _lastFrame; }
+};
+
+namespace detail {
+    extern thread_local BindCache* __sglBindCache;
+    extern thread_local GLuint __sglDefaultFramebuffer;
+
+    inline BindCache* currentBindCache () {
+        return __sglBindCache;
+    }
+
+    // Name actually bound when binding framebuffer name
+    inline GLuint framebufferName (GLuint name) {
+        return name != 0 ? name : __sglDefaultFramebuffer;
+    }
+} // end namespace
+
+// Install cache as the bind cache of the calling thread's current context.
+// Passing nullptr disables bind caching.
+void setBindCache (BindCache* cache);
+
+inline BindCache* getBindCache () {
+    return detail::currentBindCache();
+}
+
+// Framebuffer sgl::bind binds in place of 0 on the calling thread. Contexts
+// without a default framebuffer render into an offscreen one instead (see
+// ContextBuilder::setHeadless). Raw glBindFramebuffer calls aren't redirected.
+inline void setDefaultFramebuffer (GLuint framebuffer) {
+    detail::__sglDefaultFramebuffer = framebuffer;
+}
+
+inline GLuint getDefaultFramebuffer () {
+    return detail::__sglDefaultFramebuffer;
+}
+
+// Invalidate the current bind cache, if any. Use after raw OpenGL interop.
+inline void invalidateBindCache () {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr) cache->invalidate();
+}
+
+inline void invalidateBindCache (GLenum kind) {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr) cache->invalidate(kind);
+}
+
+// Cache aware equivalents of glActiveTexture and glBindTexture for
+// targets only known at runtime.
+inline void activeTexture (GLuint unit) {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr && cache->elideActiveTexture(unit)) return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    sglCountActiveTexture();
+}
+
+inline void bindTexture (GLenum target, GLuint handle) {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr && cache->elide(target, handle)) return;
+    glBindTexture(target, handle);
+    sglCountBind(target);
+    sglDbgLogBind(target, handle);
+}
+
+} // end namespace
+
+#endif // BINDCACHE_H
@@ -0,0 +1,176 @@
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include "sglconfig.h"
+#include "resource.h"
+#include "shader.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+namespace sgl {
+
+namespace detail {
+    enum CommandOp {
+        CMD_BIND = 0,       // target, name
+        CMD_TEXTURE,        // target, name, unit
+        CMD_UNIFORM_1I,     // program, location, data
+        CMD_UNIFORM_1F,
+        CMD_UNIFORM_2F,
+        CMD_UNIFORM_3F,
+        CMD_UNIFORM_4F,
+        CMD_UNIFORM_MAT3,
+        CMD_UNIFORM_MAT4,
+        CMD_BUFFER_RANGE,   // target, name, unit, offset, size
+        CMD_VIEWPORT,       // x, y, width, height
+        CMD_DRAW_ARRAYS,    // mode, first, count, instances
+        CMD_DRAW_ELEMENTS,  // mode, type, count, offset, instances
+        CMD_DISPATCH        // x, y, z
+    };
+
+    // Every command has the same size so the stream is a flat array.
+    // Uniform values live in CommandList's data array, args[0] is their index.
+    // Offsets and sizes are stored in 32 bits.
+    struct Command {
+        uint16_t op;
+        uint16_t unit;
+        GLenum target;
+        GLuint name;
+        GLint location;
+        uint32_t args[4];
+    };
+
+    static_assert(std::is_pod<Command>::value, "Commands must be POD");
+
+    // Cache aware bind for targets only known at runtime
+    void bindTarget (GLenum target, GLuint name);
+} // end namespace
+
+struct CommandListStats {
+    uint64_t recorded; // Commands recorded
+    uint64_t collapsed; // Redundant commands removed by end()
+    uint64_t replays;
+    uint64_t executed; // Commands executed over all replays
+};
+
+/**
+* CommandList records binds, uniform sets, texture binds, draws and dispatches
+* into a flat stream of POD commands instead of executing them. end() walks
+* the stream once and drops state changes that can't have an effect: binding
+* what the list already bound, setting a uniform to the value it already holds
+* in that program, rebinding a texture on a unit. replay() then runs the
+* remaining commands with a single switch per command, with no uniform lookups
+* and no allocations.
+*
+* Uniform locations are resolved while recording, so recording needs a
+* current context. Resources are recorded by name: the list doesn't keep them
+* alive and has to be recorded again if they are recreated. Values that change
+* every frame belong in a uniform buffer the list binds (see uniformBlock).
+*
+* State at the start of replay() is unknown to the list, so the first bind of
+* each kind is always kept. It is still skipped at runtime when a BindCache is
+* installed, and replay() keeps the BindCache in sync.
+*
+* Slab passes swap surfaces, so a ping-pong chain with an odd number of swaps
+* per frame needs one list per parity.
+*
+* ex:
+*
+*     sgl::CommandList advect;
+*     advect.bind(dest.fbo);
+*     advect.bind(advectShader);
+*     advect.texture(advectShader, "VelocityTexture", velocity.texture, 0);
+*     advect.uniform(advectShader, "TimeStep", 0.125f);
+*     advect.bind(renderQuad.vao);
+*     advect.drawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT);
+*     advect.end();
+*     while (running) {
+*         advect.replay();
+*         ...
+*     }
+*/
+class CommandList {
+private:
+    std::vector<detail::Command> _commands;
+    std::vector<float> _data;
+    GLuint _program;
+    bool _ended;
+    CommandListStats _stats;
+
+    detail::Command& push (detail::CommandOp op);
+    void uniform (detail::CommandOp op, Shader& shader, const char* id, const float* values, size_t count);
+
+public:
+    CommandList ();
+
+    template <GLenum kind>
+    void bind (GLResource<kind>& res) {
+        bind(kind, static_cast<GLuint>(res));
+    }
+
+    void bind (GLenum target, GLuint name);
+
+    // Bind texture to unit, as Shader::setTexture does when replayed
+    template <GLenum kind>
+    void texture (GLuint unit, GLResource<kind>& tex) {
+        static_assert(traits::IsTexture<kind>::value, "Must supply texture target");
+        texture(unit, kind, static_cast<GLuint>(tex));
+    }
+
+    void texture (GLuint unit, GLenum target, GLuint name);
+
+    // Bind texture to unit and point the sampler id of shader at it
+    template <GLenum kind>
+    void texture (Shader& shader, const char* id, GLResource<kind>& tex, GLuint unit) {
+        static_assert(traits::IsTexture<kind>::value, "Must supply texture target");
+        uniform(shader, id, static_cast<int>(unit));
+        texture(unit, kind, static_cast<GLuint>(tex));
+    }
+
+    // Uniforms are set on shader, binding it first if it isn't the list's current program
+    void uniform (Shader& shader, const char* id, int v);
+    void uniform (Shader& shader, const char* id, float v);
+    void uniform (Shader& shader, const char* id, float x, float y);
+    void uniform (Shader& shader, const char* id, float x, float y, float z);
+    void uniform (Shader& shader, const char* id, float x, float y, float z, float w);
+    void uniformMatrix3 (Shader& shader, const char* id, const float* matrix);
+    void uniformMatrix4 (Shader& shader, const char* id, const float* matrix);
+
+    // glBindBufferRange. size 0 binds the whole buffer with glBindBufferBase.
+    template <GLenum kind>
+    void bindRange (GLResource<kind>& buffer, GLuint unit, size_t offset = 0, size_t size = 0) {
+        static_assert(traits::IsBuffer<kind>::value, "Must supply buffer target");
+        bindRange(kind, static_cast<GLuint>(buffer), unit, offset, size);
+    }
+
+    void bindRange (GLenum target, GLuint buffer, GLuint unit, size_t offset, size_t size);
+
+    // Bind buffer to unit and point uniform block id of shader at it
+    void uniformBlock (Shader& shader, const char* id, GLResource<GL_UNIFORM_BUFFER>& buffer, GLuint unit, size_t offset = 0, size_t size = 0);
+
+    void viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+    void drawArrays (GLenum mode, GLint first, GLsizei count, GLsizei instances = 1);
+    void drawElements (GLenum mode, GLsizei count, GLenum type, size_t offset = 0, GLsizei instances = 1);
+    void dispatch (GLuint x, GLuint y = 1, GLuint z = 1);
+
+    // Finish recording and collapse redundant state changes
+    void end ();
+
+    // Execute the list. Calls end() if it hasn't been.
+    void replay ();
+
+    // Drop every command so the list can be recorded again
+    void clear ();
+
+    size_t size () const { return _commands.size(); }
+    bool empty () const { return _commands.empty(); }
+    const detail::Command* commands () const { return _commands.data(); }
+    const CommandListStats& stats () const { return _stats; }
+};
+
+} // end namespace
+
+#endif // COMMANDLIST_H
@@ -0,0 +1,124 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include "sglconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Compile Time configuration flags:
+* SGL_COUNTERS - 1 to count GL calls made through SimpleGL, 0 to compile the counters out
+*/
+#ifndef SGL_COUNTERS
+#   define SGL_COUNTERS 1
+#endif
+
+namespace sgl {
+
+namespace detail {
+    // Bind counters are indexed by detail::BindSlot. The last one collects
+    // binds to targets BindCache doesn't know about.
+    const int COUNTER_BIND_SLOTS = 32;
+    const int COUNTER_BIND_OTHER = COUNTER_BIND_SLOTS - 1;
+} // end namespace
+
+struct GLCounters {
+    uint64_t binds[detail::COUNTER_BIND_SLOTS];
+    uint64_t activeTextures;  // glActiveTexture calls
+    uint64_t draws;           // Draw calls, a multi draw counts once
+    uint64_t dispatches;
+    uint64_t uniforms;        // glUniform* calls
+    uint64_t bufferUploads;   // glBufferData, glBufferStorage and glBufferSubData calls
+    uint64_t bufferBytes;
+    uint64_t textureUploads;  // glTexImage and glTexSubImage calls with data
+    uint64_t textureBytes;
+    uint64_t creations;       // Objects created, a glGen* of n names counts n
+    uint64_t deletions;
+
+    // Binds to target. GL_FRAMEBUFFER only counts binds of both framebuffers.
+    uint64_t bindsOf (GLenum target) const;
+
+    uint64_t totalBinds () const;
+};
+
+namespace detail {
+    extern thread_local GLCounters __sglCounters;
+
+    inline void countBind (int slot) {
+        __sglCounters.binds[slot < 0 ? COUNTER_BIND_OTHER : slot] += 1;
+    }
+
+    inline void countBufferUpload (size_t bytes) {
+        __sglCounters.bufferUploads += 1;
+        __sglCounters.bufferBytes += bytes;
+    }
+
+    inline void countTextureUpload (size_t bytes) {
+        __sglCounters.textureUploads += 1;
+        __sglCounters.textureBytes += bytes;
+    }
+} // end namespace
+
+/**
+* Every thread counts the GL calls SimpleGL makes on it: binds per target,
+* draw calls, uniform sets, buffer and texture uploads with their size in
+* bytes, and object creations and deletions. Counting is a thread local
+* increment, so it is always on; build with SGL_COUNTERS=0 to remove it.
+* Raw OpenGL calls made outside SimpleGL aren't counted.
+*
+* endCounterFrame() snapshots the counts of the frame that just ended.
+* sgl::Context calls it from swapBuffers.
+*
+* ex:
+*
+*     while (running) {
+*         render();
+*         context.swapBuffers();
+*         const sgl::GLCounters& frame = sgl::frameCounters();
+*         printf("%lu draws, %lu binds, %lu bytes uploaded\n",
+*                frame.draws, frame.totalBinds(), frame.bufferBytes + frame.textureBytes);
+*     }
+*/
+
+// Counts since the thread started or resetCounters() was last called
+inline const GLCounters& counters () {
+    return detail::__sglCounters;
+}
+
+// Counts of the last frame ended on this thread
+const GLCounters& frameCounters ();
+
+// Frames ended on this thread
+uint64_t counterFrame ();
+
+// End the current frame, making its counts available through frameCounters()
+void endCounterFrame ();
+
+void resetCounters ();
+
+} // end namespace
+
+#if SGL_COUNTERS
+#   define sglCountBind(kind) sgl::detail::countBind(sgl::detail::bindSlot(kind))
+#   define sglCountActiveTexture() (sgl::detail::__sglCounters.activeTextures += 1)
+#   define sglCountDraw() (sgl::detail::__sglCounters.draws += 1)
+#   define sglCountDispatch() (sgl::detail::__sglCounters.dispatches += 1)
+#   define sglCountUniform() (sgl::detail::__sglCounters.uniforms += 1)
+#   define sglCountBufferUpload(bytes) sgl::detail::countBufferUpload(bytes)
+#   define sglCountTextureUpload(bytes) sgl::detail::countTextureUpload(bytes)
+#   define sglCountCreation(len) (sgl::detail::__sglCounters.creations += (len))
+#   define sglCountDeletion(len) (sgl::detail::__sglCounters.deletions += (len))
+#else
+#   define sglCountBind(kind)
+#   define sglCountActiveTexture()
+#   define sglCountDraw()
+#   define sglCountDispatch()
+#   define sglCountUniform()
+#   define sglCountBufferUpload(bytes)
+#   define sglCountTextureUpload(bytes)
+#   define sglCountCreation(len)
+#   define sglCountDeletion(len)
+#endif
+
+#endif // COUNTERS_H
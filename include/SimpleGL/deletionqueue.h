@@ -0,0 +1,141 @@
+#ifndef DELETIONQUEUE_H
+#define DELETIONQUEUE_H
+
+#include "sglconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace sgl {
+
+namespace detail {
+    // Object kinds sharing a glDelete* call
+    enum DeletionFamily {
+        DELETE_BUFFER = 0,
+        DELETE_TEXTURE,
+        DELETE_FRAMEBUFFER,
+        DELETE_RENDERBUFFER,
+        DELETE_VERTEX_ARRAY,
+        DELETE_PROGRAM,
+        DELETE_SHADER,
+        DELETE_FAMILY_COUNT,
+        DELETE_NONE = -1
+    };
+
+    int deletionFamily (GLenum kind);
+
+    // Vertex arrays and framebuffers only exist in the context that made them
+    inline bool sharedFamily (int family) {
+        return family != DELETE_FRAMEBUFFER && family != DELETE_VERTEX_ARRAY;
+    }
+
+    // Delete names of a family with a single call where OpenGL allows it
+    void deleteNames (int family, size_t len, const GLuint* ids);
+
+    struct DeletionBatch {
+        GLsync fence = nullptr;
+        uint64_t frame = 0;
+        std::vector<GLuint> names[DELETE_FAMILY_COUNT];
+
+        bool empty () const;
+    };
+} // end namespace
+
+struct DeletionQueueStats {
+    uint64_t enqueued;    // Names queued for deletion
+    uint64_t deleted;     // Names handed to glDelete*
+    uint64_t deleteCalls; // glDelete* calls
+};
+
+/**
+* DeletionQueue defers GLResource::release until the GPU is done with the frame
+* the resource was released in. Names released during a frame are collected into
+* a batch, a fence is inserted at the end of the frame, and the batch is deleted,
+* one glDelete* call per kind, once that fence has signaled. Retiring never
+* blocks. If fences aren't supported batches are retired after maxFramesInFlight
+* frames instead.
+*
+* enqueue is thread safe and makes no OpenGL calls, so resources can be released
+* from worker threads. All other methods must be called from the thread the
+* context is current on.
+*
+* Unlike BindCache and HandlePool, the installed queue is global rather than per
+* thread so that worker threads release into it. sgl::Context installs its queue
+* and retires it every swapBuffers when built with ContextBuilder::setDeferredDeletion.
+* Vertex arrays and framebuffers aren't shared between contexts, so a name
+* released on another context would delete an unrelated object on the one
+* draining the queue. They are never queued and are deleted immediately instead.
+*
+* ex:
+*
+*     sgl::DeletionQueue queue;
+*     sgl::setDeletionQueue(&queue);
+*     buffer.release();                               // Queued, buffer may still be in use
+*     std::thread([=] () mutable { texture.release(); }).join(); // Queued from a worker
+*     queue.endFrame();                               // Fence the frame, delete retired batches
+*     ...
+*     queue.flush();                                  // Delete everything now
+*/
+class DeletionQueue {
+private:
+    mutable std::mutex _lock;
+    detail::DeletionBatch _incoming;
+    std::deque<detail::DeletionBatch> _inflight;
+
+    size_t _maxFramesInFlight;
+    uint64_t _frame;
+    DeletionQueueStats _stats;
+
+    void destroy (detail::DeletionBatch& batch);
+
+public:
+    DeletionQueue (size_t maxFramesInFlight = 3);
+    ~DeletionQueue ();
+
+    DeletionQueue (const DeletionQueue&) = delete;
+    DeletionQueue& operator= (const DeletionQueue&) = delete;
+
+    // Queue names of kind for deletion. Thread safe. Returns false, queueing
+    // nothing, for kinds that must be deleted on the releasing context.
+    bool enqueue (GLenum kind, size_t len, const GLuint* ids);
+
+    // Close the current frame's batch with a fence, then retire.
+    void endFrame ();
+
+    // Delete every batch whose fence has signaled
+    void retire ();
+
+    // Delete everything immediately, including names queued this frame
+    void flush ();
+
+    // Names waiting to be deleted
+    size_t pending () const;
+
+    DeletionQueueStats stats () const;
+};
+
+namespace detail {
+    extern std::atomic<DeletionQueue*> __sglDeletionQueue;
+
+    inline DeletionQueue* currentDeletionQueue () {
+        return __sglDeletionQueue.load(std::memory_order_acquire);
+    }
+} // end namespace
+
+// Route sgl::destroy (and so GLResource::release) through queue, from every thread.
+// Passing nullptr restores immediate deletion.
+inline void setDeletionQueue (DeletionQueue* queue) {
+    detail::__sglDeletionQueue.store(queue, std::memory_order_release);
+}
+
+inline DeletionQueue* getDeletionQueue () {
+    return detail::currentDeletionQueue();
+}
+
+} // end namespace
+
+#endif // DELETIONQUEUE_H
@@ -0,0 +1,219 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include "sglconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+* Compile Time configuration flags:
+* SGL_PROFILER_FRAMES  - Frames of queries in flight before their results are read back
+* SGL_PROFILER_HISTORY - Frames of results kept per scope for min, avg and p99
+*/
+#ifndef SGL_PROFILER_FRAMES
+#   define SGL_PROFILER_FRAMES 4
+#endif
+
+#ifndef SGL_PROFILER_HISTORY
+#   define SGL_PROFILER_HISTORY 240
+#endif
+
+namespace sgl {
+
+// ARB_pipeline_statistics_query counters of a scope
+struct PipelineStatistics {
+    uint64_t verticesSubmitted;
+    uint64_t primitivesSubmitted;
+    uint64_t vertexShaderInvocations;
+    uint64_t fragmentShaderInvocations;
+    uint64_t computeShaderInvocations;
+};
+
+// Per frame GPU time of a scope, summed over every time it ran in a frame
+struct GpuScopeStats {
+    std::string name;
+    uint64_t frames;    // Frames in the history the scope ran in
+    double lastMs;
+    double minMs;
+    double avgMs;
+    double p99Ms;
+    double maxMs;
+    PipelineStatistics pipeline; // Of the last resolved frame, when collected
+};
+
+// A resolved scope, GPU timestamps in nanoseconds
+struct GpuSample {
+    uint32_t scope;     // Index into GpuProfiler::scopeName
+    uint32_t depth;     // Nesting depth
+    uint64_t frame;
+    uint64_t beginNs;
+    uint64_t endNs;
+};
+
+namespace detail {
+    struct PendingScope {
+        uint32_t scope;
+        uint32_t depth;
+        uint32_t query;       // Begin timestamp, end is query + 1
+        int32_t statistics;   // First pipeline statistics query, -1 if none
+    };
+
+    struct ProfilerFrame {
+        std::vector<GLuint> timestamps;
+        std::vector<GLuint> statistics;
+        std::vector<PendingScope> scopes;
+        uint32_t usedTimestamps;
+        uint32_t usedStatistics;
+        uint64_t frame;
+        bool pending;
+    };
+
+    struct ScopeHistory {
+        std::string name;
+        double samples[SGL_PROFILER_HISTORY];
+        size_t count;
+        size_t next;
+        double frameMs;       // Accumulates the frame being resolved
+        bool seen;
+        PipelineStatistics pipeline;
+    };
+} // end namespace
+
+/**
+* GpuProfiler measures GPU time per named scope without stalling. Scopes
+* write GL_TIMESTAMP queries from a ring of SGL_PROFILER_FRAMES frames; a
+* frame's queries are only read back once their results are available,
+* normally a frame or two later. If the ring wraps before a frame resolves
+* that frame is dropped instead of waited on.
+*
+* Scopes nest. Results are kept per scope name, as the total time the scope
+* took each frame (a scope begun ten times in a frame, like a jacobi
+* iteration, reports the sum). With pipeline statistics enabled the
+* outermost scopes also collect ARB_pipeline_statistics_query counters.
+*
+* Timer queries need OpenGL 3.3; elsewhere the profiler records nothing.
+*
+* ex:
+*
+*     sgl::GpuProfiler profiler;
+*     while (running) {
+*         {
+*             auto scope = profiler.scope("advect");
+*             applyAdvect(...);
+*         }
+*         profiler.begin("jacobi");
+*         for (int i = 0; i < 10; i++) applyJacobi(...);
+*         profiler.end();
+*         profiler.endFrame();
+*     }
+*     for (auto& s : profiler.stats()) printf("%s: %f ms (p99 %f)\n", s.name.c_str(), s.avgMs, s.p99Ms);
+*/
+class GpuProfiler {
+public:
+    // Ends its scope when destroyed
+    class Scope {
+    private:
+        GpuProfiler* _profiler;
+    public:
+        Scope (GpuProfiler* profiler, const char* name) :
+            _profiler(profiler)
+        {
+            if (_profiler != nullptr) _profiler->begin(name);
+        }
+
+        Scope (Scope&& other) :
+            _profiler(other._profiler)
+        {
+            other._profiler = nullptr;
+        }
+
+        Scope (const Scope&) = delete;
+
+        ~Scope () {
+            if (_profiler != nullptr) _profiler->end();
+        }
+    };
+
+private:
+    detail::ProfilerFrame _frames[SGL_PROFILER_FRAMES];
+    std::vector<detail::ScopeHistory> _scopes;
+    std::unordered_map<std::string, uint32_t> _scopeIds;
+    std::vector<uint32_t> _stack;
+    std::vector<GpuSample> _resolved;
+    uint64_t _frame;
+    uint64_t _dropped;
+    int _statisticsDepth;
+    bool _pipelineStatistics;
+
+    uint32_t scopeId (const char* name);
+    GLuint timestampQuery (detail::ProfilerFrame& frame);
+    void resolve ();
+    void resolve (detail::ProfilerFrame& frame);
+
+public:
+    // pipelineStatistics is ignored when ARB_pipeline_statistics_query isn't available
+    GpuProfiler (bool pipelineStatistics = false);
+
+    GpuProfiler (const GpuProfiler&) = delete;
+    GpuProfiler& operator= (const GpuProfiler&) = delete;
+
+    void begin (const char* name);
+    void end ();
+
+    Scope scope (const char* name) {
+        return Scope(this, name);
+    }
+
+    // Close the frame's queries and read back every frame whose results are ready
+    void endFrame ();
+
+    // Statistics of every scope seen so far
+    std::vector<GpuScopeStats> stats () const;
+
+    // Statistics of one scope. Returns false if it hasn't resolved yet.
+    bool stats (const char* name, GpuScopeStats& dest) const;
+
+    // Scopes of the most recently resolved frame
+    const std::vector<GpuSample>& resolved () const { return _resolved; }
+
+    const std::string& scopeName (uint32_t scope) const { return _scopes[scope].name; }
+
+    // Frames ended so far
+    uint64_t frame () const { return _frame; }
+
+    // Frames whose queries weren't ready when the ring wrapped
+    uint64_t dropped () const { return _dropped; }
+
+    bool enabled () const;
+
+    // Forget collected statistics, keeping the query objects
+    void reset ();
+
+    // Delete every query object
+    void release ();
+};
+
+namespace detail {
+    extern thread_local GpuProfiler* __sglGpuProfiler;
+} // end namespace
+
+// Profiler used by sglGpuScope on this thread. nullptr disables it.
+void setGpuProfiler (GpuProfiler* profiler);
+
+inline GpuProfiler* getGpuProfiler () {
+    return detail::__sglGpuProfiler;
+}
+
+} // end namespace
+
+#define SGL_PROFILER_CONCAT_(a,b) a##b
+#define SGL_PROFILER_CONCAT(a,b) SGL_PROFILER_CONCAT_(a,b)
+
+// Time the rest of the enclosing block on the current thread's profiler, if any
+#define sglGpuScope(name) sgl::GpuProfiler::Scope SGL_PROFILER_CONCAT(__sglGpuScope, __LINE__)(sgl::getGpuProfiler(), name)
+
+#endif // GPUPROFILER_H
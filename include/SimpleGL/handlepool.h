@@ -0,0 +1,138 @@
+#ifndef HANDLEPOOL_H
+#define HANDLEPOOL_H
+
+#include "sglconfig.h"
+#include "bindcache.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace sgl {
+
+namespace detail {
+    using PoolCreator = void (*) (int len, GLuint* dest);
+    using PoolDeleter = void (*) (int len, GLuint* dest);
+
+    // Names of all buffer and framebuffer targets are interchangeable, so they share
+    // a bucket. Textures get a bucket per target since glCreateTextures takes one.
+    inline int poolSlot (GLenum kind) {
+        int slot = bindSlot(kind);
+        if (slot == SLOT_NONE || slot == SLOT_PROGRAM) return SLOT_NONE;
+        if (slot <= SLOT_UNIFORM_BUFFER) return SLOT_ARRAY_BUFFER;
+        if (slot == SLOT_FRAMEBUFFER || slot == SLOT_READ_FRAMEBUFFER) return SLOT_DRAW_FRAMEBUFFER;
+        return slot;
+    }
+} // end namespace
+
+struct HandlePoolStats {
+    uint64_t acquired;     // Names handed out
+    uint64_t created;      // Names generated by OpenGL
+    uint64_t createCalls;  // glGen*/glCreate* calls
+    uint64_t released;     // Names given back
+    uint64_t destroyCalls; // glDelete* calls
+};
+
+/**
+* HandlePool pre-generates OpenGL names in chunks so that constructing a
+* GLResource pops a name off a free list instead of calling glGen* (or
+* glCreate*) for every object. Released names are collected and deleted
+* in a single glDelete* call per chunk, or when flush is called.
+*
+* Released names are never handed out again by the pool: the object behind
+* the name keeps its storage, attachments and parameters until it is deleted,
+* and immutable storage can't be respecified. Once deleted OpenGL is free to
+* return the name from a later chunk.
+*
+* Like BindCache, a pool belongs to a single context and is installed on the
+* current thread (sgl::Context does this for you when built with
+* ContextBuilder::setHandlePool). Shader stages and programs are never pooled.
+*
+* ex:
+*
+*     sgl::HandlePool pool(256);
+*     sgl::setHandlePool(&pool);
+*     std::vector<sgl::GLResource<GL_ARRAY_BUFFER>> buffers(1000); // 4 glGenBuffers calls
+*     for (auto& b : buffers) b.release();                          // 4 glDeleteBuffers calls
+*     pool.flush();
+*/
+class HandlePool {
+private:
+    struct Bucket {
+        std::vector<GLuint> available;
+        std::vector<GLuint> released;
+        detail::PoolDeleter destroy = nullptr;
+    };
+
+    Bucket _buckets[detail::SLOT_COUNT];
+    size_t _chunk;
+    HandlePoolStats _stats;
+
+    void refill (Bucket& bucket, size_t len, detail::PoolCreator creator);
+    void flush (Bucket& bucket);
+
+public:
+    HandlePool (size_t chunk = 64);
+
+    // Fill dest with len names of kind. Returns false if kind isn't pooled.
+    bool acquire (GLenum kind, size_t len, GLuint* dest, detail::PoolCreator creator, detail::PoolDeleter destroy) {
+        int slot = detail::poolSlot(kind);
+        if (slot == detail::SLOT_NONE) return false;
+
+        Bucket& bucket = _buckets[slot];
+        if (bucket.available.size() < len) {
+            bucket.destroy = destroy;
+            refill(bucket, len, creator);
+        }
+        for (size_t i = 0; i < len; i++) {
+            dest[i] = bucket.available.back();
+            bucket.available.pop_back();
+        }
+        _stats.acquired += len;
+        return true;
+    }
+
+    // Queue names of kind for deletion. Returns false if kind isn't pooled.
+    bool release (GLenum kind, size_t len, const GLuint* ids, detail::PoolDeleter destroy) {
+        int slot = detail::poolSlot(kind);
+        if (slot == detail::SLOT_NONE) return false;
+
+        Bucket& bucket = _buckets[slot];
+        bucket.destroy = destroy;
+        bucket.released.insert(bucket.released.end(), ids, ids + len);
+        _stats.released += len;
+        if (bucket.released.size() >= _chunk) flush(bucket);
+        return true;
+    }
+
+    // Delete all released names. sgl::Context calls this every swapBuffers
+    void flush ();
+
+    // Delete released and pre-generated names. The context must still be current.
+    void clear ();
+
+    size_t chunkSize () const { return _chunk; }
+    const HandlePoolStats& stats () const { return _stats; }
+};
+
+namespace detail {
+    extern thread_local HandlePool* __sglHandlePool;
+
+    inline HandlePool* currentHandlePool () {
+        return __sglHandlePool;
+    }
+} // end namespace
+
+// Install pool as the handle pool of the calling thread's current context.
+// Passing nullptr disables pooling.
+inline void setHandlePool (HandlePool* pool) {
+    detail::__sglHandlePool = pool;
+}
+
+inline HandlePool* getHandlePool () {
+    return detail::currentHandlePool();
+}
+
+} // end namespace
+
+#endif // HANDLEPOOL_H
@@ -0,0 +1,175 @@
+#ifndef INDIRECT_H
+#define INDIRECT_H
+
+#include "sglconfig.h"
+#include "resource.h"
+#include "traits.h"
+
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
+
+namespace sgl {
+
+// Layouts read by glDrawElementsIndirect and glDrawArraysIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must be tightly packed");
+static_assert(sizeof(DrawArraysIndirectCommand) == 16, "DrawArraysIndirectCommand must be tightly packed");
+
+namespace traits {
+    template <class T>
+    using IsIndirectCommand = traits::one_of<T, DrawElementsIndirectCommand, DrawArraysIndirectCommand>;
+
+    template <class T>
+    using IsElementsCommand = std::is_same<T, DrawElementsIndirectCommand>;
+} // end namespace
+
+inline DrawElementsIndirectCommand drawElementsCommand (GLuint count, GLuint firstIndex = 0, GLint baseVertex = 0, GLuint instances = 1, GLuint baseInstance = 0) {
+    return { count, instances, firstIndex, baseVertex, baseInstance };
+}
+
+inline DrawArraysIndirectCommand drawArraysCommand (GLuint count, GLuint first = 0, GLuint instances = 1, GLuint baseInstance = 0) {
+    return { count, instances, first, baseInstance };
+}
+
+template <class T>
+using IndirectBuffer = GLBufferSized<GL_DRAW_INDIRECT_BUFFER, T>;
+
+// Draw count commands of buffer, starting at command first, with vao bound.
+// Uses a single glMultiDraw*Indirect call on OpenGL 4.3 and one indirect
+// draw per command on older versions. Throws before OpenGL 4.0 / ES 3.1,
+// which have no indirect draws.
+void multiDrawElementsIndirect (GLuint vao, GLuint buffer, GLenum mode, GLenum type, size_t first, size_t count);
+void multiDrawArraysIndirect (GLuint vao, GLuint buffer, GLenum mode, size_t first, size_t count);
+
+namespace detail {
+    // Client side commands drawn one instanced draw at a time, for versions
+    // without indirect draws. baseInstance must be 0.
+    void drawCommands (GLuint vao, GLenum mode, GLenum type, const DrawElementsIndirectCommand* commands, size_t count);
+    void drawCommands (GLuint vao, GLenum mode, const DrawArraysIndirectCommand* commands, size_t count);
+} // end namespace
+
+inline void multiDrawIndirect (GLResource<GL_VERTEX_ARRAY>& vao, IndirectBuffer<DrawElementsIndirectCommand>& commands, GLenum mode, GLenum type = GL_UNSIGNED_INT) {
+    multiDrawElementsIndirect(vao, commands, mode, type, 0, commands.size());
+}
+
+inline void multiDrawIndirect (GLResource<GL_VERTEX_ARRAY>& vao, IndirectBuffer<DrawArraysIndirectCommand>& commands, GLenum mode) {
+    multiDrawArraysIndirect(vao, commands, mode, 0, commands.size());
+}
+
+/**
+* IndirectBatch collects draws sharing a vertex array and submits them with a
+* single glMultiDrawElementsIndirect (or glMultiDrawArraysIndirect) call
+* instead of one draw call each. Commands are kept client side and uploaded
+* to the indirect buffer by submit() when they have changed, so a static
+* batch is uploaded once. Without indirect draws (before OpenGL 4.0 / ES 3.1)
+* submit() draws the client side commands one at a time instead.
+*
+* ex:
+*
+*     sgl::IndirectBatch<sgl::DrawElementsIndirectCommand> batch;
+*     for (auto& mesh : arenaMeshes) batch.add(mesh.command());
+*     while (running) {
+*         shader.bind();
+*         batch.submit(arena, GL_TRIANGLES);
+*     }
+*/
+template <class T>
+class IndirectBatch {
+    static_assert(traits::IsIndirectCommand<T>::value, "IndirectBatch holds DrawElementsIndirectCommand or DrawArraysIndirectCommand");
+private:
+    std::vector<T> _commands;
+    IndirectBuffer<T> _buffer;
+    bool _dirty;
+
+    template <class C = T>
+    typename std::enable_if<traits::IsElementsCommand<C>::value>::type draw (GLuint vao, GLenum mode, GLenum type) {
+        multiDrawElementsIndirect(vao, _buffer, mode, type, 0, _commands.size());
+    }
+
+    template <class C = T>
+    typename std::enable_if<!traits::IsElementsCommand<C>::value>::type draw (GLuint vao, GLenum mode, GLenum) {
+        multiDrawArraysIndirect(vao, _buffer, mode, 0, _commands.size());
+    }
+
+    template <class C = T>
+    typename std::enable_if<traits::IsElementsCommand<C>::value>::type drawClient (GLuint vao, GLenum mode, GLenum type) {
+        detail::drawCommands(vao, mode, type, _commands.data(), _commands.size());
+    }
+
+    template <class C = T>
+    typename std::enable_if<!traits::IsElementsCommand<C>::value>::type drawClient (GLuint vao, GLenum mode, GLenum) {
+        detail::drawCommands(vao, mode, _commands.data(), _commands.size());
+    }
+
+public:
+    IndirectBatch (GLenum usage = GL_DYNAMIC_DRAW) :
+        _buffer(0, usage),
+        _dirty(false)
+    {}
+
+    // Append a draw, returning its index
+    size_t add (const T& command) {
+        _commands.push_back(command);
+        _dirty = true;
+        return _commands.size() - 1;
+    }
+
+    // Edit a queued draw. Setting instanceCount to 0 skips it.
+    T& operator[] (size_t idx) {
+        _dirty = true;
+        return _commands[idx];
+    }
+
+    const T& operator[] (size_t idx) const { return _commands[idx]; }
+
+    void clear () {
+        _commands.clear();
+        _dirty = true;
+    }
+
+    // Upload the commands if they changed since the last call
+    void upload () {
+        if (!_dirty) return;
+        if (!_commands.empty()) _buffer.update(_commands);
+        _dirty = false;
+    }
+
+    // Draw every command with vao bound. type is ignored for arrays.
+    void submit (GLResource<GL_VERTEX_ARRAY>& vao, GLenum mode, GLenum type = GL_UNSIGNED_INT) {
+        if (_commands.empty()) return;
+        if (!SGL_DRAWINDIRECT_SUPPORTED) {
+            drawClient(vao, mode, type);
+            return;
+        }
+        upload();
+        draw(vao, mode, type);
+    }
+
+    size_t size () const { return _commands.size(); }
+    bool empty () const { return _commands.empty(); }
+    IndirectBuffer<T>& buffer () { return _buffer; }
+
+    void release () {
+        _buffer.release();
+        _commands.clear();
+    }
+};
+
+} // end namespace
+
+#endif // INDIRECT_H
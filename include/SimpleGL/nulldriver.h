@@ -0,0 +1,226 @@
+#ifndef NULLDRIVER_H
+#define NULLDRIVER_H
+
+#include "sglconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sgl {
+
+// Entry points the null driver replaces: every GL function SimpleGL calls
+#define SGL_NULL_DRIVER_CALLS(X) \
+    X(glActiveTexture) X(glAttachShader) X(glBeginQuery) X(glBindBuffer) X(glBindBufferBase) \
+    X(glBindBufferRange) X(glBindFramebuffer) X(glBindRenderbuffer) X(glBindTexture) \
+    X(glBindVertexArray) X(glBindVertexBuffer) X(glBlendFunc) X(glBufferData) X(glBufferStorage) \
+    X(glBufferSubData) X(glClear) X(glClearBufferfi) X(glClearBufferfv) X(glClearBufferiv) \
+    X(glClearColor) X(glClientWaitSync) X(glCompileShader) X(glCopyBufferSubData) \
+    X(glCopyNamedBufferSubData) X(glCreateBuffers) X(glCreateFramebuffers) X(glCreateProgram) \
+    X(glCreateRenderbuffers) X(glCreateShader) X(glCreateTextures) X(glCreateVertexArrays) \
+    X(glDebugMessageCallback) X(glDebugMessageControl) X(glDeleteBuffers) X(glDeleteFramebuffers) \
+    X(glDeleteProgram) X(glDeleteQueries) X(glDeleteRenderbuffers) X(glDeleteShader) X(glDeleteSync) \
+    X(glDeleteTextures) X(glDeleteVertexArrays) X(glDisable) X(glDispatchCompute) X(glDrawArrays) \
+    X(glDrawArraysIndirect) X(glDrawArraysInstanced) X(glDrawBuffers) X(glDrawElements) \
+    X(glDrawElementsBaseVertex) X(glDrawElementsIndirect) X(glDrawElementsInstanced) \
+    X(glDrawElementsInstancedBaseVertex) X(glEnable) X(glEnableVertexArrayAttrib) \
+    X(glEnableVertexAttribArray) X(glEndQuery) X(glFenceSync) X(glFinish) X(glFlush) \
+    X(glFlushMappedBufferRange) X(glFlushMappedNamedBufferRange) X(glFramebufferRenderbuffer) \
+    X(glFramebufferTexture1D) X(glFramebufferTexture2D) X(glFramebufferTexture3D) X(glGenBuffers) \
+    X(glGenFramebuffers) X(glGenQueries) X(glGenRenderbuffers) X(glGenTextures) X(glGenVertexArrays) \
+    X(glGetBufferParameteri64v) X(glGetBufferParameteriv) X(glGetError) X(glGetInteger64v) \
+    X(glGetIntegerv) X(glGetNamedBufferParameteriv) X(glGetProgramInfoLog) X(glGetProgramiv) \
+    X(glGetQueryObjectui64v) X(glGetQueryObjectuiv) X(glGetRenderbufferParameteriv) \
+    X(glGetShaderInfoLog) X(glGetShaderiv) X(glGetString) X(glGetStringi) X(glGetTexImage) \
+    X(glGetTexParameterfv) X(glGetTexParameteriv) X(glGetTextureImage) X(glGetUniformBlockIndex) \
+    X(glGetUniformLocation) X(glInvalidateFramebuffer) X(glInvalidateNamedFramebufferData) \
+    X(glIsBuffer) X(glLinkProgram) X(glMapBuffer) X(glMapBufferRange) X(glMapNamedBuffer) \
+    X(glMapNamedBufferRange) X(glMultiDrawArraysIndirect) X(glMultiDrawElementsIndirect) \
+    X(glNamedBufferData) X(glNamedBufferStorage) X(glNamedBufferSubData) \
+    X(glNamedFramebufferDrawBuffers) X(glNamedFramebufferRenderbuffer) X(glNamedFramebufferTexture) \
+    X(glNamedFramebufferTextureLayer) X(glPixelStorei) X(glQueryCounter) X(glReadBuffer) \
+    X(glReadPixels) X(glShaderSource) \
+    X(glTexImage1D) X(glTexImage2D) X(glTexImage3D) X(glTexParameteri) X(glTexStorage1D) \
+    X(glTexStorage2D) X(glTexStorage3D) X(glTexSubImage1D) X(glTexSubImage2D) X(glTexSubImage3D) \
+    X(glTextureParameteri) X(glTextureStorage1D) X(glTextureStorage2D) X(glTextureStorage3D) \
+    X(glTextureSubImage1D) X(glTextureSubImage2D) X(glTextureSubImage3D) X(glUniform1f) \
+    X(glUniform1fv) X(glUniform1i) X(glUniform2fv) X(glUniform3fv) X(glUniform4fv) \
+    X(glUniformBlockBinding) X(glUniformMatrix2fv) X(glUniformMatrix3fv) X(glUniformMatrix4fv) \
+    X(glUnmapBuffer) X(glUnmapNamedBuffer) X(glUseProgram) X(glVertexArrayAttribBinding) \
+    X(glVertexArrayAttribFormat) X(glVertexArrayBindingDivisor) X(glVertexArrayElementBuffer) \
+    X(glVertexArrayVertexBuffer) X(glVertexAttribBinding) X(glVertexAttribDivisor) \
+    X(glVertexAttribFormat) X(glVertexAttribPointer) X(glVertexBindingDivisor) X(glViewport)
+
+#define SGL_NULL_CALL_ENUM(name) NULL_##name,
+
+enum NullCall {
+    SGL_NULL_DRIVER_CALLS(SGL_NULL_CALL_ENUM)
+    NULL_CALL_COUNT
+};
+
+#undef SGL_NULL_CALL_ENUM
+
+// An invalid state transition caught by the null driver
+struct NullDriverError {
+    NullCall call;
+    GLenum error;       // The error a real driver would raise
+    std::string message;
+};
+
+namespace detail {
+    using NullProc = void (*) ();
+
+    // Replacement entry points, see nulldriver.cc
+    struct NullStubs;
+
+    struct NullBuffer {
+        size_t size;
+        bool immutable;
+        bool mapped;
+        std::vector<char> storage; // Allocated on first map
+    };
+
+    enum NullObject {
+        NULL_OBJECT_TEXTURE = 0,
+        NULL_OBJECT_FRAMEBUFFER,
+        NULL_OBJECT_RENDERBUFFER,
+        NULL_OBJECT_VERTEX_ARRAY,
+        NULL_OBJECT_QUERY,
+        NULL_OBJECT_PROGRAM,
+        NULL_OBJECT_SHADER,
+        NULL_OBJECT_COUNT
+    };
+} // end namespace
+
+/**
+* NullDriver replaces libepoxy's GL entry points with a driver that does no
+* rendering. It hands out object names, tracks bindings, buffer sizes and
+* mappings, answers the queries SimpleGL makes, and reports invalid state
+* transitions (binding names that were never generated, uploading to an
+* unbound buffer, drawing without a program, ...) as errors. Every call is
+* counted and, when recording, logged in order.
+*
+* No context or GPU is needed, so CPU overhead of SimpleGL can be measured
+* and tested deterministically on any machine. The driver is process wide:
+* only one may be installed at a time, and it must be installed before any
+* GL call, replacing whatever context was current.
+*
+* ex:
+*
+*     sgl::NullDriver driver(4, 5);
+*     driver.install();
+*     sgl::ArrayBuffer<float> buffer(data, 64);
+*     shader.setUniform1f("Alpha", 1);   // Reported, no program is bound
+*     printf("%lu calls, %zu errors\n", driver.totalCalls(), driver.errors().size());
+*     driver.uninstall();
+*/
+class NullDriver {
+private:
+    detail::NullProc _saved[NULL_CALL_COUNT];
+    uint64_t _calls[NULL_CALL_COUNT];
+    std::vector<NullCall> _log;
+    std::vector<NullDriverError> _errors;
+    int _major;
+    int _minor;
+    bool _directStateAccess;
+    bool _installed;
+    bool _recording;
+    GLenum _error;                 // Returned by the next glGetError
+
+    GLuint _nextName;
+    std::unordered_map<GLuint, detail::NullBuffer> _buffers;
+    std::unordered_set<GLuint> _objects[detail::NULL_OBJECT_COUNT];
+    std::unordered_map<uint64_t, GLuint> _bindings; // Texture targets are keyed per unit
+    GLuint _textureUnit;
+    std::vector<std::string> _strings; // Returned by glGetString and glGetStringi
+
+    friend struct detail::NullStubs;
+
+    void call (NullCall call) {
+        _calls[call] += 1;
+        if (_recording) _log.push_back(call);
+    }
+
+    void error (NullCall call, GLenum error, const std::string& message);
+    uint64_t bindingKey (GLenum target) const;
+    GLuint genName (detail::NullObject kind);
+    GLuint genBuffer ();
+    void deleteName (detail::NullObject kind, GLuint name);
+    void deleteBuffer (GLuint name);
+    bool exists (detail::NullObject kind, GLuint name) const;
+    detail::NullBuffer* buffer (NullCall call, GLuint name);
+    detail::NullBuffer* boundBuffer (NullCall call, GLenum target);
+    void bind (NullCall call, GLenum target, detail::NullObject kind, GLuint name);
+    void bindBuffer (NullCall call, GLenum target, GLuint name);
+    void requireProgram (NullCall call);
+    void requireDraw (NullCall call);
+    GLenum popError ();
+    bool getInteger (GLenum pname, GLint64& dest) const;
+    const GLubyte* string (GLenum name);
+    const GLubyte* extension (GLuint index);
+
+public:
+    // Strict drivers throw std::runtime_error on the first invalid transition
+    bool strict;
+
+    // Report OpenGL major.minor, with or without ARB_direct_state_access
+    NullDriver (int major = SGL_OPENGL_MAX_MAJOR, int minor = SGL_OPENGL_MAX_MINOR, bool directStateAccess = true);
+
+    NullDriver (const NullDriver&) = delete;
+    NullDriver& operator= (const NullDriver&) = delete;
+
+    // Restores the replaced entry points if still installed
+    ~NullDriver ();
+
+    // Replace the GL entry points and initialize SimpleGL for the reported version
+    void install ();
+
+    // Restore the entry points replaced by install
+    void uninstall ();
+
+    bool installed () const { return _installed; }
+
+    // Keep an ordered log of every call
+    void record (bool enabled) { _recording = enabled; }
+
+    const std::vector<NullCall>& log () const { return _log; }
+
+    uint64_t calls (NullCall call) const { return _calls[call]; }
+
+    uint64_t totalCalls () const;
+
+    static const char* callName (NullCall call);
+
+    // Forget counts and the log
+    void resetCalls ();
+
+    const std::vector<NullDriverError>& errors () const { return _errors; }
+
+    void clearErrors ();
+
+    // Name bound to target, on the active texture unit for textures
+    GLuint bound (GLenum target) const;
+
+    // Objects created and not yet deleted
+    size_t liveObjects () const;
+
+    // Size of buffer's data store, 0 if it has none
+    size_t bufferSize (GLuint buffer) const;
+
+};
+
+namespace detail {
+    extern NullDriver* __sglNullDriver;
+} // end namespace
+
+// The installed null driver, nullptr if GL calls go to a real driver
+inline NullDriver* getNullDriver () {
+    return detail::__sglNullDriver;
+}
+
+} // end namespace
+
+#endif // NULLDRIVER_H
@@ -0,0 +1,239 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+#include "sglconfig.h"
+#include "resource.h"
+#include "texture.h"
+#include "allocator.h"
+#include "streambuffer.h"
+
+#include <stdexcept>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace sgl {
+
+class ReadbackQueue;
+
+namespace detail {
+    struct ReadbackSlot {
+        PackBuffer buffer;
+        size_t capacity = 0;
+        size_t size = 0;
+        GLsizei width = 0;
+        GLsizei height = 0;
+        size_t stride = 0;
+        GLsync fence = nullptr;
+        uint64_t serial = 0;
+        bool pending = false;
+        bool mapped = false;
+    };
+} // end namespace
+
+struct ReadbackStats {
+    uint64_t reads;     // Reads issued
+    uint64_t resolved;  // Reads mapped by their ticket
+    uint64_t dropped;   // Reads overwritten before they were mapped
+    uint64_t stalls;    // Times read or map had to wait on the GPU
+};
+
+/**
+* ReadbackView is a mapped, read only, typed view of a finished readback.
+* The pack buffer is unmapped and returned to the queue when the view is
+* destroyed. Rows are stride bytes apart, which is wider than width pixels
+* when GL_PACK_ALIGNMENT pads them.
+*/
+template <class T>
+class ReadbackView {
+private:
+    ReadbackQueue* _queue;
+    size_t _slot;
+    const T* _data;
+    size_t _size;
+    GLsizei _width;
+    GLsizei _height;
+    size_t _stride;
+
+public:
+    ReadbackView (ReadbackQueue* queue, size_t slot, const void* data, size_t size, GLsizei width, GLsizei height, size_t stride) :
+        _queue(queue),
+        _slot(slot),
+        _data(static_cast<const T*>(data)),
+        _size(size / sizeof(T)),
+        _width(width),
+        _height(height),
+        _stride(stride)
+    {}
+
+    ReadbackView (ReadbackView&& other) :
+        _queue(other._queue),
+        _slot(other._slot),
+        _data(other._data),
+        _size(other._size),
+        _width(other._width),
+        _height(other._height),
+        _stride(other._stride)
+    {
+        other._queue = nullptr;
+    }
+
+    ReadbackView (const ReadbackView&) = delete;
+    ReadbackView& operator= (const ReadbackView&) = delete;
+
+    ~ReadbackView () { release(); }
+
+    const T& operator[] (size_t idx) const { return _data[idx]; }
+    const T* data () const { return _data; }
+
+    // First element of row y
+    const T* row (GLsizei y) const {
+        return reinterpret_cast<const T*>(reinterpret_cast<const char*>(_data) + y * _stride);
+    }
+
+    // Elements of T in the view
+    size_t size () const { return _size; }
+    GLsizei width () const { return _width; }
+    GLsizei height () const { return _height; }
+    size_t stride () const { return _stride; }
+
+    // Unmap now instead of at destruction
+    void release ();
+};
+
+// Handle to a readback in flight
+struct ReadbackTicket {
+    ReadbackQueue* queue;
+    size_t slot;
+    uint64_t serial;
+
+    // True once the GPU has written the data. Never blocks.
+    bool ready () const;
+
+    // False once the slot has been reused by a later read
+    bool valid () const;
+
+    // Map the result, waiting for the GPU if it isn't ready
+    template <class T>
+    ReadbackView<T> map () const;
+};
+
+/**
+* ReadbackQueue reads framebuffers and textures back to the CPU without
+* stalling. Each read goes into the next pack buffer of a ring with
+* glReadPixels or glGetTexImage followed by a fence, and returns a ticket.
+* Once ticket.ready() the result can be mapped as a typed view with no wait.
+*
+* With N buffers a result can be mapped up to N - 1 reads later. If a read
+* needs a buffer whose result was never mapped, that result is dropped.
+* Mapping a ticket that isn't ready waits on its fence only, never glFinish.
+*
+* ex:
+*
+*     sgl::ReadbackQueue readback(3);
+*     std::deque<sgl::ReadbackTicket> tickets;
+*     while (running) {
+*         step(slab);
+*         tickets.push_back(readback.read(slab.ping().fbo, 0, 0, w, h, GL_RGBA, GL_FLOAT));
+*         if (tickets.front().ready()) {
+*             auto view = tickets.front().map<sgl::vec4f>();
+*             consume(view.data(), view.size());
+*             tickets.pop_front();
+*         }
+*     }
+*/
+class ReadbackQueue {
+private:
+    std::vector<detail::ReadbackSlot> _slots;
+    size_t _next;
+    uint64_t _serial;
+    ReadbackStats _stats;
+
+    friend struct ReadbackTicket;
+    template <class T> friend class ReadbackView;
+
+    detail::ReadbackSlot& acquire (size_t size);
+    ReadbackTicket submit (detail::ReadbackSlot& slot);
+    const void* mapSlot (size_t slot);
+    void unmapSlot (size_t slot);
+
+public:
+    ReadbackQueue (size_t buffers = 3);
+
+    ReadbackQueue (const ReadbackQueue&) = delete;
+    ReadbackQueue& operator= (const ReadbackQueue&) = delete;
+
+    // Read a rectangle of attachment of framebuffer. 0 reads the back buffer, or
+    // the color attachment of the framebuffer set with sgl::setDefaultFramebuffer.
+    ReadbackTicket read (GLuint framebuffer, GLint x, GLint y, GLsizei width, GLsizei height,
+                         GLenum format, GLenum type, GLenum attachment = GL_COLOR_ATTACHMENT0);
+
+    template <GLenum kind>
+    ReadbackTicket read (GLResource<kind>& framebuffer, GLint x, GLint y, GLsizei width, GLsizei height,
+                         GLenum format, GLenum type, GLenum attachment = GL_COLOR_ATTACHMENT0) {
+        static_assert(traits::IsFramebuffer<kind>::value, "Must supply framebuffer");
+        return read(static_cast<GLuint>(framebuffer), x, y, width, height, format, type, attachment);
+    }
+
+    // Read a whole level of a 2D texture. Not available on GLES.
+    template <GLenum kind>
+    ReadbackTicket readTexture (Texture<kind>& texture, GLenum format, GLenum type, GLint level = 0);
+
+    // Number of reads whose tickets haven't been mapped or dropped
+    size_t pending () const;
+
+    const ReadbackStats& stats () const { return _stats; }
+
+    void release ();
+};
+
+template <class T>
+void ReadbackView<T>::release () {
+    if (_queue == nullptr) return;
+    _queue->unmapSlot(_slot);
+    _queue = nullptr;
+    _data = nullptr;
+}
+
+template <class T>
+ReadbackView<T> ReadbackTicket::map () const {
+    if (!valid()) throw std::runtime_error("ReadbackTicket: result was dropped");
+    const void* data = queue->mapSlot(slot);
+    const detail::ReadbackSlot& s = queue->_slots[slot];
+    return ReadbackView<T>(queue, slot, data, s.size, s.width, s.height, s.stride);
+}
+
+template <GLenum kind>
+ReadbackTicket ReadbackQueue::readTexture (Texture<kind>& texture, GLenum format, GLenum type, GLint level) {
+    static_assert(traits::IsTex2D<kind>::value, "Must supply 2D texture");
+#ifdef SGL_USE_GLES
+    throw std::runtime_error("ReadbackQueue: texture readback needs desktop OpenGL");
+#else
+    GLsizei width = std::max(1, texture.attrs.width >> level);
+    GLsizei height = std::max(1, texture.attrs.height >> level);
+
+    GLint align = 4;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &align);
+    size_t stride = detail::alignUp(width * traits::formatSize(traits::sizedFormat(format, type)), align);
+    size_t size = stride * height;
+
+    detail::ReadbackSlot& slot = acquire(size);
+    slot.width = width;
+    slot.height = height;
+    slot.stride = stride;
+    sgl::bind<GL_PIXEL_PACK_BUFFER>(slot.buffer);
+    if (SGL_DSA_SUPPORTED && traits::IsDSATexture<kind>::value) {
+        glGetTextureImage(texture, level, format, type, size, 0);
+    } else {
+        auto bg = sgl::bind_guard(texture);
+        glGetTexImage(kind, level, format, type, 0);
+    }
+    sgl::bind<GL_PIXEL_PACK_BUFFER>(0);
+    return submit(slot);
+#endif
+}
+
+} // end namespace
+
+#endif // READBACK_H
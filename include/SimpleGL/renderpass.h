@@ -0,0 +1,108 @@
+#ifndef RENDERPASS_H
+#define RENDERPASS_H
+
+#include "sglconfig.h"
+#include "resource.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Compile Time configuration flags:
+* SGL_MAX_PASS_COLORS - Color attachments a single RenderPass can describe
+*/
+#ifndef SGL_MAX_PASS_COLORS
+#   define SGL_MAX_PASS_COLORS 8
+#endif
+
+namespace sgl {
+
+// What happens to an attachment's contents when a pass begins
+enum LoadAction {
+    LOAD_PRESERVE,  // Keep the previous contents
+    LOAD_CLEAR,     // Clear to the attachment's clear value
+    LOAD_DISCARD    // Previous contents are undefined, every texel will be written
+};
+
+// What happens to an attachment's contents when a pass ends
+enum StoreAction {
+    STORE_PRESERVE, // Keep the rendered contents
+    STORE_DISCARD   // Contents are no longer needed, eg. a depth buffer only used for testing
+};
+
+namespace detail {
+    struct PassAttachment {
+        bool used;
+        LoadAction load;
+        StoreAction store;
+        GLfloat clear[4];
+    };
+} // end namespace
+
+/**
+* RenderPass describes the attachments a pass draws to and the load and
+* store intent of each. begin() binds the framebuffer, selects its color
+* attachments as draw buffers, clears LOAD_CLEAR attachments and invalidates
+* LOAD_DISCARD ones. end() invalidates STORE_DISCARD attachments, so tiled
+* and bandwidth bound GPUs skip loading and storing contents nobody reads.
+*
+* Clears go through glClearBuffer, so they respect the color, depth and
+* stencil write masks and the scissor box like glClear does.
+*
+* ex:
+*
+*     // One pass writes velocity and density, the depth buffer is scratch
+*     fbo.attachColorTextures(velocity, density);
+*     fbo.attachTexture(depth, GL_DEPTH_ATTACHMENT);
+*
+*     sgl::RenderPass pass(fbo);
+*     pass.color(0, sgl::LOAD_DISCARD)
+*         .clearColor(1, 0, 0, 0, 1)
+*         .depth(sgl::LOAD_CLEAR, sgl::STORE_DISCARD);
+*
+*     pass.begin();
+*     glDrawElements(...);
+*     pass.end();
+*/
+class RenderPass {
+private:
+    GLuint _framebuffer;
+    detail::PassAttachment _colors[SGL_MAX_PASS_COLORS];
+    GLuint _colorCount;
+    detail::PassAttachment _depth;
+    detail::PassAttachment _stencil;
+    GLfloat _clearDepth;
+    GLint _clearStencil;
+
+    GLenum colorAttachment (GLuint idx) const;
+    GLenum depthAttachment () const;
+    GLenum stencilAttachment () const;
+    void invalidate (bool atStart);
+
+public:
+    // Pass drawing to framebuffer, 0 being the default framebuffer (see sgl::setDefaultFramebuffer)
+    RenderPass (GLuint framebuffer = 0);
+
+    RenderPass (GLResource<GL_FRAMEBUFFER>& framebuffer) :
+        RenderPass(static_cast<GLuint>(framebuffer))
+    {}
+
+    // Draw to color attachment idx. Color attachments not described aren't drawn to.
+    RenderPass& color (GLuint idx, LoadAction load = LOAD_PRESERVE, StoreAction store = STORE_PRESERVE);
+
+    // Draw to color attachment idx, clearing it to (r, g, b, a) first
+    RenderPass& clearColor (GLuint idx, GLfloat r, GLfloat g, GLfloat b, GLfloat a, StoreAction store = STORE_PRESERVE);
+
+    RenderPass& depth (LoadAction load, StoreAction store = STORE_PRESERVE, GLfloat clear = 1.0f);
+    RenderPass& stencil (LoadAction load, StoreAction store = STORE_PRESERVE, GLint clear = 0);
+
+    // Bind the framebuffer, select draw buffers and apply load actions
+    void begin ();
+
+    // Apply store actions. The framebuffer is left bound.
+    void end ();
+};
+
+} // end namespace
+
+#endif // RENDERPASS_H
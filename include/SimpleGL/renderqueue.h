@@ -0,0 +1,175 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "sglconfig.h"
+#include "resource.h"
+#include "shader.h"
+#include "uniformarena.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/**
+* Compile Time configuration flags:
+* SGL_RENDERQUEUE_TEXTURES - Textures a single DrawItem can bind, to units 0..N-1
+*/
+#ifndef SGL_RENDERQUEUE_TEXTURES
+#   define SGL_RENDERQUEUE_TEXTURES 4
+#endif
+
+namespace sgl {
+
+namespace detail {
+    struct TextureSet {
+        GLenum targets[SGL_RENDERQUEUE_TEXTURES];
+        GLuint names[SGL_RENDERQUEUE_TEXTURES];
+
+        bool operator< (const TextureSet& other) const {
+            return memcmp(this, &other, sizeof(TextureSet)) < 0;
+        }
+    };
+
+    // Sort key layout, most significant first
+    const int KEY_LAYER_SHIFT    = 56; // 8 bits
+    const int KEY_PROGRAM_SHIFT  = 40; // 16 bits
+    const int KEY_TEXTURES_SHIFT = 24; // 16 bits
+    const int KEY_VAO_SHIFT      = 8;  // 16 bits
+    const int KEY_DEPTH_SHIFT    = 0;  // 8 bits
+} // end namespace
+
+/**
+* A single draw and the state it needs. Sampler uniforms are expected to be
+* set once per program (texture i is bound to unit i); per draw values go in
+* a uniform buffer range, typically a UniformArena slot.
+*/
+struct DrawItem {
+    GLuint program;
+    GLuint vao;
+    detail::TextureSet textures;
+    GLuint textureCount;
+
+    GLuint ubo;
+    GLuint uboUnit;
+    size_t uboOffset;
+    size_t uboSize;
+
+    GLenum mode;
+    GLenum indexType; // GL_NONE draws arrays
+    GLsizei count;
+    GLint first;       // First vertex for arrays
+    size_t offset;     // Byte offset into the element buffer
+    GLint baseVertex;
+    GLsizei instances;
+
+    uint8_t layer;     // Layers are drawn in order regardless of state
+    uint8_t depth;     // Tie breaker between items sharing all state
+
+    template <GLenum kind>
+    DrawItem& texture (GLuint unit, GLResource<kind>& tex) {
+        static_assert(traits::IsTexture<kind>::value, "Must supply texture target");
+        return texture(unit, kind, static_cast<GLuint>(tex));
+    }
+
+    DrawItem& texture (GLuint unit, GLenum target, GLuint name);
+
+    DrawItem& uniformBlock (GLResource<GL_UNIFORM_BUFFER>& buffer, GLuint unit, size_t offset = 0, size_t size = 0);
+    DrawItem& uniformBlock (UniformArena& arena, const UniformSlot& slot, GLuint unit);
+
+    DrawItem& elements (GLenum mode, GLsizei count, GLenum type = GL_UNSIGNED_INT, size_t offset = 0, GLint baseVertex = 0);
+    DrawItem& arrays (GLenum mode, GLint first, GLsizei count);
+    DrawItem& instanced (GLsizei instances);
+    DrawItem& sortLayer (uint8_t layer);
+
+    // depth in [0, 1], quantized to 8 bits
+    DrawItem& sortDepth (float depth);
+};
+
+struct RenderQueueStats {
+    uint64_t draws;
+    uint64_t programChanges;  // Issued after sorting
+    uint64_t vaoChanges;
+    uint64_t textureChanges;
+    uint64_t bufferChanges;
+    uint64_t programSaved;    // Changes submission order would have needed on top of those
+    uint64_t vaoSaved;
+    uint64_t textureSaved;
+    uint64_t bufferSaved;
+};
+
+/**
+* RenderQueue collects draws in whatever order the application produces them
+* and submits them ordered by state. Each item gets a 64 bit key packing, from
+* most to least significant, its layer, program, texture set, vertex array
+* and depth. Programs, vertex arrays and texture sets are given small dense
+* ids the first time the queue sees them, so equal state sorts together.
+* Keys are radix sorted every flush, skipping byte passes that can't change
+* the order.
+*
+* flush() binds only what changed between consecutive items and records how
+* many program, vertex array, texture and uniform buffer changes the sorted
+* order saved over submission order. Items and sort buffers are kept between
+* frames, so a steady state frame doesn't allocate.
+*
+* ex:
+*
+*     sgl::RenderQueue queue;
+*     for (auto& object : scene) {
+*         queue.add(object.shader, object.vao)
+*             .texture(0, object.albedo)
+*             .uniformBlock(arena, object.uniforms, 0)
+*             .elements(GL_TRIANGLES, object.indexCount);
+*     }
+*     arena.upload();
+*     queue.flush();
+*     printf("program changes saved: %lu\n", queue.stats().programSaved);
+*/
+class RenderQueue {
+private:
+    std::vector<DrawItem> _items;
+    std::vector<uint64_t> _keys;
+    std::vector<uint32_t> _order;
+    std::vector<uint64_t> _keysTmp;
+    std::vector<uint32_t> _orderTmp;
+
+    std::unordered_map<GLuint, uint16_t> _programs;
+    std::unordered_map<GLuint, uint16_t> _vaos;
+    std::map<detail::TextureSet, uint16_t> _textureSets;
+
+    RenderQueueStats _stats;
+
+    uint64_t key (const DrawItem& item);
+    void sort ();
+
+public:
+    RenderQueue ();
+
+    // Queue a draw with program and vao. The returned reference is valid until the next add.
+    DrawItem& add (GLuint program, GLuint vao);
+
+    DrawItem& add (Shader& shader, GLResource<GL_VERTEX_ARRAY>& vao) {
+        return add(static_cast<GLuint>(shader), static_cast<GLuint>(vao));
+    }
+
+    // Sort and submit every queued item, then empty the queue
+    void flush ();
+
+    // Empty the queue without drawing
+    void clear ();
+
+    // Forget the dense ids handed out so far. Call when many programs or
+    // textures have been destroyed.
+    void resetIds ();
+
+    size_t size () const { return _items.size(); }
+
+    // Statistics of the last flush
+    const RenderQueueStats& stats () const { return _stats; }
+};
+
+} // end namespace
+
+#endif // RENDERQUEUE_H
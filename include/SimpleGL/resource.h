@@ -5,12 +5,20 @@
 #include "utils.h"
 #include "traits.h"
 #include "resourceinfo.h"
+#include "bindcache.h"
+#include "handlepool.h"
+#include "deletionqueue.h"
+#include "trace.h"
+#include "vertexlayout.h"
 
 #include <stdint.h>
 #include <set>
 #include <map>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
 
 namespace sgl {
 
@@ -42,84 +50,181 @@ namespace detail {
 
     template <GLenum kind>
     struct GLInterface<kind, traits::IfBuffer<kind>> {
-        static void create (int len, GLuint* dest) {  glGenBuffers(len,dest); sglDbgLogCreation(kind,len,dest);  }
-        static void destroy (int len, GLuint* dest) { glDeleteBuffers(len,dest); sglDbgLogDeletion(kind,len,dest);  }
-        static void bind (GLuint id) { glBindBuffer(kind,id); sglDbgLogBind(kind,id); }
+        static void create (int len, GLuint* dest) {
+            if (SGL_DSA_SUPPORTED) glCreateBuffers(len,dest);
+            else glGenBuffers(len,dest);
+            sglCountCreation(len); sglDbgLogCreation(kind,len,dest);
+        }
+        static void destroy (int len, GLuint* dest) { glDeleteBuffers(len,dest); sglCountDeletion(len); sglDbgLogDeletion(kind,len,dest);  }
+        static void bind (GLuint id) { glBindBuffer(kind,id); sglCountBind(kind); sglDbgLogBind(kind,id); }
     };
 
     template <GLenum kind>
     struct GLInterface<kind, traits::IfFramebuffer<kind>> {
-        static void create (int len, GLuint* dest) { glGenFramebuffers(len,dest); sglDbgLogCreation(kind,len,dest);}
-        static void destroy (int len, GLuint* dest) { glDeleteFramebuffers(len,dest); sglDbgLogDeletion(kind,len,dest);}
-        static void bind (GLuint id) { glBindFramebuffer(kind,id); sglDbgLogBind(kind,id);}
+        static void create (int len, GLuint* dest) {
+            if (SGL_DSA_SUPPORTED) glCreateFramebuffers(len,dest);
+            else glGenFramebuffers(len,dest);
+            sglCountCreation(len); sglDbgLogCreation(kind,len,dest);
+        }
+        static void destroy (int len, GLuint* dest) { glDeleteFramebuffers(len,dest); sglCountDeletion(len); sglDbgLogDeletion(kind,len,dest);}
+        static void bind (GLuint id) { glBindFramebuffer(kind,detail::framebufferName(id)); sglCountBind(kind); sglDbgLogBind(kind,id);}
     };
 
     template <GLenum kind>
     struct GLInterface<kind, traits::IfTexture<kind>> {
-        static void create (int len, GLuint* dest) { glGenTextures(len,dest); sglDbgLogCreation(kind,len,dest);}
-        static void destroy (int len, GLuint* dest) { glDeleteTextures(len,dest); sglDbgLogDeletion(kind,len,dest);}
-        static void bind (GLuint id) { glBindTexture(kind,id); sglDbgLogBind(kind,id);}
+        static void create (int len, GLuint* dest) {
+            if (SGL_DSA_SUPPORTED && traits::IsDSATexture<kind>::value) glCreateTextures(kind,len,dest);
+            else glGenTextures(len,dest);
+            sglCountCreation(len); sglDbgLogCreation(kind,len,dest);
+        }
+        static void destroy (int len, GLuint* dest) { glDeleteTextures(len,dest); sglCountDeletion(len); sglDbgLogDeletion(kind,len,dest);}
+        static void bind (GLuint id) { glBindTexture(kind,id); sglCountBind(kind); sglDbgLogBind(kind,id);}
     };
 
     template <GLenum kind>
     struct GLInterface<kind, traits::IfVertexArray<kind>> {
-        static void create (int len, GLuint* dest) { glGenVertexArrays(len,dest); sglDbgLogCreation(kind,len,dest);}
-        static void destroy (int len, GLuint* dest) { glDeleteVertexArrays(len,dest); sglDbgLogDeletion(kind,len,dest);}
-        static void bind (GLuint id) { glBindVertexArray(id); sglDbgLogBind(kind,id);}
+        static void create (int len, GLuint* dest) {
+            if (SGL_DSA_SUPPORTED) glCreateVertexArrays(len,dest);
+            else glGenVertexArrays(len,dest);
+            sglCountCreation(len); sglDbgLogCreation(kind,len,dest);
+        }
+        static void destroy (int len, GLuint* dest) {
+            detail::forgetVertexLayouts(len,dest);
+            glDeleteVertexArrays(len,dest);
+            sglCountDeletion(len); sglDbgLogDeletion(kind,len,dest);
+        }
+        static void bind (GLuint id) { glBindVertexArray(id); sglCountBind(kind); sglDbgLogBind(kind,id);}
     };
 
     template <GLenum kind>
     struct GLInterface<kind, traits::IfShaderStage<kind>> {
-        static void create (int len, GLuint* dest) { *dest = glCreateShader(kind); sglDbgLogCreation(kind,len,dest);}
-        static void destroy (int len, GLuint* dest) { glDeleteShader(*dest); sglDbgLogDeletion(kind,len,dest);}
+        static void create (int len, GLuint* dest) { *dest = glCreateShader(kind); sglCountCreation(len); sglDbgLogCreation(kind,len,dest);}
+        static void destroy (int len, GLuint* dest) { glDeleteShader(*dest); sglCountDeletion(len); sglDbgLogDeletion(kind,len,dest);}
         static void bind (GLuint id) {}
     };
 
     template <GLenum kind>
     struct GLInterface<kind, traits::IfShaderProgram<kind>> {
-        static void create (int len, GLuint* dest) { __glCreateProgram(len,dest); sglDbgLogCreation(kind,len,dest);}
-        static void destroy (int len, GLuint* dest) { __glDeleteProgram(len,dest); sglDbgLogDeletion(kind,len,dest);}
-        static void bind (GLuint id) { __glUseProgram(kind,id); sglDbgLogBind(kind,id);}
+        static void create (int len, GLuint* dest) { __glCreateProgram(len,dest); sglCountCreation(len); sglDbgLogCreation(kind,len,dest);}
+        static void destroy (int len, GLuint* dest) { __glDeleteProgram(len,dest); sglCountDeletion(len); sglDbgLogDeletion(kind,len,dest);}
+        static void bind (GLuint id) { __glUseProgram(kind,id); sglCountBind(kind); sglDbgLogBind(kind,id);}
     };
 
     template <>
     struct GLInterface<GL_RENDERBUFFER, GLenum>{
-        static void create (int len, GLuint* dest) { glGenRenderbuffers(len,dest); sglDbgLogCreation(GL_RENDERBUFFER,len,dest); }
-        static void destroy (int len, GLuint* dest) { glDeleteRenderbuffers(len,dest); sglDbgLogDeletion(GL_RENDERBUFFER,len,dest); }
-        static void bind (GLuint id) { glBindRenderbuffer(GL_RENDERBUFFER,id); sglDbgLogBind(GL_RENDERBUFFER,id); }
+        static void create (int len, GLuint* dest) {
+            if (SGL_DSA_SUPPORTED) glCreateRenderbuffers(len,dest);
+            else glGenRenderbuffers(len,dest);
+            sglCountCreation(len); sglDbgLogCreation(GL_RENDERBUFFER,len,dest);
+        }
+        static void destroy (int len, GLuint* dest) { glDeleteRenderbuffers(len,dest); sglCountDeletion(len); sglDbgLogDeletion(GL_RENDERBUFFER,len,dest); }
+        static void bind (GLuint id) { glBindRenderbuffer(GL_RENDERBUFFER,id); sglCountBind(GL_RENDERBUFFER); sglDbgLogBind(GL_RENDERBUFFER,id); }
     };
 
+} // end namespace
+
+// Bind res to kind. When a BindCache is installed on the current thread
+// redundant binds are skipped. See bindcache.h
+template <GLenum kind>
+inline void bind (GLuint res) {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr && cache->elide(kind, res)) return;
+    detail::GLInterface<kind>::bind(res);
+}
+
+// Create and destroy go through the current thread's HandlePool when one is
+// installed. See handlepool.h. With a DeletionQueue installed destroy is
+// deferred until the GPU is done with the current frame. See deletionqueue.h
+template <GLenum kind>
+inline void create (size_t len, GLuint * dest) {
+    HandlePool* pool = detail::currentHandlePool();
+    if (pool != nullptr && pool->acquire(kind, len, dest, detail::GLInterface<kind>::create, detail::GLInterface<kind>::destroy)) return;
+    detail::GLInterface<kind>::create(len,dest);
+}
+
+template <GLenum kind>
+inline GLuint create () {
+    GLuint dest;
+    sgl::create<kind>(1,&dest);
+    return dest;
+}
+
+template <GLenum kind>
+inline void destroy (size_t len, GLuint* dest) {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr) cache->forget(kind,len,dest);
+    DeletionQueue* queue = detail::currentDeletionQueue();
+    if (queue != nullptr && queue->enqueue(kind, len, dest)) return;
+    HandlePool* pool = detail::currentHandlePool();
+    if (pool != nullptr && pool->release(kind, len, dest, detail::GLInterface<kind>::destroy)) return;
+    detail::GLInterface<kind>::destroy(len,dest);
+}
 
+template <GLenum kind>
+inline void destroy (GLuint res) {
+    sgl::destroy<kind>(1,&res);
+}
 
+namespace detail {
 
     //static GLbitfield SGL_RW = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
     using UsageType = GLbitfield;
 
+    // When direct state access is available buffers are edited by name and
+    // nothing is bound. Otherwise res is bound to kind first.
     template <GLenum kind, class T = GLenum>
     struct GLBufferInterface;
 
     template <GLenum kind>
     struct GLBufferInterface<kind, traits::IfBuffer<kind>> {
         static void initialize (GLuint res, const char * data, size_t len, UsageType usage) {
-            if (SGL_BUFFERSTORAGE_SUPPORTED) {
+            sglTraceScopeArg("buffer", "bufferStorage", "bytes", len);
+            if (SGL_DSA_SUPPORTED) {
+                if (SGL_BUFFERSTORAGE_SUPPORTED) {
+                    glNamedBufferStorage(res, len, data, usage);
+                    sglDbgLogVerbose("%d:%d -> glNamedBufferStorage(%d,%lu,%p,%d)\n", kind, res, res, len, data, usage);
+                } else {
+                    glNamedBufferData(res, len, data, usage);
+                    sglDbgLogVerbose("%d:%d -> glNamedBufferData(%d,%lu,%p,%d)\n", kind, res, res, len, data, usage);
+                }
+            } else if (SGL_BUFFERSTORAGE_SUPPORTED) {
+                sgl::bind<kind>(res);
                 glBufferStorage(kind, len, data, usage);
                 sglDbgLogVerbose("%d:%d -> glBufferStorage(%d,%lu,%p,%d)\n", kind, res, kind, len, data, usage);
             } else {
+                sgl::bind<kind>(res);
                 glBufferData(kind,len,data,usage);
                 sglDbgLogVerbose("%d:%d -> glBufferData(%d,%lu,%p,%d) %d\n", kind, res, kind, len, data, usage, usage==GL_DYNAMIC_DRAW);
             }
+            if (data != nullptr) sglCountBufferUpload(len);
             sglDbgCatchGLError();
         }
 
         static void initializeMut (GLuint res, const char * data, size_t len, GLenum usage) {
-            glBufferData(kind,len,data,usage);
-            sglDbgLogVerbose("%d:%d -> glBufferData(%d,%lu,%p,%d);\n", kind, res, kind, len, data, usage);
+            sglTraceScopeArg("buffer", "bufferData", "bytes", len);
+            if (SGL_DSA_SUPPORTED) {
+                glNamedBufferData(res,len,data,usage);
+                sglDbgLogVerbose("%d:%d -> glNamedBufferData(%d,%lu,%p,%d);\n", kind, res, res, len, data, usage);
+            } else {
+                sgl::bind<kind>(res);
+                glBufferData(kind,len,data,usage);
+                sglDbgLogVerbose("%d:%d -> glBufferData(%d,%lu,%p,%d);\n", kind, res, kind, len, data, usage);
+            }
+            if (data != nullptr) sglCountBufferUpload(len);
             sglDbgCatchGLError();
         }
 
         static void update (GLuint res, const char * data, size_t start, size_t len) {
-            glBufferSubData(kind,start,len,data);
-            sglDbgLogVerbose("%d:%d -> glBufferSubData(%d,%lu,%lu,%p);\n", kind, res, kind, len, start, data);
+            sglTraceScopeArg("buffer", "bufferSubData", "bytes", len);
+            if (SGL_DSA_SUPPORTED) {
+                glNamedBufferSubData(res,start,len,data);
+                sglDbgLogVerbose("%d:%d -> glNamedBufferSubData(%d,%lu,%lu,%p);\n", kind, res, res, start, len, data);
+            } else {
+                sgl::bind<kind>(res);
+                glBufferSubData(kind,start,len,data);
+                sglDbgLogVerbose("%d:%d -> glBufferSubData(%d,%lu,%lu,%p);\n", kind, res, kind, start, len, data);
+            }
+            sglCountBufferUpload(len);
             sglDbgCatchGLError();
         }
     };
@@ -129,33 +234,6 @@ namespace detail {
     };
 } // end namespace
 
-template <GLenum kind>
-inline void bind (GLuint res) {
-    detail::GLInterface<kind>::bind(res);
-}
-
-template <GLenum kind>
-inline GLuint create () {
-    GLuint dest;
-    detail::GLInterface<kind>::create(1,&dest);
-    return dest;
-}
-
-template <GLenum kind>
-inline void create (size_t len, GLuint * dest) {
-    detail::GLInterface<kind>::create(len,dest);
-}
-
-template <GLenum kind>
-inline void destroy (GLuint res) {
-    detail::GLInterface<kind>::destroy(1,&res);
-}
-
-template <GLenum kind>
-inline void destroy (size_t len, GLuint* dest) {
-    detail::GLInterface<kind>::destroy(len,dest);
-}
-
 /**
  * Core abstraction for SimpleGL. This class is a zero overhead mechanism for
  * managing all OpenGL entities. In this class' constructor it generates
@@ -257,13 +335,14 @@ public:
 
 /**
 * GLResourceArray provides a mechanism for allocating a number of resources in a single opengl call.
-*
+* When it allocates the id array itself, release frees it. Wrapped arrays are left to the caller.
 */
 
 template <GLenum kind>
 class GLResourceArray {
 protected:
     GLuint * ids;
+    bool ownsIds;
 
 public:
     size_t size;
@@ -271,10 +350,12 @@ public:
 
     GLResourceArray (GLuint * ids, size_t size) :
         ids(ids),
+        ownsIds(false),
         size(size)
     {}
 
     GLResourceArray (size_t size) :
+        ownsIds(true),
         size(size)
     {
         ids = new GLuint[size];
@@ -296,7 +377,7 @@ public:
     void release () {
         if (ids == nullptr) return;
         sgl::destroy<kind>(size,ids);
-        //delete ids; // TODO: Because the user can wrap their own ptr, this might not be a good idea...
+        if (ownsIds) delete[] ids;
         ids = nullptr;
     }
 };
@@ -405,14 +486,9 @@ ResourceGuard<kind> resource_guard (GLResource<kind>& res) { return {res}; }
 template <GLenum kind>
 ResourceGuard<kind> resource_guard (GLResource<kind>&& res) { return {res}; }
 
-// TODO: decide whether to keep track of buffer size. This could help
-// make code cleaner and mode concise, as well as potentially allowing
-// for some optimizations. For example, if we knew the size we could
-// choose between glBufferData and glBufferSubData depending on
-// the size of the input array. The drawback however is that
-// we'll be adding between 4 and 8 bytes more per buffer. Statically
-// declaring the buffer size isn't much of a solution either as it
-// will make the API needlessly clunky.
+// GLBuffer and GLBufferMut don't keep track of their size, so they stay
+// the size of a GLuint. Use GLBufferSized when the extra bookkeeping buys
+// cheaper updates.
 template <GLenum kind, class T>
 class GLBuffer : public GLResource<kind> {
 public:
@@ -427,7 +503,6 @@ public:
     GLBuffer (const std::vector<T>& data, detail::UsageType flags = SGL_RW) :
         GLResource<kind>()
     {
-        this->bind();
         detail::GLBufferInterface<kind>::initialize(this->_id, reinterpret_cast<const char*>(&data[0]), sizeof(T) * data.size(), flags);
     }
 
@@ -435,19 +510,16 @@ public:
     GLBuffer (const std::array<T,len>& data, detail::UsageType flags = SGL_RW) :
         GLResource<kind>()
     {
-        this->bind();
         detail::GLBufferInterface<kind>::initialize(this->_id, reinterpret_cast<const char*>(&data[0]), sizeof(T) * len, flags);
     }
 
     GLBuffer (const T* data, size_t len, detail::UsageType flags = SGL_RW) :
         GLResource<kind>()
     {
-        this->bind();
         detail::GLBufferInterface<kind>::initialize(this->_id, reinterpret_cast<const char*>(data), sizeof(T) * len, flags);
     }
 
     void reserve (size_t count, detail::UsageType flags = SGL_RW) {
-        this->bind();
         detail::GLBufferInterface<kind>::initialize(this->_id, NULL, sizeof(T) * count, flags);
     }
 };
@@ -466,7 +538,6 @@ public:
     GLBufferMut (const std::vector<T>& data, GLenum usage = GL_READ_WRITE) :
         GLResource<kind>()
     {
-        this->bind();
         detail::GLBufferInterface<kind>::initializeMut(this->_id, reinterpret_cast<const char*>(&data[0]), sizeof(T) * data.size(), usage);
     }
 
@@ -474,28 +545,230 @@ public:
     GLBufferMut (const std::array<T,len>& data, GLenum usage = GL_READ_WRITE) :
         GLResource<kind>()
     {
-        this->bind();
         detail::GLBufferInterface<kind>::initializeMut(this->_id, reinterpret_cast<const char*>(&data[0]), sizeof(T) * len, usage);
     }
 
     GLBufferMut (const T* data, size_t len, GLenum usage = GL_READ_WRITE) :
         GLResource<kind>()
     {
-        this->bind();
         detail::GLBufferInterface<kind>::initializeMut(this->_id, reinterpret_cast<const char*>(data), sizeof(T) * len, usage);
     }
 
     void reserve (size_t count, GLenum usage = GL_READ_WRITE) {
-        this->bind();
         detail::GLBufferInterface<kind>::initializeMut(this->_id, NULL, sizeof(T) * count, usage);
     }
 
     void resize (size_t count, GLenum usage = GL_READ_WRITE) {
-        this->bind();
         detail::GLBufferInterface<kind>::initializeMut(this->_id, NULL, sizeof(T) * count, usage);
     }
 };
 
+// How GLBufferSized::update wrote its data
+enum BufferUpdate {
+    BUFFER_SUBDATA, // In place with glBufferSubData
+    BUFFER_ORPHAN,  // Storage orphaned with glBufferData(NULL) then written
+    BUFFER_GROW     // Storage reallocated to a larger capacity
+};
+
+struct BufferUpdateStats {
+    uint64_t subdata;
+    uint64_t orphans;
+    uint64_t grows;
+    uint64_t bytes;   // Bytes uploaded
+};
+
+/**
+* GLBufferSized is a mutable buffer that keeps track of its capacity, the
+* number of elements in use and its usage hint, and uses them to choose
+* the cheapest way to upload data:
+*
+*   - Data that fits and only replaces part of the contents is written in
+*     place with glBufferSubData.
+*   - Data that replaces the whole contents of a DYNAMIC or STREAM buffer
+*     orphans the storage first, so the driver can hand out fresh memory
+*     instead of waiting on draws still reading the old contents.
+*   - Data larger than the capacity grows the storage geometrically, so a
+*     buffer that is appended to every frame reallocates O(log n) times.
+*
+* Sub-ranges can also be marked dirty as a client side copy changes and
+* uploaded with a single call covering every dirty element.
+*
+* ex:
+*
+*     sgl::ArrayBufferSized<sgl::vec3f> verts;
+*     verts.update(positions);                 // BUFFER_GROW, first upload
+*     verts.update(positions);                 // BUFFER_ORPHAN, same size
+*     verts.update(&positions[10], 10, 5);     // BUFFER_SUBDATA, elements [10,15)
+*
+*     verts.markDirty(3, 1);
+*     verts.markDirty(40, 2);
+*     verts.flush(&positions[0]);              // Uploads elements [3,42) once
+*/
+template <GLenum kind, class T>
+class GLBufferSized : public GLResource<kind> {
+private:
+    size_t _size;
+    size_t _capacity;
+    GLenum _usage;
+    size_t _dirtyStart;
+    size_t _dirtyEnd;
+    BufferUpdateStats _stats;
+
+    bool orphanable () const {
+        return _usage != GL_STATIC_DRAW && _usage != GL_STATIC_READ && _usage != GL_STATIC_COPY;
+    }
+
+    void allocate (const T* data, size_t count) {
+        detail::GLBufferInterface<kind>::initializeMut(this->_id, reinterpret_cast<const char*>(data), sizeof(T) * count, _usage);
+        _capacity = count;
+    }
+
+    void write (const T* data, size_t start, size_t len) {
+        detail::GLBufferInterface<kind>::update(this->_id, reinterpret_cast<const char*>(data), sizeof(T) * start, sizeof(T) * len);
+        _stats.bytes += sizeof(T) * len;
+    }
+
+public:
+    using value_type = T;
+
+    // Wraps an existing buffer. Its capacity is unknown, so the first
+    // update reallocates.
+    GLBufferSized (GLuint res) :
+        GLResource<kind>(res),
+        _size(0),
+        _capacity(0),
+        _usage(GL_DYNAMIC_DRAW),
+        _dirtyStart(0),
+        _dirtyEnd(0),
+        _stats{0,0,0,0}
+    {}
+
+    GLBufferSized () :
+        GLResource<kind>(),
+        _size(0),
+        _capacity(0),
+        _usage(GL_DYNAMIC_DRAW),
+        _dirtyStart(0),
+        _dirtyEnd(0),
+        _stats{0,0,0,0}
+    {}
+
+    // Empty buffer with storage for count elements
+    GLBufferSized (size_t count, GLenum usage) :
+        GLBufferSized()
+    {
+        _usage = usage;
+        reserve(count);
+    }
+
+    GLBufferSized (const std::vector<T>& data, GLenum usage = GL_DYNAMIC_DRAW) :
+        GLBufferSized()
+    {
+        _usage = usage;
+        update(data);
+    }
+
+    GLBufferSized (const T* data, size_t len, GLenum usage = GL_DYNAMIC_DRAW) :
+        GLBufferSized()
+    {
+        _usage = usage;
+        update(data, len);
+    }
+
+    // Replace the contents of the buffer with len elements of data
+    BufferUpdate update (const T* data, size_t len) {
+        BufferUpdate result;
+        if (len > _capacity) {
+            size_t capacity = std::max(len, _capacity * 2);
+            if (capacity == len) {
+                allocate(data, len);
+                _stats.bytes += sizeof(T) * len;
+            } else {
+                allocate(NULL, capacity);
+                write(data, 0, len);
+            }
+            _stats.grows += 1;
+            result = BUFFER_GROW;
+        } else if (len >= _size && orphanable()) {
+            allocate(NULL, _capacity);
+            if (len > 0) write(data, 0, len);
+            _stats.orphans += 1;
+            result = BUFFER_ORPHAN;
+        } else {
+            if (len > 0) write(data, 0, len);
+            _stats.subdata += 1;
+            result = BUFFER_SUBDATA;
+        }
+        _size = len;
+        _dirtyStart = _dirtyEnd = 0;
+        return result;
+    }
+
+    BufferUpdate update (const std::vector<T>& data) {
+        return update(data.empty() ? nullptr : &data[0], data.size());
+    }
+
+    template <size_t len>
+    BufferUpdate update (const std::array<T,len>& data) {
+        return update(&data[0], len);
+    }
+
+    // Write len elements of data at element start. The range must lie
+    // within the current capacity since growing would discard the rest of
+    // the contents.
+    BufferUpdate update (const T* data, size_t start, size_t len) {
+        if (start + len > _capacity) {
+            throw std::runtime_error("GLBufferSized: sub-range update past end of buffer");
+        }
+        write(data, start, len);
+        _size = std::max(_size, start + len);
+        _stats.subdata += 1;
+        return BUFFER_SUBDATA;
+    }
+
+    // Record that elements [start, start + len) of the client copy changed.
+    // Dirty ranges are merged into one span.
+    void markDirty (size_t start, size_t len) {
+        if (len == 0) return;
+        if (_dirtyStart == _dirtyEnd) {
+            _dirtyStart = start;
+            _dirtyEnd = start + len;
+        } else {
+            _dirtyStart = std::min(_dirtyStart, start);
+            _dirtyEnd = std::max(_dirtyEnd, start + len);
+        }
+    }
+
+    bool isDirty () const { return _dirtyStart != _dirtyEnd; }
+
+    // Upload the dirty span from source, the client copy of the whole
+    // buffer, indexed from element 0.
+    void flush (const T* source) {
+        if (!isDirty()) return;
+        update(source + _dirtyStart, _dirtyStart, _dirtyEnd - _dirtyStart);
+        _dirtyStart = _dirtyEnd = 0;
+    }
+
+    // Allocate storage for count elements. Contents are discarded.
+    void reserve (size_t count) {
+        if (count <= _capacity) return;
+        allocate(NULL, count);
+        _size = 0;
+    }
+
+    // Release the storage but keep the buffer name
+    void clear () {
+        allocate(NULL, 0);
+        _size = 0;
+        _dirtyStart = _dirtyEnd = 0;
+    }
+
+    size_t size () const { return _size; }
+    size_t capacity () const { return _capacity; }
+    GLenum usage () const { return _usage; }
+    const BufferUpdateStats& stats () const { return _stats; }
+};
+
 using PackBuffer         = GLResource<GL_PIXEL_PACK_BUFFER>;
 using UnpackBuffer       = GLResource<GL_PIXEL_UNPACK_BUFFER>;
 using QueryBuffer        = GLResource<GL_QUERY_BUFFER>;
@@ -505,7 +778,62 @@ using UniformBuffer      = GLBuffer<GL_UNIFORM_BUFFER, T>;
 
 using RenderBuffer       = GLResource<GL_RENDERBUFFER>;
 
+/**
+* Mapping policies for BufferView. Each maps to a set of glMapBufferRange
+* access bits:
+*
+*   MAP_READ                     - READ. Waits for the GPU to finish writing.
+*   MAP_READ_WRITE               - READ | WRITE. Waits for the GPU.
+*   MAP_WRITE                    - WRITE. Waits for the GPU to finish reading.
+*   MAP_WRITE_INVALIDATE_RANGE   - WRITE | INVALIDATE_RANGE. The mapped range is
+*                                  rewritten, so the driver can hand out fresh
+*                                  memory instead of waiting.
+*   MAP_WRITE_INVALIDATE_BUFFER  - WRITE | INVALIDATE_BUFFER. Orphans the whole buffer.
+*   MAP_WRITE_UNSYNCHRONIZED     - WRITE | UNSYNCHRONIZED. Never waits. For appending
+*                                  to a range the GPU isn't reading.
+*   MAP_WRITE_FLUSH_EXPLICIT     - WRITE | UNSYNCHRONIZED | FLUSH_EXPLICIT. Never waits,
+*                                  only ranges passed to BufferView::flush are made
+*                                  visible to OpenGL.
+*
+* The policies that write without waiting are the ones to use for streaming.
+* See benchmarks/map-bench.cc for how they compare to glMapBuffer.
+*/
+enum MapPolicy {
+    MAP_READ,
+    MAP_READ_WRITE,
+    MAP_WRITE,
+    MAP_WRITE_INVALIDATE_RANGE,
+    MAP_WRITE_INVALIDATE_BUFFER,
+    MAP_WRITE_UNSYNCHRONIZED,
+    MAP_WRITE_FLUSH_EXPLICIT
+};
+
 namespace detail {
+    inline GLbitfield mapAccess (MapPolicy policy) {
+        switch (policy) {
+        case MAP_READ:                    return GL_MAP_READ_BIT;
+        case MAP_READ_WRITE:              return GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
+        case MAP_WRITE:                   return GL_MAP_WRITE_BIT;
+        case MAP_WRITE_INVALIDATE_RANGE:  return GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        case MAP_WRITE_INVALIDATE_BUFFER: return GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        case MAP_WRITE_UNSYNCHRONIZED:    return GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        case MAP_WRITE_FLUSH_EXPLICIT:    return GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+        }
+        return GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
+    }
+
+    template <GLenum kind>
+    inline size_t bufferSize (GLuint res) {
+        GLint size = 0;
+        if (SGL_DSA_SUPPORTED) {
+            glGetNamedBufferParameteriv(res, GL_BUFFER_SIZE, &size);
+        } else {
+            sgl::bind<kind>(res);
+            glGetBufferParameteriv(kind, GL_BUFFER_SIZE, &size);
+        }
+        return size;
+    }
+
     // BufferView abstracts over a mapped buffer, allowing for safe and
     // convenient access. Using RAII it guarantees unmapping.
     template <class D, GLenum kind, class T = GLenum>
@@ -516,27 +844,88 @@ namespace detail {
     private:
         GLuint _res;
         D* _data;
+        size_t _len;
+        GLbitfield _access;
+
+        // Ranges passed to flush, in elements. Merged at commit.
+        std::vector<std::pair<size_t,size_t>> _dirty;
+
+        void mapRange (size_t start, size_t len) {
+            sglDbgLogVerbose("Mapping buffer: %d:%d\n", kind, _res);
+            if (SGL_DSA_SUPPORTED) {
+                _data = static_cast<D*>(glMapNamedBufferRange(_res, start, len, _access));
+            } else {
+                sgl::bind<kind>(_res);
+                _data = static_cast<D*>(glMapBufferRange(kind, start, len, _access));
+            }
+            sglDbgCatchGLError();
+        }
+
+        void flushDirty () {
+            if (_dirty.empty()) return;
+            std::sort(_dirty.begin(), _dirty.end());
+            size_t start = _dirty[0].first;
+            size_t end = _dirty[0].second;
+            for (size_t i = 1; i <= _dirty.size(); i++) {
+                if (i < _dirty.size() && _dirty[i].first <= end) {
+                    end = std::max(end, _dirty[i].second);
+                    continue;
+                }
+                if (SGL_DSA_SUPPORTED) {
+                    glFlushMappedNamedBufferRange(_res, start * sizeof(D), (end - start) * sizeof(D));
+                } else {
+                    glFlushMappedBufferRange(kind, start * sizeof(D), (end - start) * sizeof(D));
+                }
+                if (i < _dirty.size()) {
+                    start = _dirty[i].first;
+                    end = _dirty[i].second;
+                }
+            }
+            _dirty.clear();
+        }
 
     public:
+        // Maps the whole buffer with glMapBuffer and a GL_READ_ONLY,
+        // GL_WRITE_ONLY or GL_READ_WRITE access. Synchronizes with the GPU.
         BufferView (GLuint res, GLenum access) :
-            _res(res)
+            _res(res),
+            _len(0),
+            _access(0)
         {
-            // TODO: Benchmark glMapBuffer vs glMapBufferRange
             sglDbgLogVerbose("Mapping buffer: %d:%d\n", kind, _res);
-            sgl::bind<kind>(_res);
-            _data = static_cast<D*>(glMapBuffer(kind, access));
+            if (SGL_DSA_SUPPORTED) {
+                _data = static_cast<D*>(glMapNamedBuffer(_res, access));
+            } else {
+                sgl::bind<kind>(_res);
+                _data = static_cast<D*>(glMapBuffer(kind, access));
+            }
         }
 
-        BufferView(GLuint res, size_t start, size_t len, GLenum access) :
-            _res(res)
+        // Maps len bytes from start with raw glMapBufferRange access bits
+        BufferView (GLuint res, size_t start, size_t len, GLbitfield access) :
+            _res(res),
+            _len(len / sizeof(D)),
+            _access(access)
         {
-            // TODO: Benchmark glMapBuffer vs glMapBufferRange
-            sglDbgLogVerbose("Mapping buffer: %d:%d\n", kind, _res);
-            sgl::bind<kind>(_res);
-            _data = static_cast<D*>(glMapBufferRange(kind, start, len, access));
-            sglDbgCatchGLError();
+            mapRange(start, len);
+        }
+
+        BufferView (GLuint res, MapPolicy policy) :
+            _res(res),
+            _access(mapAccess(policy))
+        {
+            size_t size = bufferSize<kind>(res);
+            _len = size / sizeof(D);
+            mapRange(0, size);
         }
 
+        BufferView (GLuint res, size_t start, size_t len, MapPolicy policy) :
+            _res(res),
+            _len(len / sizeof(D)),
+            _access(mapAccess(policy))
+        {
+            mapRange(start, len);
+        }
 
         ~BufferView () {
             if (_data != nullptr) commit();
@@ -555,14 +944,38 @@ namespace detail {
             return _data[idx];
         }
 
+        D* data () {
+            return _data;
+        }
+
+        // Mapped elements. Zero when mapped with glMapBuffer.
+        size_t size () const {
+            return _len;
+        }
+
+        // Mark len elements from offset as written. With MAP_WRITE_FLUSH_EXPLICIT
+        // only flushed ranges reach OpenGL; overlapping and adjacent ranges are
+        // merged into one glFlushMappedBufferRange each at commit. Ignored by
+        // the other policies.
+        void flush (size_t offset, size_t len) {
+            if (!(_access & GL_MAP_FLUSH_EXPLICIT_BIT) || len == 0) return;
+            _dirty.emplace_back(offset, offset + len);
+        }
 
         void commit () {
-            sgl::bind<kind>(_res);
             sglDbgLogVerbose("Unmapping buffer %d:%d\n", kind, _res);
-            glUnmapBuffer(kind);
-            sglDbgCatchGLError();
-            sgl::bind<kind>(0);
-            sglDbgCatchGLError();
+            if (SGL_DSA_SUPPORTED) {
+                flushDirty();
+                glUnmapNamedBuffer(_res);
+                sglDbgCatchGLError();
+            } else {
+                sgl::bind<kind>(_res);
+                flushDirty();
+                glUnmapBuffer(kind);
+                sglDbgCatchGLError();
+                sgl::bind<kind>(0);
+                sglDbgCatchGLError();
+            }
             _data = nullptr;
         }
 
@@ -580,10 +993,24 @@ detail::BufferView<D, R::type> buffer_view (R&& res, GLenum access = GL_READ_WRI
 }
 
 template <class D, class R>
-detail::BufferView<D, R::type> buffer_view (R& res, size_t start, size_t len, GLenum access) {
+detail::BufferView<D, R::type> buffer_view (R& res, size_t start, size_t len, GLbitfield access) {
     return {res,start,len,access};
 }
 
+// ex:
+//     auto bv = sgl::buffer_view<sgl::vec4f>(buffer, sgl::MAP_WRITE_FLUSH_EXPLICIT);
+//     bv[10] = value;
+//     bv.flush(10, 1);
+template <class D, class R>
+detail::BufferView<D, R::type> buffer_view (R& res, MapPolicy policy) {
+    return {res,policy};
+}
+
+template <class D, class R>
+detail::BufferView<D, R::type> buffer_view (R& res, size_t start, size_t len, MapPolicy policy) {
+    return {res,start,len,policy};
+}
+
 template <class R, class D>
 void bufferData (R&& res, std::vector<D>& data, GLenum usage = GL_DYNAMIC_DRAW) {
     using M = typename std::remove_reference<R>::type;
@@ -602,8 +1029,7 @@ template <class R, class D>
 void bufferData (R&& res, D* data, size_t len, GLenum usage = GL_DYNAMIC_DRAW){
     using M = typename std::remove_reference<R>::type;
     static_assert(traits::IsBuffer<M::type>::value, "GLResource target must be buffer");
-    sgl::bind<M::type>(static_cast<GLuint>(res));
-    glBufferData(M::type, len * sizeof(D), data, usage);
+    detail::GLBufferInterface<M::type>::initializeMut(static_cast<GLuint>(res), reinterpret_cast<const char*>(data), len * sizeof(D), usage);
 }
 
 template <GLenum kind, class D>
@@ -613,20 +1039,30 @@ void bufferData (GLBuffer<kind, D>& buffer, std::vector<D>& data, GLenum usage =
 
 template <GLenum kind, class D>
 void bufferData (GLBuffer<kind, D>& buffer, D*  data, size_t len, GLenum usage = GL_DYNAMIC_DRAW){
-    buffer.bind();
-    glBufferData(buffer.type, len * sizeof(D), data, usage);
+    detail::GLBufferInterface<kind>::initializeMut(buffer, reinterpret_cast<const char*>(data), len * sizeof(D), usage);
 }
 
 
+// Sized buffers pick their own update strategy, usage is fixed at construction
+template <GLenum kind, class D>
+void bufferData (GLBufferSized<kind, D>& buffer, std::vector<D>& data, GLenum = GL_DYNAMIC_DRAW){
+    buffer.update(data);
+}
+
+template <GLenum kind, class D>
+void bufferData (GLBufferSized<kind, D>& buffer, D*  data, size_t len, GLenum = GL_DYNAMIC_DRAW){
+    buffer.update(data, len);
+}
+
 template <GLenum kind, class D>
 void bufferData (GLuint res, D*  data, size_t len, GLenum usage = GL_DYNAMIC_DRAW){
     static_assert(traits::IsBuffer<kind>::value, "GLResource target must be buffer");
-    sgl::bind<kind>(res);
-    glBufferData(kind, len * sizeof(D), data, usage);
+    detail::GLBufferInterface<kind>::initializeMut(res, reinterpret_cast<const char*>(data), len * sizeof(D), usage);
 }
 
 template <class T> using ArrayBuffer    = GLBuffer<GL_ARRAY_BUFFER,T>;
 template <class T> using ArrayBufferMut = GLBufferMut<GL_ARRAY_BUFFER,T>;
+template <class T> using ArrayBufferSized = GLBufferSized<GL_ARRAY_BUFFER,T>;
 
 // TODO: Does this need to be anything other than uint32_t?
 template <class T = uint32_t>
@@ -635,6 +1071,9 @@ using ElementArrayBuffer    = GLBuffer<GL_ELEMENT_ARRAY_BUFFER, T>;
 template <class T = uint32_t>
 using ElementArrayBufferMut = GLBufferMut<GL_ELEMENT_ARRAY_BUFFER, T>;
 
+template <class T = uint32_t>
+using ElementArrayBufferSized = GLBufferSized<GL_ELEMENT_ARRAY_BUFFER, T>;
+
 using VertexArray = GLResource<GL_VERTEX_ARRAY>;
 
 
@@ -644,6 +1083,13 @@ using VertexArray = GLResource<GL_VERTEX_ARRAY>;
 * the correct GL types, offsets, strides, and sizes to correctly
 * access a buffer in GLSL.
 *
+* Attributes are described as formats read from buffer bindings
+* (glVertexAttribFormat, glVertexAttribBinding, glBindVertexBuffer).
+* The builder fills a fixed size VertexLayout, so it doesn't allocate.
+* commit() only specifies formats when the vertex array's last layout
+* differs, committing again after replaceBuffer just rebinds buffers.
+* Before OpenGL 4.3 commit falls back to glVertexAttribPointer.
+*
 * eg:
 * The following code creates a VertexArray and creates three attributes
 *
@@ -682,40 +1128,24 @@ using VertexArray = GLResource<GL_VERTEX_ARRAY>;
 *     if (hasColor) builder.addBuffer<sgl::vec4f>(vertBuf);
 *     else          builder.skip<sgl::vec4f>(vertBuf);
 *     builder.commit();
+*
+* eg:
+* Swapping buffers
+*
+*     sgl::VertexAttribBuilder builder(vao);
+*     builder.addBuffer<sgl::vec3f>(frames[0]).commit();
+*     ...
+*     builder.replaceBuffer(frames[0], frames[1]).commit();
+*
+* eg:
+* Reflected vertex struct (see SGL_VERTEX_FORMAT)
+*
+*     sgl::vertexAttribBuilder(vao)
+*         .addElementBuffer(elBuf)
+*         .addVertexBuffer<Vertex>(vertBuf)
+*         .addBuffer<sgl::mat4f>(instanceBuf, 1)
+*         .commit();
 */
-
-namespace detail {
-    struct VertexAttrib {
-        GLenum type;
-        size_t offset;
-        size_t elSize;
-        size_t components;
-        GLuint div;
-        uint32_t attrib;
-    };
-
-    struct VertexAttribBuffer {
-        size_t stride;
-        size_t offset;
-        std::vector<VertexAttrib> attribs;
-    };
-
-    template <class T>
-    VertexAttrib makeVertexAttrib (size_t offset, uint32_t attrib, GLuint div = 0) {
-        GLenum type = traits::GLType<T>::type;
-        size_t elSize = sizeof(typename traits::CType<traits::GLType<T>::type>::type);
-        size_t components = sizeof(T) / elSize;
-        return { type, offset, elSize, components, div, attrib};
-    }
-} // end namespace
-
-// TODO: This approach makes it impossible to
-// skip elements of a interleaved vbo. Current work around
-// is to add a skip function, which isn't pretty, but it works...
-
-// TODO: Rework this to use VertexAttribNew and VertexAttribBuffer. It's
-// more elegant, more flexible, and more performant.
-
 class VertexAttribBuilder {
 private:
     VertexArray& vao;
@@ -726,14 +1156,19 @@ private:
     // Total number of attribs used
     uint32_t attribs;
 
-    // Buffer state map
-    std::map<GLuint, detail::VertexAttribBuffer> buffers;
+    VertexLayout _layout;
+
+    // Offset of the next attribute in each binding's vertex
+    GLuint _cursors[SGL_MAX_VERTEX_ATTRIBS];
 
 public:
     VertexAttribBuilder (VertexArray& vao, uint32_t attribs = 0) :
         vao(vao),
         attribs(attribs)
-    {}
+    {
+        _layout.attribCount = 0;
+        _layout.bindingCount = 0;
+    }
 
     VertexAttribBuilder& addElementBuffer (GLResource<GL_ELEMENT_ARRAY_BUFFER>& buffer) {
         ebo = buffer;
@@ -742,15 +1177,38 @@ public:
 
     template <class T, class ...Ts>
     VertexAttribBuilder& addBuffer (GLResource<GL_ARRAY_BUFFER>& res, GLuint div = 0) {
-        buffers[res].stride += traits::param_size<T,Ts...>::size;
-        queueAttrib<T,Ts...>(res, div);
+        uint32_t binding = findBinding(res);
+        _layout.bindings[binding].stride += traits::param_size<T,Ts...>::size;
+        _layout.bindings[binding].divisor = div;
+        queueAttrib<T,Ts...>(binding);
         return *this;
     }
 
     template <class D, class T = D, class ...Ts>
     VertexAttribBuilder& addBuffer (ArrayBuffer<D>& res, GLuint div = 0) {
-        buffers[res].stride += traits::param_size<T,Ts...>::size;
-        queueAttrib<D,T,Ts...>(res, div);
+        uint32_t binding = findBinding(res);
+        _layout.bindings[binding].stride += traits::param_size<T,Ts...>::size;
+        _layout.bindings[binding].divisor = div;
+        queueAttrib<D,T,Ts...>(binding);
+        return *this;
+    }
+
+    // Add every field of vertex struct V, as described by traits::VertexFormat<V>
+    template <class V>
+    VertexAttribBuilder& addVertexBuffer (GLResource<GL_ARRAY_BUFFER>& res, GLuint div = 0) {
+        using Format = traits::VertexFormat<V>;
+        if (_layout.attribCount + Format::count > SGL_MAX_VERTEX_ATTRIBS) throw std::runtime_error("VertexAttribBuilder: too many attributes");
+        uint32_t binding = findBinding(res);
+        detail::VertexBinding& buf = _layout.bindings[binding];
+        if (buf.index == detail::NO_BINDING) buf.index = attribs;
+        buf.stride += Format::stride;
+        buf.divisor = div;
+        for (size_t i = 0; i < Format::count; i++) {
+            const detail::FieldFormat& field = Format::fields[i];
+            _layout.attribs[_layout.attribCount++] = { field.type, _cursors[binding] + field.offset, field.components, attribs, buf.index };
+            attribs += 1;
+        }
+        _cursors[binding] += Format::stride;
         return *this;
     }
 
@@ -761,14 +1219,27 @@ public:
     }
 
     VertexAttribBuilder& skipBytes (GLResource<GL_ARRAY_BUFFER>& res, size_t size) {
-        detail::VertexAttribBuffer& buf = buffers[res];
-        buf.offset += size;
-        buf.stride += size;
+        uint32_t binding = findBinding(res);
+        _cursors[binding] += size;
+        _layout.bindings[binding].stride += size;
         return *this;
     }
 
+    // Read the attributes added from buffer from, starting offset bytes in, from to instead
+    VertexAttribBuilder& replaceBuffer (GLResource<GL_ARRAY_BUFFER>& from, GLResource<GL_ARRAY_BUFFER>& to, size_t offset = 0) {
+        for (uint32_t i = 0; i < _layout.bindingCount; i++) {
+            detail::VertexBinding& binding = _layout.bindings[i];
+            if (binding.buffer != static_cast<GLuint>(from)) continue;
+            binding.buffer = to;
+            binding.offset = offset;
+            return *this;
+        }
+        throw std::runtime_error("VertexAttribBuilder: buffer has not been added");
+    }
+
     VertexAttribBuilder& reset () {
-        buffers.clear();
+        _layout.attribCount = 0;
+        _layout.bindingCount = 0;
         attribs = 0;
         ebo = 0;
         return *this;
@@ -778,45 +1249,46 @@ public:
     * @brief commit Perform vertex array configuration.
     */
     void commit () {
-        vao.bind();
-        if (ebo != 0) sgl::bind<GL_ELEMENT_ARRAY_BUFFER>(ebo);
-        for (const auto& b : buffers) {
-            sgl::bind<GL_ARRAY_BUFFER>(b.first);
-            const detail::VertexAttribBuffer& buf = b.second;
-            for (const auto& attr : buf.attribs){
-                addAttribute(attr, buf.stride);
-            }
-        }
-        vao.unbind();
+        detail::applyVertexLayout(vao, ebo, _layout);
     }
 
+    const VertexLayout& layout () const { return _layout; }
+
 private:
 
+    uint32_t findBinding (GLResource<GL_ARRAY_BUFFER>& res) {
+        GLuint buffer = res;
+        for (uint32_t i = 0; i < _layout.bindingCount; i++) {
+            if (_layout.bindings[i].buffer == buffer) return i;
+        }
+        if (_layout.bindingCount == SGL_MAX_VERTEX_ATTRIBS) throw std::runtime_error("VertexAttribBuilder: too many buffers");
+        uint32_t idx = _layout.bindingCount++;
+        _layout.bindings[idx] = { buffer, detail::NO_BINDING, 0, 0, 0 };
+        _cursors[idx] = 0;
+        return idx;
+    }
+
     template <class T, class T2, class ...Ts>
-    void queueAttrib (GLResource<GL_ARRAY_BUFFER>& res, GLuint div = 0) {
-        queueAttrib<T>(res,div);
-        queueAttrib<T2,Ts...>(res,div);
+    void queueAttrib (uint32_t binding) {
+        queueAttrib<T>(binding);
+        queueAttrib<T2,Ts...>(binding);
     }
 
     template <class T>
-    void queueAttrib (GLResource<GL_ARRAY_BUFFER>& res, GLuint div = 0) {
+    void queueAttrib (uint32_t binding) {
         GLenum type = traits::GLType<T>::type;
         size_t elSize = sizeof(typename traits::CType<traits::GLType<T>::type>::type);
-        size_t components = sizeof(T) / elSize;
-        detail::VertexAttribBuffer& buf = buffers[res];
-        buffers[res].attribs.push_back({
-            type, buf.offset, elSize, components, div, attribs
-        });
-        buf.offset += sizeof(T);
+        GLuint components = sizeof(T) / elSize;
+        if (_layout.attribCount == SGL_MAX_VERTEX_ATTRIBS) throw std::runtime_error("VertexAttribBuilder: too many attributes");
+
+        // A buffer reads from the binding at its first attribute's location,
+        // so builders extending a vertex array don't reuse bindings
+        detail::VertexBinding& buf = _layout.bindings[binding];
+        if (buf.index == detail::NO_BINDING) buf.index = attribs;
+        _layout.attribs[_layout.attribCount++] = { type, _cursors[binding], components, attribs, buf.index };
+        _cursors[binding] += sizeof(T);
         attribs += 1;
     }
-
-    void addAttribute (const detail::VertexAttrib& attrib, GLint stride) {
-        glEnableVertexAttribArray(attrib.attrib);
-        glVertexAttribPointer(attrib.attrib, attrib.components, attrib.type, GL_FALSE, stride, (GLvoid*)attrib.offset);
-        glVertexAttribDivisor(attrib.attrib, attrib.div);
-        sglDbgCatchGLError();
-    }
 };
 
 
@@ -824,10 +1296,26 @@ inline VertexAttribBuilder vertexAttribBuilder (VertexArray& vao, uint32_t attri
     return {vao,attribs};
 }
 
-// Thin wrapper around GL_FRAMEBUFFER. Provides functionality for attaching textures and renderbuffers
+// Thin wrapper around GL_FRAMEBUFFER. Provides functionality for attaching textures and renderbuffers,
+// selecting draw buffers for multiple render targets and invalidating attachments.
+// With direct state access none of these bind the framebuffer.
 template <GLenum kind>
 class FramebufferBase : public GLResource<kind> {
     static_assert(traits::IsFramebuffer<kind>::value, "Not valid framebuffer target");
+private:
+    template <GLenum res>
+    void attachColors (GLenum* buffers, GLsizei idx, GLResource<res>& texture) {
+        static_assert(!traits::IsTex3D<res>::value, "Attach 3D texture layers with attachTexture");
+        attachTexture(texture, GL_COLOR_ATTACHMENT0 + idx);
+        buffers[idx] = GL_COLOR_ATTACHMENT0 + idx;
+    }
+
+    template <GLenum res, class ...Ts>
+    void attachColors (GLenum* buffers, GLsizei idx, GLResource<res>& texture, Ts&... rest) {
+        attachColors(buffers, idx, texture);
+        attachColors(buffers, idx + 1, rest...);
+    }
+
 public:
     FramebufferBase () :
         GLResource<kind>()
@@ -835,26 +1323,91 @@ public:
 
     template <GLenum res>
     traits::IfTex1D<res,void> attachTexture (GLResource<res>& texture, GLenum attachment = GL_COLOR_ATTACHMENT0, GLint level = 0) {
-        this->bind();
-        glFramebufferTexture1D(kind, attachment, res, texture, level);
+        if (SGL_DSA_SUPPORTED && traits::IsDSATexture<res>::value) {
+            glNamedFramebufferTexture(this->_id, attachment, texture, level);
+        } else {
+            this->bind();
+            glFramebufferTexture1D(kind, attachment, res, texture, level);
+        }
     }
 
     template <GLenum res>
     traits::IfTex2D<res,void> attachTexture (GLResource<res>& texture, GLenum attachment = GL_COLOR_ATTACHMENT0, GLint level = 0) {
-        this->bind();
-        glFramebufferTexture2D(kind, attachment, res, texture, level);
+        if (SGL_DSA_SUPPORTED && traits::IsDSATexture<res>::value) {
+            glNamedFramebufferTexture(this->_id, attachment, texture, level);
+        } else {
+            this->bind();
+            glFramebufferTexture2D(kind, attachment, res, texture, level);
+        }
     }
 
     template <GLenum res>
     traits::IfTex3D<res,void> attachTexture (GLResource<res>& texture, GLint layer = 0, GLenum attachment = GL_COLOR_ATTACHMENT0, GLint level = 0) {
-        this->bind();
-        glFramebuffer3D(kind, attachment, res, texture, level, layer);
+        if (SGL_DSA_SUPPORTED) {
+            glNamedFramebufferTextureLayer(this->_id, attachment, texture, level, layer);
+        } else {
+            this->bind();
+            glFramebufferTexture3D(kind, attachment, res, texture, level, layer);
+        }
     }
 
 
     void attachTexture (RenderBuffer& buffer, GLenum attachment = GL_COLOR_ATTACHMENT0) {
-        this->bind();
-        glFramebufferRenderbuffer(kind, attachment, buffer.type, buffer);
+        if (SGL_DSA_SUPPORTED) {
+            glNamedFramebufferRenderbuffer(this->_id, attachment, buffer.type, buffer);
+        } else {
+            this->bind();
+            glFramebufferRenderbuffer(kind, attachment, buffer.type, buffer);
+        }
+    }
+
+    /**
+    * Attach textures to color attachments 0..N-1 and draw to all of them,
+    * so a single pass writes every output (layout(location = i) in GLSL).
+    *
+    * ex:
+    *
+    *     fbo.attachColorTextures(velocity, density, temperature);
+    */
+    template <GLenum res, class ...Ts>
+    void attachColorTextures (GLResource<res>& texture, Ts&... rest) {
+        GLenum buffers[1 + sizeof...(Ts)];
+        attachColors(buffers, 0, texture, rest...);
+        drawBuffers(buffers, 1 + sizeof...(Ts));
+    }
+
+    // Select the color attachments fragment outputs are written to. GL_NONE disables an output.
+    void drawBuffers (const GLenum* buffers, GLsizei count) {
+        static_assert(kind != GL_READ_FRAMEBUFFER, "Read framebuffers have no draw buffers");
+        if (SGL_DSA_SUPPORTED) {
+            glNamedFramebufferDrawBuffers(this->_id, count, buffers);
+        } else {
+            this->bind();
+            glDrawBuffers(count, buffers);
+        }
+        sglDbgCatchGLError();
+    }
+
+    void drawBuffers (std::initializer_list<GLenum> buffers) {
+        drawBuffers(buffers.begin(), buffers.size());
+    }
+
+    // Tell the driver the contents of attachments are no longer needed, so
+    // they aren't stored back to memory (or loaded on the next use). No-op
+    // before OpenGL 4.3 / ES 3.0.
+    void invalidate (const GLenum* attachments, GLsizei count) {
+        if (!SGL_INVALIDATEFRAMEBUFFER_SUPPORTED) return;
+        if (SGL_DSA_SUPPORTED) {
+            glInvalidateNamedFramebufferData(this->_id, count, attachments);
+        } else {
+            this->bind();
+            glInvalidateFramebuffer(kind, count, attachments);
+        }
+        sglDbgCatchGLError();
+    }
+
+    void invalidate (std::initializer_list<GLenum> attachments) {
+        invalidate(attachments.begin(), attachments.size());
     }
 };
 
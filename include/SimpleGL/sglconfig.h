@@ -10,6 +10,8 @@
 *                        If OpenGL 4.3 is available consider using sgl::utils::initializeDebugging
 * SGL_NO_GL            - Disable inclusion of all opengl related headers. Useful for including sgl
 *                        in another project.
+* SGL_NO_DSA           - Never use direct state access, even when OpenGL 4.5 or
+*                        ARB_direct_state_access is available.
 */
 
 #ifndef SGL_NO_GL
@@ -51,6 +53,12 @@
 namespace sgl {
 namespace config {
     bool sglOpenglVersion (int major, int minor);
+
+    // True when direct state access was detected by sglInitialize.
+    bool sglDirectStateAccess ();
+
+    // True when pipeline statistics queries were detected by sglInitialize.
+    bool sglPipelineStatistics ();
 } // end namespace
 
 void sglInitialize (int major, int minor);
@@ -67,8 +75,20 @@ void sglInitialize (int major, int minor);
 #   define SGL_PROGRAMPIPELINES_SUPPORTED sgl::config::sglOpenglVersion(4,1)
 #   define SGL_TEXSTORAGE_SUPPORTED       sgl::config::sglOpenglVersion(4,2)
 #   define SGL_COMPUTESHADER_SUPPORTED    sgl::config::sglOpenglVersion(4,3)
+#   define SGL_DRAWINDIRECT_SUPPORTED     sgl::config::sglOpenglVersion(4,0)
+#   define SGL_MULTIDRAWINDIRECT_SUPPORTED sgl::config::sglOpenglVersion(4,3)
+#   define SGL_VERTEXATTRIBBINDING_SUPPORTED sgl::config::sglOpenglVersion(4,3)
+#   define SGL_INVALIDATEFRAMEBUFFER_SUPPORTED sgl::config::sglOpenglVersion(4,3)
+#   define SGL_TIMERQUERY_SUPPORTED       sgl::config::sglOpenglVersion(3,3)
+#   define SGL_PIPELINESTATISTICS_SUPPORTED sgl::config::sglPipelineStatistics()
 #   define SGL_DEBUGLOG_SUPPORTED         sgl::config::sglOpenglVersion(4,3)
 #   define SGL_BUFFERSTORAGE_SUPPORTED    sgl::config::sglOpenglVersion(4,4)
+#   define SGL_SYNC_SUPPORTED             sgl::config::sglOpenglVersion(3,2)
+#   ifndef SGL_NO_DSA
+#       define SGL_DSA_SUPPORTED          sgl::config::sglDirectStateAccess()
+#   else
+#       define SGL_DSA_SUPPORTED          false
+#   endif
 #else
 // OpenGL ES
 #   define SGL_RENDERBUFFER_SUPPORTED     sgl::config::sglOpenglVersion(2,0)
@@ -78,8 +98,16 @@ void sglInitialize (int major, int minor);
 #   define SGL_TEXSTORAGE_SUPPORTED       sgl::config::sglOpenglVersion(3,0)
 #   define SGL_PROGRAMPIPELINES_SUPPORTED sgl::config::sglOpenglVersion(3,1)
 #   define SGL_COMPUTESHADER_SUPPORTED    sgl::config::sglOpenglVersion(3,1)
+#   define SGL_DRAWINDIRECT_SUPPORTED     sgl::config::sglOpenglVersion(3,1)
+#   define SGL_MULTIDRAWINDIRECT_SUPPORTED false
+#   define SGL_VERTEXATTRIBBINDING_SUPPORTED sgl::config::sglOpenglVersion(3,1)
+#   define SGL_INVALIDATEFRAMEBUFFER_SUPPORTED sgl::config::sglOpenglVersion(3,0)
+#   define SGL_TIMERQUERY_SUPPORTED       false
+#   define SGL_PIPELINESTATISTICS_SUPPORTED false
 #   define SGL_BUFFERSTORAGE_SUPPORTED    false
+#   define SGL_SYNC_SUPPORTED             sgl::config::sglOpenglVersion(3,0)
 #   define SGL_DEBUGLOG_SUPPORTED         sgl::config::sglOpenglVersion(3,2)
+#   define SGL_DSA_SUPPORTED              false
 #endif
 
 #define SGL_RW                         (SGL_BUFFERSTORAGE_SUPPORTED ? (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT) : GL_DYNAMIC_DRAW)
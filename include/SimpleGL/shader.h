@@ -10,6 +10,9 @@
 
 namespace sgl{
 
+class UniformArena;
+struct UniformSlot;
+
 /**
 * ShaderStage represents a single compiled shader part (eg GL_VERTEX_SHADER).
 * ShaderStages can be cached and relinked to save compilation time.
@@ -33,6 +36,7 @@ using ComputShader   = ShaderStage<GL_COMPUTE_SHADER>;
 
 template<GLenum kind>
 ShaderStage<kind> compileShaderStage (const char ** source, size_t len, const std::string& path = "") {
+    sglTraceScope("shader", path.empty() ? "compileShaderStage" : path.c_str());
     ShaderStage<kind> shader;
     glShaderSource(shader, len, source, NULL);
     glCompileShader(shader);
@@ -186,6 +190,11 @@ public:
 
     GLint setUniformBlock (const char * id, GLResource<GL_UNIFORM_BUFFER>& ubo, GLuint unit = 0);
 
+    // Bind size bytes of ubo starting at offset with glBindBufferRange
+    GLint setUniformBlock (const char * id, GLResource<GL_UNIFORM_BUFFER>& ubo, GLuint unit, size_t offset, size_t size);
+
+    GLint setUniformBlock (const char * id, UniformArena& arena, const UniformSlot& slot, GLuint unit = 0);
+
 };
 
 namespace detail {
@@ -222,6 +231,7 @@ namespace detail {
 // T Should be a ShaderStage ...
 template <class T, class ...Ts>
 void linkShaderStages (Shader& shader, T& stage, Ts ...stages) {
+    sglTraceScope("shader", "linkShaderStages");
     detail::linkShaderStagesHelper(shader,stage,stages...);
     glLinkProgram(shader);
     detail::catchShaderLinkErrors(shader);
@@ -229,6 +239,7 @@ void linkShaderStages (Shader& shader, T& stage, Ts ...stages) {
 
 template <class T>
 void linkShaderStages (Shader& shader, T& stage) {
+    sglTraceScope("shader", "linkShaderStages");
     detail::linkShaderStagesHelper(shader,stage);
     glLinkProgram(shader);
     detail::catchShaderLinkErrors(shader);
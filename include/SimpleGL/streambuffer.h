@@ -0,0 +1,213 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include "sglconfig.h"
+#include "utils.h"
+#include "resource.h"
+#include "allocator.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace sgl {
+
+namespace detail {
+    // Block until fence signals, flushing the command stream while waiting.
+    // Returns true if the CPU had to wait.
+    inline bool waitFence (GLsync fence) {
+        if (fence == nullptr) return false;
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status != GL_TIMEOUT_EXPIRED) return false;
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        return true;
+    }
+
+    template <GLenum kind>
+    inline void* mapBufferRange (GLuint res, size_t offset, size_t len, GLbitfield access) {
+        if (SGL_DSA_SUPPORTED) return glMapNamedBufferRange(res, offset, len, access);
+        sgl::bind<kind>(res);
+        return glMapBufferRange(kind, offset, len, access);
+    }
+
+    template <GLenum kind>
+    inline void unmapBuffer (GLuint res) {
+        if (SGL_DSA_SUPPORTED) {
+            glUnmapNamedBuffer(res);
+        } else {
+            sgl::bind<kind>(res);
+            glUnmapBuffer(kind);
+        }
+    }
+} // end namespace
+
+struct StreamBufferStats {
+    uint64_t frames; // Regions handed out
+    uint64_t stalls; // Times next() had to wait on the GPU
+};
+
+/**
+* StreamBuffer is a ring of N equally sized regions in a single buffer, meant
+* for data rewritten every frame (point clouds, instance data, uniforms).
+* Storage is allocated once. With buffer storage (OpenGL 4.4) the whole buffer
+* is mapped persistently and coherently, so an upload is a memcpy into the
+* pointer returned by next(). Each region is fenced when the writer moves
+* past it, and next() only waits if the GPU is still reading the region it
+* is about to hand out.
+*
+* Without buffer storage each region is mapped unsynchronized when handed out
+* and unmapped by commit(). Call commit() before drawing in either case; it is
+* free for persistent buffers.
+*
+* Regions are aligned to alignment bytes (eg: GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT).
+* Uniform buffers query it automatically.
+*
+* ex:
+*
+*     sgl::StreamBuffer<GL_ARRAY_BUFFER, sgl::vec4f> points(count);
+*     sgl::vertexAttribBuilder(vao).addBuffer<sgl::vec3f, float>(points).commit();
+*     while (running) {
+*         sgl::vec4f* dst = points.next();
+*         memcpy(dst, simulation.data(), count * sizeof(sgl::vec4f));
+*         points.commit();
+*         glDrawArrays(GL_POINTS, points.first(), count);
+*     }
+*
+* ex:
+*
+*     sgl::StreamBuffer<GL_UNIFORM_BUFFER, Lights> lights(1);
+*     *lights.next() = frameLights;
+*     lights.commit();
+*     glBindBufferRange(GL_UNIFORM_BUFFER, 0, lights, lights.offset(), lights.regionSize());
+*/
+template <GLenum kind, class T>
+class StreamBuffer : public GLResource<kind> {
+    static_assert(traits::IsBuffer<kind>::value, "StreamBuffer target must be buffer");
+private:
+    size_t _count;
+    size_t _regions;
+    size_t _regionSize;
+    size_t _current;
+    bool _persistent;
+    bool _mapped;
+    char* _data;
+    std::vector<GLsync> _fences;
+    StreamBufferStats _stats;
+
+public:
+    using value_type = T;
+
+    StreamBuffer () :
+        GLResource<kind>(0),
+        _count(0),
+        _regions(0),
+        _regionSize(0),
+        _current(0),
+        _persistent(false),
+        _mapped(false),
+        _data(nullptr),
+        _stats{0,0}
+    {}
+
+    // count elements of T per region, regions regions. Three covers the
+    // frame being written, the frame queued and the frame being drawn.
+    StreamBuffer (size_t count, size_t regions = 3, size_t alignment = 0) :
+        GLResource<kind>(),
+        _count(count),
+        _regions(regions),
+        _current(regions - 1),
+        _persistent(SGL_BUFFERSTORAGE_SUPPORTED),
+        _mapped(false),
+        _data(nullptr),
+        _fences(regions, nullptr),
+        _stats{0,0}
+    {
+        if (alignment == 0 && kind == GL_UNIFORM_BUFFER) {
+            GLint align = 0;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+            alignment = align;
+        }
+        if (alignment == 0) alignment = sizeof(T);
+        _regionSize = detail::alignUp(sizeof(T) * count, alignment);
+
+        size_t size = _regionSize * _regions;
+        if (_persistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            detail::GLBufferInterface<kind>::initialize(this->_id, NULL, size, flags);
+            _data = static_cast<char*>(detail::mapBufferRange<kind>(this->_id, 0, size, flags));
+        } else {
+            detail::GLBufferInterface<kind>::initializeMut(this->_id, NULL, size, GL_STREAM_DRAW);
+        }
+        sglDbgCatchGLError();
+    }
+
+    // Fence the region in use and return a pointer to the next one.
+    // Blocks only if the GPU hasn't finished with that region.
+    T* next () {
+        if (_mapped) commit();
+        if (SGL_SYNC_SUPPORTED) {
+            GLsync& used = _fences[_current];
+            if (used != nullptr) glDeleteSync(used);
+            used = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        _current = (_current + 1) % _regions;
+        GLsync& fence = _fences[_current];
+        if (detail::waitFence(fence)) _stats.stalls += 1;
+        if (fence != nullptr) glDeleteSync(fence);
+        fence = nullptr;
+        _stats.frames += 1;
+
+        if (_persistent) return reinterpret_cast<T*>(_data + offset());
+
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        if (SGL_SYNC_SUPPORTED) access |= GL_MAP_UNSYNCHRONIZED_BIT;
+        _mapped = true;
+        return static_cast<T*>(detail::mapBufferRange<kind>(this->_id, offset(), _regionSize, access));
+    }
+
+    // Make writes to the current region visible to OpenGL
+    void commit () {
+        if (!_mapped) return;
+        detail::unmapBuffer<kind>(this->_id);
+        _mapped = false;
+        sglDbgCatchGLError();
+    }
+
+    // Byte offset of the current region. Use with glBindBufferRange or as a draw offset.
+    size_t offset () const { return _regionSize * _current; }
+
+    // Element index of the current region. Use as glDrawArrays' first or as a base vertex.
+    size_t first () const { return offset() / sizeof(T); }
+
+    // Elements per region
+    size_t count () const { return _count; }
+
+    // Bytes per region, including alignment padding
+    size_t regionSize () const { return _regionSize; }
+
+    size_t regions () const { return _regions; }
+
+    bool isPersistent () const { return _persistent; }
+
+    const StreamBufferStats& stats () const { return _stats; }
+
+    void release () {
+        if (this->_id == 0) return;
+        if (_persistent || _mapped) detail::unmapBuffer<kind>(this->_id);
+        for (auto& fence : _fences) {
+            if (fence != nullptr) glDeleteSync(fence);
+            fence = nullptr;
+        }
+        _data = nullptr;
+        _mapped = false;
+        GLResource<kind>::release();
+        this->_id = 0;
+    }
+};
+
+} // end namespace
+
+#endif // STREAMBUFFER_H
@@ -3,6 +3,7 @@
 #include <initializer_list>
 #include <vector>
 #include <array>
+#include <algorithm>
 
 #include "sglconfig.h"
 #include "utils.h"
@@ -14,86 +15,169 @@ namespace sgl {
 
 namespace detail {
 
+    // Textures are edited by name when direct state access is available. Targets glCreateTextures
+    // doesn't accept (cube map faces, proxies) keep using bind to edit.
+    template <GLenum kind>
+    inline bool directTexture () {
+        return SGL_DSA_SUPPORTED && traits::IsDSATexture<kind>::value;
+    }
+
+    // Number of mip levels to allocate for immutable storage. Unless specified, a full
+    // mip chain is allocated only if the minifying filter samples mipmaps.
+    inline GLsizei textureLevels (const GLTextureInfoBase& info, int size) {
+        if (info.levels > 0) return info.levels;
+        if (info.min_filter == GL_NEAREST || info.min_filter == GL_LINEAR) return 1;
+        GLsizei levels = 1;
+        while (size >>= 1) levels++;
+        return levels;
+    }
+
+    // Bytes read by an upload of tightly packed texels, for the GL counters
+    inline size_t uploadSize (GLenum format, GLenum type, size_t texels) {
+        return texels * traits::formatSize(traits::sizedFormat(format, type));
+    }
+
+    // Unless directTexture<kind>() is true, the texture must be bound to kind
+    // before calling any of the following.
     template <GLenum kind, class T = GLenum>
     struct GLTextureInterface;
 
     template <GLenum kind>
     struct GLTextureInterface<kind, traits::IfTex1D<kind>> {
-        static inline void allocate (const GLTextureInfo<kind>& info) {
-            if (SGL_TEXSTORAGE_SUPPORTED) {
-                glTexStorage1D(kind, info.levels, info.iformat, info.width);
-                sglDbgLogVerbose("glTexStorage1D(%d, %lu, %d, %d)\n", kind, info.levels, info.iformat, info.width);
+        static inline void allocate (GLuint res, const GLTextureInfo<kind>& info) {
+            GLsizei levels = textureLevels(info, info.width);
+            if (directTexture<kind>()) {
+                glTextureStorage1D(res, levels, traits::sizedFormat(info.iformat, info.data_type), info.width);
+                sglDbgLogVerbose("glTextureStorage1D(%d, %d, %d, %d)\n", res, levels, info.iformat, info.width);
+            } else if (SGL_TEXSTORAGE_SUPPORTED) {
+                glTexStorage1D(kind, levels, traits::sizedFormat(info.iformat, info.data_type), info.width);
+                sglDbgLogVerbose("glTexStorage1D(%d, %d, %d, %d)\n", kind, levels, info.iformat, info.width);
             }
             else allocateMut(info);
         }
 
         static inline void allocateMut (const GLTextureInfo<kind>& info) {
-            write(NULL,info);
+            glTexImage1D(kind, 0, info.iformat, info.width, 0, info.format, info.data_type, NULL);
+            sglDbgLogVerbose("glTexImage1D(%d, 0, %d, %d, 0, %d, %d, NULL)\n", kind, info.iformat, info.width, info.format, info.data_type);
         }
 
-        static inline void write (const void* data, const GLTextureInfo<kind>& info) {
+        static inline void write (GLuint res, const void* data, const GLTextureInfo<kind>& info) {
+            if (directTexture<kind>()) {
+                allocate(res, info);
+                if (data != nullptr) update(res, data, info);
+                return;
+            }
             glTexImage1D(kind, 0, info.iformat, info.width, 0, info.format, info.data_type, data);
             sglDbgLogVerbose("glTexImage1D(%d, 0, %d, %d, 0, %d, %d, NULL)\n", kind, info.iformat, info.width, info.format, info.data_type);
+            if (data != nullptr) sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width));
         }
-        
-        static inline void update (const void* data, const GLTextureInfo<kind>& info, int x = 0) {
-            glTexSubImage1D(kind, 0, x, info.width, info.format, info.data_type, data);
-            sglDbgLogVerbose("glTexSubImage1D(%d, 0, %d, %d, %d, %d, %p)\n", kind, x, info.width, info.format, info.data_type, data);
+
+        static inline void update (GLuint res, const void* data, const GLTextureInfo<kind>& info, int x = 0) {
+            if (directTexture<kind>()) {
+                glTextureSubImage1D(res, 0, x, info.width, info.format, info.data_type, data);
+                sglDbgLogVerbose("glTextureSubImage1D(%d, 0, %d, %d, %d, %d, %p)\n", res, x, info.width, info.format, info.data_type, data);
+            } else {
+                glTexSubImage1D(kind, 0, x, info.width, info.format, info.data_type, data);
+                sglDbgLogVerbose("glTexSubImage1D(%d, 0, %d, %d, %d, %d, %p)\n", kind, x, info.width, info.format, info.data_type, data);
+            }
+            sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width));
         }
     };
 
     template <GLenum kind>
     struct GLTextureInterface<kind, traits::IfTex2D<kind>> {
-        static inline void allocate (const GLTextureInfo<kind>& info) {
-            if (SGL_TEXSTORAGE_SUPPORTED) {
-                glTexStorage2D(kind, info.levels, info.iformat, info.width, info.height);
+        static inline void allocate (GLuint res, const GLTextureInfo<kind>& info) {
+            GLsizei levels = textureLevels(info, std::max(info.width, info.height));
+            if (directTexture<kind>()) {
+                glTextureStorage2D(res, levels, traits::sizedFormat(info.iformat, info.data_type), info.width, info.height);
+            } else if (SGL_TEXSTORAGE_SUPPORTED) {
+                glTexStorage2D(kind, levels, traits::sizedFormat(info.iformat, info.data_type), info.width, info.height);
             } else allocateMut(info);
         }
 
         static inline void allocateMut (const GLTextureInfo<kind>& info) {
-            write(NULL,info);
+            glTexImage2D(kind, 0, info.iformat, info.width, info.height, 0, info.format, info.data_type, NULL);
         }
 
-        static inline void write (const void* data, const GLTextureInfo<kind>& info) {
+        static inline void write (GLuint res, const void* data, const GLTextureInfo<kind>& info) {
+            if (directTexture<kind>()) {
+                allocate(res, info);
+                if (data != nullptr) update(res, data, info);
+                return;
+            }
             glTexImage2D(kind, 0, info.iformat, info.width, info.height, 0, info.format, info.data_type, data);
+            if (data != nullptr) sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width * info.height));
         }
 
-        static inline void update (const void* data, const GLTextureInfo<kind>& info, int x = 0, int y = 0) {
-            glTexSubImage2D(kind, 0, x, y, info.width, info.height, info.format, info.data_type, data);
+        static inline void update (GLuint res, const void* data, const GLTextureInfo<kind>& info, int x = 0, int y = 0) {
+            if (directTexture<kind>()) glTextureSubImage2D(res, 0, x, y, info.width, info.height, info.format, info.data_type, data);
+            else glTexSubImage2D(kind, 0, x, y, info.width, info.height, info.format, info.data_type, data);
+            sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width * info.height));
         }
     };
 
     template <GLenum kind>
     struct GLTextureInterface<kind, traits::IfTex2DArray<kind>> {
-        static inline void allocate (const GLTextureInfo<kind>& info) {
-            if (SGL_TEXSTORAGE_SUPPORTED) {
-                glTexStorage3D(kind, info.levels, info.iformat, info.width, info.height, info.length);
+        static inline void allocate (GLuint res, const GLTextureInfo<kind>& info) {
+            GLsizei levels = textureLevels(info, std::max(info.width, info.height));
+            if (directTexture<kind>()) {
+                // Cube map storage is allocated for all faces at once
+                glTextureStorage2D(res, levels, traits::sizedFormat(info.iformat, info.data_type), info.width, info.height);
+            } else if (SGL_TEXSTORAGE_SUPPORTED) {
+                glTexStorage3D(kind, levels, traits::sizedFormat(info.iformat, info.data_type), info.width, info.height, info.length);
             } else allocateMut(info);
         }
 
         static inline void allocateMut (const GLTextureInfo<kind>& info) {
-            write(NULL,info);
+            glTexImage3D(kind, 0, info.iformat, info.width, info.height, info.length, 0, info.format, info.data_type, NULL);
         }
 
-        static inline void write (const void* data, const GLTextureInfo<kind>& info) {
+        static inline void write (GLuint res, const void* data, const GLTextureInfo<kind>& info) {
+            if (directTexture<kind>()) {
+                allocate(res, info);
+                if (data != nullptr) update(res, data, info);
+                return;
+            }
             glTexImage3D(kind, 0, info.iformat, info.width, info.height, info.length, 0, info.format, info.data_type, data);
+            if (data != nullptr) sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width * info.height * info.length));
         }
 
-        static inline void update (const void* data, const GLTextureInfo<kind>& info, int x = 0, int y = 0) {
-            glTexSubImage3D(kind, 0, x, y, info.width, info.height, info.length, info.format, info.data_type, data);
+        static inline void update (GLuint res, const void* data, const GLTextureInfo<kind>& info, int x = 0, int y = 0) {
+            if (directTexture<kind>()) glTextureSubImage3D(res, 0, x, y, 0, info.width, info.height, info.length, info.format, info.data_type, data);
+            else glTexSubImage3D(kind, 0, x, y, 0, info.width, info.height, info.length, info.format, info.data_type, data);
+            sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width * info.height * info.length));
         }
     };
 
     template <GLenum kind>
     struct GLTextureInterface<kind, traits::IfTex3D<kind>> {
+        static inline void allocate (GLuint res, const GLTextureInfo<kind>& info) {
+            GLsizei levels = textureLevels(info, std::max(info.width, std::max(info.height, info.depth)));
+            if (directTexture<kind>()) {
+                glTextureStorage3D(res, levels, traits::sizedFormat(info.iformat, info.data_type), info.width, info.height, info.depth);
+            } else if (SGL_TEXSTORAGE_SUPPORTED) {
+                glTexStorage3D(kind, levels, traits::sizedFormat(info.iformat, info.data_type), info.width, info.height, info.depth);
+            } else allocateMut(info);
+        }
 
+        static inline void allocateMut (const GLTextureInfo<kind>& info) {
+            glTexImage3D(kind, 0, info.iformat, info.width, info.height, info.depth, 0, info.format, info.data_type, NULL);
+        }
 
-        static inline void write (const void* data, const GLTextureInfo<kind>& info) {
+        static inline void write (GLuint res, const void* data, const GLTextureInfo<kind>& info) {
+            if (directTexture<kind>()) {
+                allocate(res, info);
+                if (data != nullptr) update(res, data, info);
+                return;
+            }
             glTexImage3D(kind, 0, info.iformat, info.width, info.height, info.depth, 0, info.format, info.data_type, data);
+            if (data != nullptr) sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width * info.height * info.depth));
         }
 
-        static inline void update (const void* data, const GLTextureInfo<kind>& info, int x = 0, int y = 0, int z = 0) {
-            glTexSubImage3D(kind, 0, x, y, z, info.width, info.height, info.depth, info.format, info.data_type, data);
+        static inline void update (GLuint res, const void* data, const GLTextureInfo<kind>& info, int x = 0, int y = 0, int z = 0) {
+            if (directTexture<kind>()) glTextureSubImage3D(res, 0, x, y, z, info.width, info.height, info.depth, info.format, info.data_type, data);
+            else glTexSubImage3D(kind, 0, x, y, z, info.width, info.height, info.depth, info.format, info.data_type, data);
+            sglCountTextureUpload(uploadSize(info.format, info.data_type, info.width * info.height * info.depth));
         }
     };
 
@@ -177,11 +261,19 @@ class Texture : public GLResource<kind> {
 private:
 
     void applyParams () {
-        glTexParameteri(kind, GL_TEXTURE_WRAP_S, attrs.wrap_s);
-        glTexParameteri(kind, GL_TEXTURE_WRAP_T, attrs.wrap_t);
-        glTexParameteri(kind, GL_TEXTURE_WRAP_R, attrs.wrap_r);
-        glTexParameteri(kind, GL_TEXTURE_MIN_FILTER, attrs.min_filter);
-        glTexParameteri(kind, GL_TEXTURE_MAG_FILTER, attrs.mag_filter);
+        if (detail::directTexture<kind>()) {
+            glTextureParameteri(this->_id, GL_TEXTURE_WRAP_S, attrs.wrap_s);
+            glTextureParameteri(this->_id, GL_TEXTURE_WRAP_T, attrs.wrap_t);
+            glTextureParameteri(this->_id, GL_TEXTURE_WRAP_R, attrs.wrap_r);
+            glTextureParameteri(this->_id, GL_TEXTURE_MIN_FILTER, attrs.min_filter);
+            glTextureParameteri(this->_id, GL_TEXTURE_MAG_FILTER, attrs.mag_filter);
+        } else {
+            glTexParameteri(kind, GL_TEXTURE_WRAP_S, attrs.wrap_s);
+            glTexParameteri(kind, GL_TEXTURE_WRAP_T, attrs.wrap_t);
+            glTexParameteri(kind, GL_TEXTURE_WRAP_R, attrs.wrap_r);
+            glTexParameteri(kind, GL_TEXTURE_MIN_FILTER, attrs.min_filter);
+            glTexParameteri(kind, GL_TEXTURE_MAG_FILTER, attrs.mag_filter);
+        }
     }
 
 public:
@@ -204,12 +296,14 @@ public:
         initialize(data, attrs, true);
     }
 
+    // With direct state access the texture is given immutable storage, so it
+    // can only be written once. The texture binding is left untouched.
     void initialize (const void * data, detail::GLTextureInfo<kind>& info, bool write = true) {
+        sglTraceScope("texture", "Texture::initialize");
         this->attrs = info;
-        this->bind();
-        if (write) detail::GLTextureInterface<kind>::write(data,attrs);
+        auto bg = sgl::bind_guard(*this, detail::directTexture<kind>());
+        if (write) detail::GLTextureInterface<kind>::write(this->_id, data, attrs);
         applyParams();
-        this->unbind();
         sglDbgCatchGLError();
     }
 };
@@ -227,7 +321,7 @@ using TextureCubeMap = Texture<GL_TEXTURE_CUBE_MAP>;
 * example:
 *
 *   sgl::Texture1D tex1d = sgl::TextureBuilder<GL_TEXTURE_1D>()
-*       .format(GL_R, GL_R8)
+*       .format(GL_RED, GL_R8)
 *       .build(1000);
 *
 *   sgl::Texture2D tex2d = sgl::TextureBuilder2D()
@@ -289,8 +383,9 @@ public:
     }
 
     Texture<kind> build (const char * imagename, TextureLoader loader, TextureFreer freer) {
+        sglTraceScope("texture", imagename);
         int width, height, channels;
-        GLuint formats[] = {GL_R, GL_RG, GL_RGB, GL_RGBA};
+        GLuint formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
         unsigned char* data = loader(imagename, &width, &height, &channels, 0);
         this->_info.format = formats[channels-1];
         this->_info.iformat = formats[channels-1];
@@ -345,6 +440,7 @@ public:
         _height = h;
         if (target == GL_DONT_CARE) target = GL_TEXTURE_CUBE_MAP_POSITIVE_X + _imageCount;
         glTexImage2D(target, 0, _info.iformat, w, h, 0, _info.format, _info.data_type, data);
+        if (data != nullptr) sglCountTextureUpload(detail::uploadSize(_info.format, _info.data_type, w * h));
         _imageCount += 1;
         return *this;
     }
@@ -362,9 +458,11 @@ public:
 
     TextureCubeMap build (TextureAccessor& loader, const char** paths, size_t len){
         for (size_t i = 0; i < len; i++){
+            sglTraceScope("texture", paths[i]);
             int w, h, c;
             unsigned char * data = loader.loader(paths[i], &w, &h, &c, 0);
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X+i, 0, _info.iformat, w, h, 0, _info.format, _info.data_type, data);
+            sglCountTextureUpload(detail::uploadSize(_info.format, _info.data_type, w * h));
             loader.freer(static_cast<void*>(data));
         }
         _result.unbind();
@@ -379,32 +477,32 @@ using TextureBuilderCubeMap = TextureBuilder<GL_TEXTURE_CUBE_MAP>;
 
 template <GLenum kind>
 void updateTexture (Texture<kind>& tex, const void * data) {
-    auto bg = sgl::bind_guard(tex);
-    detail::GLTextureInterface<kind>::update(data, tex.attrs);
+    auto bg = sgl::bind_guard(tex, detail::directTexture<kind>());
+    detail::GLTextureInterface<kind>::update(tex, data, tex.attrs);
     sglDbgCatchGLError();
 }
 
 template <GLenum kind>
 void updateTexture (Texture<kind>& tex, const void * data, int x) {
     static_assert(traits::IsTex1D<kind>::value, "Texture must be 1D");
-    auto bg = sgl::bind_guard(tex);
-    detail::GLTextureInterface<kind>::update(data, tex.attrs, x);
+    auto bg = sgl::bind_guard(tex, detail::directTexture<kind>());
+    detail::GLTextureInterface<kind>::update(tex, data, tex.attrs, x);
     sglDbgCatchGLError();
 }
 
 template <GLenum kind>
 void updateTexture (Texture<kind>& tex, const void * data, int x, int y) {
     static_assert(traits::IsTex2D<kind>::value, "Texture must be 2D");
-    auto bg = sgl::bind_guard(tex);
-    detail::GLTextureInterface<kind>::update(data, tex.attrs, x, y);
+    auto bg = sgl::bind_guard(tex, detail::directTexture<kind>());
+    detail::GLTextureInterface<kind>::update(tex, data, tex.attrs, x, y);
     sglDbgCatchGLError();
 }
 
 template <GLenum kind>
 void updateTexture (Texture<kind>& tex, const void * data, int x, int y, int z) {
     static_assert(traits::IsTex3D<kind>::value, "Texture must be 3D");
-    auto bg = sgl::bind_guard(tex);
-    detail::GLTextureInterface<kind>::update(data, tex.attrs, x, y, z);
+    auto bg = sgl::bind_guard(tex, detail::directTexture<kind>());
+    detail::GLTextureInterface<kind>::update(tex, data, tex.attrs, x, y, z);
     sglDbgCatchGLError();
 }
 
@@ -0,0 +1,223 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "sglconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+* Compile Time configuration flags:
+* SGL_TRACE        - 1 to emit trace spans from SimpleGL, 0 to compile them out
+* SGL_TRACE_EVENTS - Default capacity of a Tracer's ring, rounded up to a power of two
+* SGL_TRACE_NAME   - Characters of a span name kept, including the terminator
+*/
+#ifndef SGL_TRACE
+#   define SGL_TRACE 1
+#endif
+
+#ifndef SGL_TRACE_EVENTS
+#   define SGL_TRACE_EVENTS (1 << 16)
+#endif
+
+#ifndef SGL_TRACE_NAME
+#   define SGL_TRACE_NAME 48
+#endif
+
+namespace sgl {
+
+class GpuProfiler;
+
+// Thread id of GPU spans in the exported trace
+const uint32_t TRACE_GPU_THREAD = 0;
+
+struct TraceEvent {
+    char name[SGL_TRACE_NAME];
+    const char* category;   // Must outlive the tracer, normally a literal
+    const char* argName;    // Optional argument exported with the span, nullptr if none
+    uint64_t arg;
+    uint64_t beginNs;       // CPU clock, relative to the tracer's creation
+    uint64_t endNs;
+    uint64_t frame;
+    uint32_t thread;        // TRACE_GPU_THREAD for GPU spans
+};
+
+namespace detail {
+    // sequence is 2 * index + 2 once the event written for index is complete
+    struct TraceSlot {
+        std::atomic<uint64_t> sequence;
+        TraceEvent event;
+    };
+} // end namespace
+
+/**
+* Tracer records spans of CPU and GPU work into a fixed size ring and
+* exports them in the Chrome trace event format, viewable in about:tracing
+* or ui.perfetto.dev. Recording is lock free: any thread may record while
+* others do, and once the ring wraps the oldest spans are overwritten.
+*
+* Every span carries the index of the frame it was recorded in. endFrame()
+* closes a frame and records a span covering it, and GPU spans resolved by
+* a GpuProfiler can be imported with addGpuFrame, placed on the CPU
+* timeline by a calibrated clock offset.
+*
+* SimpleGL traces swapBuffers, shader compilation, texture builds and buffer
+* uploads into the tracer installed with sgl::setTracer (ContextBuilder::setTracer
+* installs one for you).
+*
+* ex:
+*
+*     sgl::Tracer tracer;
+*     sgl::setTracer(&tracer);
+*     while (running) {
+*         {
+*             sglTraceScope("app", "simulate");
+*             simulate();
+*         }
+*         render();
+*         tracer.addGpuFrame(profiler);
+*         tracer.endFrame();
+*     }
+*     tracer.save("frames.json");
+*/
+class Tracer {
+public:
+    // Records a span from its creation to its destruction
+    class Span {
+    private:
+        Tracer* _tracer;
+        const char* _category;
+        const char* _name;
+        const char* _argName;
+        uint64_t _arg;
+        uint64_t _begin;
+    public:
+        Span (Tracer* tracer, const char* category, const char* name, const char* argName = nullptr, uint64_t arg = 0) :
+            _tracer(tracer),
+            _category(category),
+            _name(name),
+            _argName(argName),
+            _arg(arg),
+            _begin(tracer != nullptr ? tracer->now() : 0)
+        {}
+
+        Span (Span&& other) :
+            _tracer(other._tracer),
+            _category(other._category),
+            _name(other._name),
+            _argName(other._argName),
+            _arg(other._arg),
+            _begin(other._begin)
+        {
+            other._tracer = nullptr;
+        }
+
+        Span (const Span&) = delete;
+
+        ~Span () {
+            if (_tracer != nullptr) _tracer->record(_category, _name, _begin, _tracer->now(), _argName, _arg);
+        }
+    };
+
+private:
+    std::unique_ptr<detail::TraceSlot[]> _slots;
+    size_t _mask;
+    std::atomic<uint64_t> _head;        // Next index to write
+    std::atomic<uint64_t> _tail;        // Indices below were cleared
+    std::atomic<uint64_t> _frame;
+    std::atomic<uint64_t> _frameBegin;
+    uint64_t _epoch;                    // steady_clock nanoseconds at creation
+    int64_t _gpuOffset;                 // Added to GPU timestamps to get tracer time
+    uint64_t _gpuFrame;                 // Next GpuProfiler frame to import
+    bool _calibrated;
+
+public:
+    Tracer (size_t capacity = SGL_TRACE_EVENTS);
+
+    Tracer (const Tracer&) = delete;
+    Tracer& operator= (const Tracer&) = delete;
+
+    // Nanoseconds since the tracer was created
+    uint64_t now () const;
+
+    // Record a finished span on the calling thread. name is copied, category and argName are not.
+    void record (const char* category, const char* name, uint64_t beginNs, uint64_t endNs,
+                 const char* argName = nullptr, uint64_t arg = 0);
+
+    void record (const char* category, const char* name, uint64_t beginNs, uint64_t endNs,
+                 const char* argName, uint64_t arg, uint32_t thread, uint64_t frame);
+
+    Span span (const char* category, const char* name, const char* argName = nullptr, uint64_t arg = 0) {
+        return Span(this, category, name, argName, arg);
+    }
+
+    // Record a span covering the frame and start the next one
+    void endFrame ();
+
+    // Import the scopes of profiler's most recently resolved frame, once.
+    // Calibrates the GPU clock on first use; needs the context current.
+    void addGpuFrame (const GpuProfiler& profiler);
+
+    // Measure the offset between the GPU and CPU clocks. Needs the context current.
+    void calibrateGpuClock ();
+
+    // Recorded spans, oldest first. Spans being written concurrently are skipped.
+    std::vector<TraceEvent> events () const;
+
+    // Write the recorded spans as Chrome trace event JSON
+    void write (std::ostream& out) const;
+
+    // Write the trace to path. Throws std::runtime_error if the file can't be written.
+    void save (const std::string& path) const;
+
+    // Forget recorded spans. Frame numbering continues.
+    void clear ();
+
+    uint64_t frame () const { return _frame.load(std::memory_order_relaxed); }
+
+    size_t capacity () const { return _mask + 1; }
+
+    // Spans overwritten before they were exported
+    uint64_t dropped () const;
+};
+
+namespace detail {
+    extern std::atomic<Tracer*> __sglTracer;
+
+    inline Tracer* currentTracer () {
+        return __sglTracer.load(std::memory_order_acquire);
+    }
+} // end namespace
+
+// Small id of the calling thread, as exported in traces. Never TRACE_GPU_THREAD.
+uint32_t traceThread ();
+
+// Tracer receiving SimpleGL's spans and sglTraceScope, from every thread. nullptr disables tracing.
+inline void setTracer (Tracer* tracer) {
+    detail::__sglTracer.store(tracer, std::memory_order_release);
+}
+
+inline Tracer* getTracer () {
+    return detail::currentTracer();
+}
+
+} // end namespace
+
+#define SGL_TRACE_CONCAT_(a,b) a##b
+#define SGL_TRACE_CONCAT(a,b) SGL_TRACE_CONCAT_(a,b)
+
+#if SGL_TRACE
+    // Trace the rest of the enclosing block into the installed tracer, if any
+#   define sglTraceScope(category, name) sgl::Tracer::Span SGL_TRACE_CONCAT(__sglTraceSpan, __LINE__)(sgl::getTracer(), category, name)
+#   define sglTraceScopeArg(category, name, argName, arg) sgl::Tracer::Span SGL_TRACE_CONCAT(__sglTraceSpan, __LINE__)(sgl::getTracer(), category, name, argName, arg)
+#else
+#   define sglTraceScope(category, name)
+#   define sglTraceScopeArg(category, name, argName, arg)
+#endif
+
+#endif // TRACE_H
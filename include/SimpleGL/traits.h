@@ -4,6 +4,7 @@
 
 #include <type_traits>
 #include <array>
+#include <cstdint>
 #include <stdint.h>
 
 #ifdef SGL_USE_GLM
@@ -309,6 +310,12 @@ namespace traits {
     template <GLenum v, class T = GLenum>
     using IfTex3D = typename std::enable_if<traits::IsTex3D<v>::value, T>::type;
 
+    // Texture targets accepted by glCreateTextures. Cube map faces and proxies are not.
+    template <GLenum V>
+    using IsDSATexture = traits::one_of_v<GLenum, V,
+        GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_RECTANGLE,
+        GL_TEXTURE_CUBE_MAP, GL_TEXTURE_3D>;
+
     template <GLenum V>
     using IsWritable = traits::eval<IsBuffer<V>::value || IsTexture<V>::value>;
 
@@ -392,6 +399,9 @@ namespace traits {
     template <class T>
     struct GLType<T[]>{ const static GLenum type = GLType<T>::type; };
 
+    template <class T, size_t N>
+    struct GLType<T[N]>{ const static GLenum type = GLType<T>::type; };
+
     // Handle Pointers
     template <class T>
     struct GLType<T*>{ const static GLenum type = GLType<T>::type; };
@@ -480,6 +490,10 @@ namespace traits {
     // Needed to support runtime in C++11. With C++14 we could reduce these both to a constexpr
     size_t formatSize (GLenum fmt);
 
+    // Sized internal format for an unsized one, as required by glTexStorage*.
+    // Already sized formats are returned unchanged.
+    GLenum sizedFormat (GLenum iformat, GLenum dataType);
+
 } // namespace
 } // namespace
 
@@ -0,0 +1,107 @@
+#ifndef UNIFORMARENA_H
+#define UNIFORMARENA_H
+
+#include "sglconfig.h"
+#include "allocator.h"
+#include "streambuffer.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace sgl {
+
+// A slice of a UniformArena's current frame
+struct UniformSlot {
+    size_t offset;
+    size_t size;
+};
+
+struct UniformArenaStats {
+    uint64_t slots;   // Slots pushed
+    uint64_t uploads; // Frames uploaded
+    uint64_t bytes;   // Bytes uploaded, including alignment padding
+    uint64_t grows;   // Times the buffer was reallocated
+};
+
+/**
+* UniformArena packs the uniform blocks of every draw in a frame into one
+* buffer. Values are pushed into a client side staging area at offsets
+* aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, upload copies the whole
+* frame into a StreamBuffer region with a single write, and each draw binds
+* its slice with glBindBufferRange. N per draw uploads become one.
+*
+* Slots are valid from upload until the next upload. If a frame needs more
+* room than the arena has, the buffer is reallocated at upload.
+*
+* ex:
+*
+*     sgl::UniformArena arena;
+*     std::vector<sgl::UniformSlot> slots;
+*     for (auto& obj : objects) slots.push_back(arena.push(obj.constants));
+*     arena.upload();
+*
+*     shader.setUniformBlock("Object", arena, slots[0], 0); // Once, sets the block binding
+*     for (size_t i = 0; i < objects.size(); i++) {
+*         arena.bind(slots[i], 0);
+*         draw(objects[i]);
+*     }
+*/
+class UniformArena {
+private:
+    StreamBuffer<GL_UNIFORM_BUFFER, char> _buffer;
+    std::vector<char> _staging;
+    size_t _alignment;
+    size_t _regions;
+    size_t _base;
+    UniformArenaStats _stats;
+
+public:
+    // capacity bytes per frame, regions frames in flight
+    UniformArena (size_t capacity = 64 * 1024, size_t regions = 3);
+
+    UniformArena (const UniformArena&) = delete;
+    UniformArena& operator= (const UniformArena&) = delete;
+
+    // Copy size bytes of data into the next aligned slot
+    UniformSlot push (const void* data, size_t size);
+
+    template <class T>
+    UniformSlot push (const T& value) {
+        return push(&value, sizeof(T));
+    }
+
+    // Reserve an aligned slot and return a pointer to fill it in place.
+    // The pointer is invalidated by the next push.
+    template <class T>
+    T* emplace (UniformSlot& slot) {
+        slot = push(nullptr, sizeof(T));
+        return reinterpret_cast<T*>(&_staging[slot.offset]);
+    }
+
+    // Copy every slot pushed since the last upload to the GPU
+    void upload ();
+
+    // Bind slot to uniform buffer binding point unit
+    void bind (const UniformSlot& slot, GLuint unit);
+
+    // Offset of slot from the start of the buffer, for glBindBufferRange
+    size_t offset (const UniformSlot& slot) const { return _base + slot.offset; }
+
+    GLuint buffer () const { return _buffer; }
+    operator GLResource<GL_UNIFORM_BUFFER> () const { return _buffer; }
+
+    size_t alignment () const { return _alignment; }
+    size_t capacity () const { return _buffer.regionSize(); }
+
+    // Bytes pushed since the last upload
+    size_t pending () const { return _staging.size(); }
+
+    const UniformArenaStats& stats () const { return _stats; }
+
+    void release ();
+};
+
+} // end namespace
+
+#endif // UNIFORMARENA_H
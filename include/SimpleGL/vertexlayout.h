@@ -0,0 +1,211 @@
+#ifndef VERTEXLAYOUT_H
+#define VERTEXLAYOUT_H
+
+#include "sglconfig.h"
+#include "traits.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+* Compile Time configuration flags:
+* SGL_MAX_VERTEX_ATTRIBS   - Attributes (and buffer bindings) a single VertexLayout can hold
+* SGL_VERTEX_LAYOUT_CACHE  - Vertex arrays whose layout is remembered per thread
+*/
+#ifndef SGL_MAX_VERTEX_ATTRIBS
+#   define SGL_MAX_VERTEX_ATTRIBS 16
+#endif
+
+#ifndef SGL_VERTEX_LAYOUT_CACHE
+#   define SGL_VERTEX_LAYOUT_CACHE 64
+#endif
+
+namespace sgl {
+
+namespace detail {
+    // One glVertexAttribFormat + glVertexAttribBinding
+    struct VertexAttrib {
+        GLenum type;
+        GLuint offset;     // Relative to the start of a vertex
+        GLuint components;
+        GLuint attrib;     // Attribute location
+        GLuint binding;    // Buffer binding index
+    };
+
+    // One glBindVertexBuffer + glVertexBindingDivisor
+    struct VertexBinding {
+        GLuint buffer;
+        GLuint index;      // Binding index, the location of the buffer's first attribute
+        size_t offset;     // Byte offset of the first vertex in buffer
+        GLsizei stride;
+        GLuint divisor;
+    };
+
+    const GLuint NO_BINDING = 0xffffffff;
+} // end namespace
+
+/**
+* VertexLayout is the complete description of a vertex array: attribute
+* formats, which buffer binding each attribute reads from, and the buffers
+* bound to them. It is a fixed size value, so building one never allocates.
+*
+* The format half (everything but buffer names and offsets) is hashed. A
+* vertex array committed again with a layout of the same hash only has its
+* buffers rebound, so swapping buffers under a vertex array is cheap.
+*/
+struct VertexLayout {
+    detail::VertexAttrib attribs[SGL_MAX_VERTEX_ATTRIBS];
+    detail::VertexBinding bindings[SGL_MAX_VERTEX_ATTRIBS];
+    uint32_t attribCount;
+    uint32_t bindingCount;
+
+    // Hash of the attribute formats, binding indices, strides and divisors
+    uint64_t hash () const;
+};
+
+namespace detail {
+    // Specify layout on vao. On OpenGL 4.3 formats are only specified when
+    // the vertex array's cached layout hash differs, buffers are always
+    // rebound. Older versions fall back to glVertexAttribPointer.
+    void applyVertexLayout (GLuint vao, GLuint ebo, const VertexLayout& layout);
+
+    // Returns true if vao was last specified with a layout of hash on this
+    // thread, otherwise records hash as its layout.
+    bool vertexLayoutCached (GLuint vao, uint64_t hash);
+
+    // Forget deleted vertex arrays, whose names may be reused
+    void forgetVertexLayouts (size_t len, const GLuint* ids);
+} // end namespace
+
+// Forget every cached layout. Call after specifying vertex arrays with raw OpenGL.
+void invalidateVertexLayoutCache ();
+
+namespace detail {
+    // Format of one field of a vertex struct
+    struct FieldFormat {
+        GLenum type;
+        GLuint offset;
+        GLuint components;
+    };
+
+    // Specify count fields read from vbo, with attribute locations
+    // firstAttrib.. and binding index firstAttrib
+    void applyVertexFormat (GLuint vao, GLuint ebo, GLuint vbo, size_t offset, GLsizei stride, GLuint div,
+                            GLuint firstAttrib, const FieldFormat* fields, size_t count, uint64_t hash);
+
+    template <class ...Fs>
+    struct fields_ordered;
+
+    template <class F, class F2, class ...Fs>
+    struct fields_ordered<F,F2,Fs...> {
+        static const bool value = F::end <= F2::offset && fields_ordered<F2,Fs...>::value;
+    };
+
+    template <class F>
+    struct fields_ordered<F> {
+        static const bool value = true;
+    };
+
+    template <class ...Fs>
+    struct fields_hash;
+
+    template <class F, class ...Fs>
+    struct fields_hash<F,Fs...> {
+        static const uint64_t value = (fields_hash<Fs...>::value * 1099511628211ULL) ^
+                                      ((uint64_t(F::glType) << 40) | (uint64_t(F::offset) << 8) | F::components);
+    };
+
+    template <>
+    struct fields_hash<> {
+        static const uint64_t value = 14695981039346656037ULL;
+    };
+} // end namespace
+
+/**
+* Compile time description of a member of a vertex struct. T is the type
+* GLSL reads it as, which must have the size of the member.
+*/
+template <class T, size_t off>
+struct VertexField {
+    using type = T;
+    using component = typename traits::CType<traits::GLType<T>::type>::type;
+
+    static const GLenum glType = traits::GLType<T>::type;
+    static const GLuint offset = off;
+    static const GLuint components = sizeof(T) / sizeof(component);
+    static const size_t end = off + sizeof(T);
+
+    static_assert(sizeof(T) % sizeof(component) == 0, "Vertex field isn't a whole number of components");
+    static_assert(components >= 1 && components <= 4, "Vertex fields have 1 to 4 components");
+
+    static constexpr detail::FieldFormat field () { return { glType, offset, components }; }
+};
+
+/**
+* The layout of vertex struct V, as the list of its VertexFields in
+* declaration order. Offsets, component counts, GL types and the stride are
+* compile time constants, checked against sizeof(V), and fields is a
+* constexpr array that applyVertexFormat walks directly.
+*/
+template <class V, class ...Fs>
+struct VertexFields {
+    static_assert(sizeof...(Fs) <= SGL_MAX_VERTEX_ATTRIBS, "Vertex struct has more fields than SGL_MAX_VERTEX_ATTRIBS");
+    static_assert(traits::param_size<typename Fs::type...>::size == sizeof(V), "Vertex fields must cover the whole vertex struct, including padding");
+    static_assert(detail::fields_ordered<Fs...>::value, "Vertex fields must be listed in declaration order without overlapping");
+
+    static const size_t count = sizeof...(Fs);
+    static const GLsizei stride = sizeof(V);
+    static constexpr detail::FieldFormat fields[sizeof...(Fs)] = { Fs::field()... };
+
+    // Identifies the format in the layout cache
+    static const uint64_t hash = (detail::fields_hash<Fs...>::value * 1099511628211ULL) ^ sizeof(V);
+};
+
+template <class V, class ...Fs>
+constexpr detail::FieldFormat VertexFields<V,Fs...>::fields[sizeof...(Fs)];
+
+namespace traits {
+    // Specialize, deriving from VertexFields, to describe a vertex struct
+    template <class V>
+    struct VertexFormat;
+} // end namespace
+
+/**
+* Specify the layout of vertex struct V, described by traits::VertexFormat<V>,
+* on vao. Attributes take locations firstAttrib.. in field order and read
+* from vbo starting offset bytes in. Like VertexAttribBuilder::commit,
+* formats are only specified when the vertex array's cached layout differs.
+*
+* ex:
+*
+*     struct Vertex { float position[3]; float uv[2]; };
+*     SGL_VERTEX_FORMAT(Vertex,
+*         SGL_VERTEX_FIELD(Vertex, position),
+*         SGL_VERTEX_FIELD(Vertex, uv));
+*
+*     sgl::applyVertexFormat<Vertex>(vao, vbo, ebo);
+*/
+template <class V>
+void applyVertexFormat (GLuint vao, GLuint vbo, GLuint ebo = 0, size_t offset = 0, GLuint firstAttrib = 0, GLuint div = 0) {
+    using Format = traits::VertexFormat<V>;
+    uint64_t hash = Format::hash ^ ((uint64_t(firstAttrib) << 32 | div) * 1099511628211ULL);
+    detail::applyVertexFormat(vao, ebo, vbo, offset, Format::stride, div, firstAttrib, Format::fields, Format::count, hash);
+}
+
+} // end namespace
+
+// Field member of struct V, read as the member's own type
+#define SGL_VERTEX_FIELD(V, member) \
+    sgl::VertexField<decltype(V::member), offsetof(V, member)>
+
+// Field member of struct V, read as type T (eg. sgl::vec3f for a glm::vec3)
+#define SGL_VERTEX_FIELD_AS(V, member, T) \
+    sgl::VertexField<T, offsetof(V, member)>
+
+// Describe vertex struct V. Use at global scope.
+#define SGL_VERTEX_FORMAT(V, ...) \
+    namespace sgl { namespace traits { \
+        template <> struct VertexFormat<V> : sgl::VertexFields<V, __VA_ARGS__> {}; \
+    }}
+
+#endif // VERTEXLAYOUT_H
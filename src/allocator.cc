@@ -0,0 +1,115 @@
+#include <SimpleGL/allocator.h>
+
+#include <iterator>
+#include <stdexcept>
+
+using namespace sgl;
+
+RangeAllocator::RangeAllocator (size_t capacity) :
+    _capacity(0),
+    _used(0)
+{
+    grow(capacity);
+}
+
+void RangeAllocator::insertFree (size_t offset, size_t size) {
+    if (size == 0) return;
+    auto next = _free.lower_bound(offset);
+
+    // Merge with the following block
+    if (next != _free.end() && offset + size == next->first) {
+        size += next->second;
+        next = _free.erase(next);
+    }
+
+    // Merge with the preceding block
+    if (next != _free.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            prev->second += size;
+            return;
+        }
+    }
+    _free.emplace_hint(next, offset, size);
+}
+
+size_t RangeAllocator::allocate (size_t size, size_t alignment) {
+    if (size == 0) return npos;
+
+    auto best = _free.end();
+    size_t bestLeftover = npos;
+    for (auto it = _free.begin(); it != _free.end(); it++) {
+        size_t aligned = detail::alignUp(it->first, alignment);
+        size_t pad = aligned - it->first;
+        if (pad + size > it->second) continue;
+        size_t leftover = it->second - pad - size;
+        if (leftover < bestLeftover) {
+            best = it;
+            bestLeftover = leftover;
+            if (leftover == 0) break;
+        }
+    }
+    if (best == _free.end()) return npos;
+
+    size_t blockOffset = best->first;
+    size_t offset = detail::alignUp(blockOffset, alignment);
+    _free.erase(best);
+
+    if (offset > blockOffset) _free.emplace(blockOffset, offset - blockOffset);
+    if (bestLeftover > 0) _free.emplace(offset + size, bestLeftover);
+
+    _allocations[offset] = Allocation{size, alignment};
+    _used += size;
+    return offset;
+}
+
+void RangeAllocator::free (size_t offset) {
+    auto it = _allocations.find(offset);
+    if (it == _allocations.end()) {
+        throw std::runtime_error("RangeAllocator: free of unallocated offset");
+    }
+    size_t size = it->second.size;
+    _allocations.erase(it);
+    _used -= size;
+    insertFree(offset, size);
+}
+
+void RangeAllocator::grow (size_t capacity) {
+    if (capacity <= _capacity) return;
+    insertFree(_capacity, capacity - _capacity);
+    _capacity = capacity;
+}
+
+std::vector<RangeMove> RangeAllocator::defragment () {
+    std::vector<RangeMove> moves;
+    std::map<size_t, Allocation> packed;
+    size_t cursor = 0;
+
+    _free.clear();
+    for (const auto& entry : _allocations) {
+        size_t offset = detail::alignUp(cursor, entry.second.alignment);
+        if (offset > cursor) _free.emplace(cursor, offset - cursor);
+        if (offset != entry.first) moves.push_back(RangeMove{entry.first, offset, entry.second.size});
+        packed.emplace_hint(packed.end(), offset, entry.second);
+        cursor = offset + entry.second.size;
+    }
+    if (cursor < _capacity) _free.emplace(cursor, _capacity - cursor);
+
+    _allocations.swap(packed);
+    return moves;
+}
+
+void RangeAllocator::reset () {
+    _allocations.clear();
+    _free.clear();
+    _used = 0;
+    if (_capacity > 0) _free.emplace(0, _capacity);
+}
+
+size_t RangeAllocator::largestFree () const {
+    size_t largest = 0;
+    for (const auto& block : _free) {
+        if (block.second > largest) largest = block.second;
+    }
+    return largest;
+}
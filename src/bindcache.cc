@@ -0,0 +1,147 @@
+#include <SimpleGL/bindcache.h>
+
+#include <string.h>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+thread_local BindCache* sgl::detail::__sglBindCache = nullptr;
+thread_local GLuint sgl::detail::__sglDefaultFramebuffer = 0;
+
+GLenum sgl::detail::bindingQuery (int slot) {
+    switch (slot) {
+    case SLOT_ARRAY_BUFFER:              return GL_ARRAY_BUFFER_BINDING;
+    case SLOT_ELEMENT_ARRAY_BUFFER:      return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+    case SLOT_COPY_READ_BUFFER:          return GL_COPY_READ_BUFFER_BINDING;
+    case SLOT_COPY_WRITE_BUFFER:         return GL_COPY_WRITE_BUFFER_BINDING;
+    case SLOT_PIXEL_PACK_BUFFER:         return GL_PIXEL_PACK_BUFFER_BINDING;
+    case SLOT_PIXEL_UNPACK_BUFFER:       return GL_PIXEL_UNPACK_BUFFER_BINDING;
+    case SLOT_QUERY_BUFFER:              return GL_QUERY_BUFFER_BINDING;
+    case SLOT_TEXTURE_BUFFER:            return GL_TEXTURE_BUFFER_BINDING;
+    case SLOT_TRANSFORM_FEEDBACK_BUFFER: return GL_TRANSFORM_FEEDBACK_BUFFER_BINDING;
+    case SLOT_DRAW_INDIRECT_BUFFER:      return GL_DRAW_INDIRECT_BUFFER_BINDING;
+    case SLOT_ATOMIC_COUNTER_BUFFER:     return GL_ATOMIC_COUNTER_BUFFER_BINDING;
+    case SLOT_DISPATCH_INDIRECT_BUFFER:  return GL_DISPATCH_INDIRECT_BUFFER_BINDING;
+    case SLOT_SHADER_STORAGE_BUFFER:     return GL_SHADER_STORAGE_BUFFER_BINDING;
+    case SLOT_UNIFORM_BUFFER:            return GL_UNIFORM_BUFFER_BINDING;
+    case SLOT_DRAW_FRAMEBUFFER:          return GL_DRAW_FRAMEBUFFER_BINDING;
+    case SLOT_READ_FRAMEBUFFER:          return GL_READ_FRAMEBUFFER_BINDING;
+    case SLOT_RENDERBUFFER:              return GL_RENDERBUFFER_BINDING;
+    case SLOT_VERTEX_ARRAY:              return GL_VERTEX_ARRAY_BINDING;
+    case SLOT_PROGRAM:                   return GL_CURRENT_PROGRAM;
+    case SLOT_TEXTURE_1D:                return GL_TEXTURE_BINDING_1D;
+    case SLOT_TEXTURE_2D:                return GL_TEXTURE_BINDING_2D;
+    case SLOT_TEXTURE_3D:                return GL_TEXTURE_BINDING_3D;
+    case SLOT_TEXTURE_RECTANGLE:         return GL_TEXTURE_BINDING_RECTANGLE;
+    case SLOT_TEXTURE_CUBE_MAP:          return GL_TEXTURE_BINDING_CUBE_MAP;
+    case SLOT_TEXTURE_1D_ARRAY:          return GL_TEXTURE_BINDING_1D_ARRAY;
+    case SLOT_TEXTURE_2D_ARRAY:          return GL_TEXTURE_BINDING_2D_ARRAY;
+    case SLOT_TEXTURE_CUBE_MAP_ARRAY:    return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
+    case SLOT_TEXTURE_2D_MULTISAMPLE:    return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
+    case SLOT_TEXTURE_2D_MULTISAMPLE_ARRAY: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
+    default:                             return GL_NONE;
+    }
+}
+
+BindCache::BindCache (bool validate) :
+    validate(validate)
+{
+    memset(&_frame, 0, sizeof(_frame));
+    memset(&_lastFrame, 0, sizeof(_lastFrame));
+    invalidate();
+}
+
+bool BindCache::validateSlot (int slot, GLuint res) {
+    GLint actual = 0;
+    glGetIntegerv(detail::bindingQuery(slot), &actual);
+    if (slot == detail::SLOT_DRAW_FRAMEBUFFER || slot == detail::SLOT_READ_FRAMEBUFFER) res = detail::framebufferName(res);
+    if (static_cast<GLuint>(actual) == res) return true;
+
+    _frame.mismatches += 1;
+    sglDbgPrint("BindCache mismatch: binding 0x%x is %d, cache expected %d\n", detail::bindingQuery(slot), actual, res);
+    return false;
+}
+
+void BindCache::note (GLenum kind, GLuint res) {
+    int slot = detail::bindSlot(kind);
+    if (slot == detail::SLOT_NONE) return;
+    if (slot == detail::SLOT_FRAMEBUFFER) {
+        _bound[detail::SLOT_DRAW_FRAMEBUFFER] = res;
+        _bound[detail::SLOT_READ_FRAMEBUFFER] = res;
+        return;
+    }
+    GLuint* bound = slotPtr(slot);
+    if (bound != nullptr) *bound = res;
+    if (slot == detail::SLOT_VERTEX_ARRAY) _bound[detail::SLOT_ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+}
+
+void BindCache::forget (GLenum kind, size_t len, const GLuint* ids) {
+    int slot = detail::bindSlot(kind);
+    if (slot == detail::SLOT_NONE) return;
+
+    // Object names are per type, so only clear the binding points of the same type.
+    int first = slot, last = slot;
+    if (slot <= detail::SLOT_UNIFORM_BUFFER) {
+        first = detail::SLOT_ARRAY_BUFFER;
+        last = detail::SLOT_UNIFORM_BUFFER;
+    } else if (slot == detail::SLOT_FRAMEBUFFER || slot == detail::SLOT_DRAW_FRAMEBUFFER || slot == detail::SLOT_READ_FRAMEBUFFER) {
+        first = detail::SLOT_DRAW_FRAMEBUFFER;
+        last = detail::SLOT_READ_FRAMEBUFFER;
+    } else if (slot >= detail::SLOT_GLOBAL_COUNT) {
+        first = detail::SLOT_GLOBAL_COUNT;
+        last = detail::SLOT_COUNT - 1;
+    } else if (slot == detail::SLOT_PROGRAM) {
+        // Deleting the current program is deferred until it is no longer in use
+        return;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        for (int s = first; s <= last; s++) {
+            if (s < detail::SLOT_GLOBAL_COUNT) {
+                if (_bound[s] != ids[i]) continue;
+                _bound[s] = UNKNOWN;
+                if (s == detail::SLOT_VERTEX_ARRAY) _bound[detail::SLOT_ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+            } else {
+                for (size_t unit = 0; unit < SGL_BINDCACHE_TEXTURE_UNITS; unit++) {
+                    GLuint& bound = _textures[unit][s - detail::SLOT_GLOBAL_COUNT];
+                    if (bound == ids[i]) bound = UNKNOWN;
+                }
+            }
+        }
+    }
+}
+
+void BindCache::invalidate () {
+    for (int i = 0; i < detail::SLOT_GLOBAL_COUNT; i++) _bound[i] = UNKNOWN;
+    for (size_t unit = 0; unit < SGL_BINDCACHE_TEXTURE_UNITS; unit++) {
+        for (int i = 0; i < detail::SLOT_TEXTURE_COUNT; i++) _textures[unit][i] = UNKNOWN;
+    }
+    _activeUnit = 0;
+    _activeUnitKnown = false;
+}
+
+void BindCache::invalidate (GLenum kind) {
+    int slot = detail::bindSlot(kind);
+    if (slot == detail::SLOT_NONE) return;
+    if (slot == detail::SLOT_FRAMEBUFFER) {
+        _bound[detail::SLOT_DRAW_FRAMEBUFFER] = UNKNOWN;
+        _bound[detail::SLOT_READ_FRAMEBUFFER] = UNKNOWN;
+    } else if (slot < detail::SLOT_GLOBAL_COUNT) {
+        _bound[slot] = UNKNOWN;
+        if (slot == detail::SLOT_VERTEX_ARRAY) _bound[detail::SLOT_ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+    } else {
+        for (size_t unit = 0; unit < SGL_BINDCACHE_TEXTURE_UNITS; unit++) {
+            _textures[unit][slot - detail::SLOT_GLOBAL_COUNT] = UNKNOWN;
+        }
+    }
+}
+
+void BindCache::endFrame () {
+    _lastFrame = _frame;
+    memset(&_frame, 0, sizeof(_frame));
+}
+
+void sgl::setBindCache (BindCache* cache) {
+    detail::__sglBindCache = cache;
+    if (cache != nullptr) cache->invalidate();
+}
@@ -0,0 +1,317 @@
+#include <SimpleGL/commandlist.h>
+#include <SimpleGL/bindcache.h>
+#include <SimpleGL/utils.h>
+
+#include <string.h>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+// Number of floats stored per uniform command
+static const size_t __uniformSize[] = { 1, 1, 2, 3, 4, 9, 16 };
+
+static inline bool isUniform (uint16_t op) {
+    return op >= CMD_UNIFORM_1I && op <= CMD_UNIFORM_MAT4;
+}
+
+// Targets bindTarget binds with glBindTexture
+static inline bool isTextureTarget (GLenum target) {
+    int slot = detail::bindSlot(target);
+    return slot == SLOT_NONE || (slot >= SLOT_GLOBAL_COUNT && slot < SLOT_COUNT);
+}
+
+static inline uint32_t narrow (size_t value) {
+    if (value > 0xffffffff) throw std::runtime_error("CommandList: offsets and sizes must fit 32 bits");
+    return static_cast<uint32_t>(value);
+}
+
+void sgl::detail::bindTarget (GLenum target, GLuint name) {
+    BindCache* cache = detail::currentBindCache();
+    if (cache != nullptr && cache->elide(target, name)) return;
+
+    switch (target) {
+    case GL_FRAMEBUFFER:
+    case GL_DRAW_FRAMEBUFFER:
+    case GL_READ_FRAMEBUFFER: glBindFramebuffer(target, detail::framebufferName(name)); break;
+    case GL_RENDERBUFFER:     glBindRenderbuffer(target, name); break;
+    case GL_VERTEX_ARRAY:     glBindVertexArray(name); break;
+    case GL_PROGRAM:          glUseProgram(name); break;
+    default: {
+        // Anything that isn't a known buffer target is a texture
+        int slot = detail::bindSlot(target);
+        if (slot >= SLOT_ARRAY_BUFFER && slot <= SLOT_UNIFORM_BUFFER) glBindBuffer(target, name);
+        else glBindTexture(target, name);
+        break;
+    }
+    }
+    sglCountBind(target);
+    sglDbgLogBind(target, name);
+}
+
+CommandList::CommandList () :
+    _program(0),
+    _ended(false)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+Command& CommandList::push (CommandOp op) {
+    _ended = false;
+    _stats.recorded += 1;
+    Command cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.op = op;
+    _commands.push_back(cmd);
+    return _commands.back();
+}
+
+void CommandList::bind (GLenum target, GLuint name) {
+    Command& cmd = push(CMD_BIND);
+    cmd.target = target;
+    cmd.name = name;
+    if (target == GL_PROGRAM) _program = name;
+}
+
+void CommandList::texture (GLuint unit, GLenum target, GLuint name) {
+    Command& cmd = push(CMD_TEXTURE);
+    cmd.unit = unit;
+    cmd.target = target;
+    cmd.name = name;
+}
+
+void CommandList::uniform (CommandOp op, Shader& shader, const char* id, const float* values, size_t count) {
+    GLint loc = glGetUniformLocation(shader, id);
+    if (loc == -1) return;
+    if (_program != static_cast<GLuint>(shader)) bind(shader);
+
+    Command& cmd = push(op);
+    cmd.name = shader;
+    cmd.location = loc;
+    cmd.args[0] = narrow(_data.size());
+    _data.insert(_data.end(), values, values + count);
+}
+
+void CommandList::uniform (Shader& shader, const char* id, int v) {
+    // Stored as float bits so all uniform values share one array
+    float bits;
+    memcpy(&bits, &v, sizeof(bits));
+    uniform(CMD_UNIFORM_1I, shader, id, &bits, 1);
+}
+
+void CommandList::uniform (Shader& shader, const char* id, float v) {
+    uniform(CMD_UNIFORM_1F, shader, id, &v, 1);
+}
+
+void CommandList::uniform (Shader& shader, const char* id, float x, float y) {
+    float v[2] = {x, y};
+    uniform(CMD_UNIFORM_2F, shader, id, v, 2);
+}
+
+void CommandList::uniform (Shader& shader, const char* id, float x, float y, float z) {
+    float v[3] = {x, y, z};
+    uniform(CMD_UNIFORM_3F, shader, id, v, 3);
+}
+
+void CommandList::uniform (Shader& shader, const char* id, float x, float y, float z, float w) {
+    float v[4] = {x, y, z, w};
+    uniform(CMD_UNIFORM_4F, shader, id, v, 4);
+}
+
+void CommandList::uniformMatrix3 (Shader& shader, const char* id, const float* matrix) {
+    uniform(CMD_UNIFORM_MAT3, shader, id, matrix, 9);
+}
+
+void CommandList::uniformMatrix4 (Shader& shader, const char* id, const float* matrix) {
+    uniform(CMD_UNIFORM_MAT4, shader, id, matrix, 16);
+}
+
+void CommandList::bindRange (GLenum target, GLuint buffer, GLuint unit, size_t offset, size_t size) {
+    Command& cmd = push(CMD_BUFFER_RANGE);
+    cmd.target = target;
+    cmd.name = buffer;
+    cmd.unit = unit;
+    cmd.args[0] = narrow(offset);
+    cmd.args[1] = narrow(size);
+}
+
+void CommandList::uniformBlock (Shader& shader, const char* id, GLResource<GL_UNIFORM_BUFFER>& buffer, GLuint unit, size_t offset, size_t size) {
+    // The block binding is program state, so it is set now rather than every replay
+    GLuint idx = glGetUniformBlockIndex(shader, id);
+    if (idx == GL_INVALID_INDEX) return;
+    glUniformBlockBinding(shader, idx, unit);
+    bindRange(GL_UNIFORM_BUFFER, buffer, unit, offset, size);
+}
+
+void CommandList::viewport (GLint x, GLint y, GLsizei width, GLsizei height) {
+    Command& cmd = push(CMD_VIEWPORT);
+    cmd.args[0] = x;
+    cmd.args[1] = y;
+    cmd.args[2] = width;
+    cmd.args[3] = height;
+}
+
+void CommandList::drawArrays (GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+    Command& cmd = push(CMD_DRAW_ARRAYS);
+    cmd.target = mode;
+    cmd.args[0] = first;
+    cmd.args[1] = count;
+    cmd.args[2] = instances;
+}
+
+void CommandList::drawElements (GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instances) {
+    Command& cmd = push(CMD_DRAW_ELEMENTS);
+    cmd.target = mode;
+    cmd.name = type;
+    cmd.args[0] = count;
+    cmd.args[1] = narrow(offset);
+    cmd.args[2] = instances;
+}
+
+void CommandList::dispatch (GLuint x, GLuint y, GLuint z) {
+    Command& cmd = push(CMD_DISPATCH);
+    cmd.args[0] = x;
+    cmd.args[1] = y;
+    cmd.args[2] = z;
+}
+
+void CommandList::end () {
+    if (_ended) return;
+    _ended = true;
+
+    // State as the list leaves it. Anything not set by the list is unknown.
+    std::map<GLenum, GLuint> bound;
+    std::map<std::pair<GLuint, GLenum>, GLuint> textures;
+    std::map<std::pair<GLuint, GLint>, Command> uniforms;
+    std::map<std::pair<GLenum, GLuint>, Command> ranges;
+
+    // Texture binds apply to the active unit, which only texture commands change
+    const GLuint UNKNOWN_UNIT = 0xffffffff;
+    GLuint activeUnit = UNKNOWN_UNIT;
+
+    size_t out = 0;
+    for (size_t i = 0; i < _commands.size(); i++) {
+        const Command& cmd = _commands[i];
+        bool redundant = false;
+
+        if (cmd.op == CMD_BIND) {
+            GLenum target = cmd.target;
+            if (target == GL_FRAMEBUFFER) {
+                redundant = bound.count(GL_DRAW_FRAMEBUFFER) && bound[GL_DRAW_FRAMEBUFFER] == cmd.name &&
+                            bound.count(GL_READ_FRAMEBUFFER) && bound[GL_READ_FRAMEBUFFER] == cmd.name;
+                bound[GL_DRAW_FRAMEBUFFER] = cmd.name;
+                bound[GL_READ_FRAMEBUFFER] = cmd.name;
+            } else if (isTextureTarget(target)) {
+                std::pair<GLuint, GLenum> key(activeUnit, target);
+                redundant = textures.count(key) && textures[key] == cmd.name;
+                textures[key] = cmd.name;
+            } else {
+                redundant = bound.count(target) && bound[target] == cmd.name;
+                bound[target] = cmd.name;
+                // Element array binding is part of vertex array state
+                if (target == GL_VERTEX_ARRAY && !redundant) bound.erase(GL_ELEMENT_ARRAY_BUFFER);
+            }
+        } else if (cmd.op == CMD_TEXTURE) {
+            std::pair<GLuint, GLenum> key(cmd.unit, cmd.target);
+            redundant = textures.count(key) && textures[key] == cmd.name;
+            textures[key] = cmd.name;
+            // Replay only selects the unit when the command is kept
+            if (!redundant) activeUnit = cmd.unit;
+        } else if (isUniform(cmd.op)) {
+            std::pair<GLuint, GLint> key(cmd.name, cmd.location);
+            auto it = uniforms.find(key);
+            size_t n = __uniformSize[cmd.op - CMD_UNIFORM_1I];
+            redundant = it != uniforms.end() && it->second.op == cmd.op &&
+                        memcmp(&_data[it->second.args[0]], &_data[cmd.args[0]], n * sizeof(float)) == 0;
+            uniforms[key] = cmd;
+        } else if (cmd.op == CMD_BUFFER_RANGE) {
+            std::pair<GLenum, GLuint> key(cmd.target, cmd.unit);
+            auto it = ranges.find(key);
+            redundant = it != ranges.end() && it->second.name == cmd.name &&
+                        it->second.args[0] == cmd.args[0] && it->second.args[1] == cmd.args[1];
+            ranges[key] = cmd;
+            // Indexed binds also bind the generic target
+            bound[cmd.target] = cmd.name;
+        }
+
+        if (redundant) {
+            _stats.collapsed += 1;
+            continue;
+        }
+        _commands[out++] = cmd;
+    }
+    _commands.resize(out);
+}
+
+void CommandList::replay () {
+    if (!_ended) end();
+
+    BindCache* cache = detail::currentBindCache();
+    const float* data = _data.data();
+    int activeUnit = -1;
+    for (const Command& cmd : _commands) {
+        const float* values = isUniform(cmd.op) ? data + cmd.args[0] : nullptr;
+        switch (cmd.op) {
+        case CMD_BIND:
+            detail::bindTarget(cmd.target, cmd.name);
+            break;
+        case CMD_TEXTURE:
+            if (cmd.unit != activeUnit) sgl::activeTexture(cmd.unit);
+            activeUnit = cmd.unit;
+            sgl::bindTexture(cmd.target, cmd.name);
+            break;
+        case CMD_UNIFORM_1I: {
+            GLint v;
+            memcpy(&v, values, sizeof(v));
+            glUniform1i(cmd.location, v);
+            sglCountUniform();
+            break;
+        }
+        case CMD_UNIFORM_1F:   glUniform1fv(cmd.location, 1, values); sglCountUniform(); break;
+        case CMD_UNIFORM_2F:   glUniform2fv(cmd.location, 1, values); sglCountUniform(); break;
+        case CMD_UNIFORM_3F:   glUniform3fv(cmd.location, 1, values); sglCountUniform(); break;
+        case CMD_UNIFORM_4F:   glUniform4fv(cmd.location, 1, values); sglCountUniform(); break;
+        case CMD_UNIFORM_MAT3: glUniformMatrix3fv(cmd.location, 1, false, values); sglCountUniform(); break;
+        case CMD_UNIFORM_MAT4: glUniformMatrix4fv(cmd.location, 1, false, values); sglCountUniform(); break;
+        case CMD_BUFFER_RANGE:
+            if (cmd.args[1] == 0) glBindBufferBase(cmd.target, cmd.unit, cmd.name);
+            else glBindBufferRange(cmd.target, cmd.unit, cmd.name, cmd.args[0], cmd.args[1]);
+            sglCountBind(cmd.target);
+            if (cache != nullptr) cache->note(cmd.target, cmd.name);
+            break;
+        case CMD_VIEWPORT:
+            glViewport(cmd.args[0], cmd.args[1], cmd.args[2], cmd.args[3]);
+            break;
+        case CMD_DRAW_ARRAYS:
+            if (cmd.args[2] == 1) glDrawArrays(cmd.target, cmd.args[0], cmd.args[1]);
+            else glDrawArraysInstanced(cmd.target, cmd.args[0], cmd.args[1], cmd.args[2]);
+            sglCountDraw();
+            break;
+        case CMD_DRAW_ELEMENTS: {
+            const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(cmd.args[1]));
+            if (cmd.args[2] == 1) glDrawElements(cmd.target, cmd.args[0], cmd.name, offset);
+            else glDrawElementsInstanced(cmd.target, cmd.args[0], cmd.name, offset, cmd.args[2]);
+            sglCountDraw();
+            break;
+        }
+        case CMD_DISPATCH:
+            glDispatchCompute(cmd.args[0], cmd.args[1], cmd.args[2]);
+            sglCountDispatch();
+            break;
+        default:
+            break;
+        }
+    }
+    _stats.replays += 1;
+    _stats.executed += _commands.size();
+    sglDbgCatchGLError();
+}
+
+void CommandList::clear () {
+    _commands.clear();
+    _data.clear();
+    _program = 0;
+    _ended = false;
+}
@@ -0,0 +1,57 @@
+#include <SimpleGL/counters.h>
+#include <SimpleGL/bindcache.h>
+
+#include <string.h>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+static_assert(SLOT_COUNT < COUNTER_BIND_OTHER, "COUNTER_BIND_SLOTS must cover every BindSlot");
+static_assert(sizeof(GLCounters) % sizeof(uint64_t) == 0, "GLCounters must only hold uint64_t counts");
+
+thread_local GLCounters sgl::detail::__sglCounters = {};
+
+// Totals when the current frame began, and the counts of the last frame
+static thread_local GLCounters __sglFrameStart = {};
+static thread_local GLCounters __sglLastFrame = {};
+static thread_local uint64_t __sglCounterFrame = 0;
+
+uint64_t GLCounters::bindsOf (GLenum target) const {
+    int slot = bindSlot(target);
+    return binds[slot < 0 ? COUNTER_BIND_OTHER : slot];
+}
+
+uint64_t GLCounters::totalBinds () const {
+    uint64_t total = 0;
+    for (uint64_t b : binds) total += b;
+    return total;
+}
+
+// dest = a - b, field by field
+static void difference (const GLCounters& a, const GLCounters& b, GLCounters& dest) {
+    const uint64_t* x = reinterpret_cast<const uint64_t*>(&a);
+    const uint64_t* y = reinterpret_cast<const uint64_t*>(&b);
+    uint64_t* d = reinterpret_cast<uint64_t*>(&dest);
+    for (size_t i = 0; i < sizeof(GLCounters) / sizeof(uint64_t); i++) d[i] = x[i] - y[i];
+}
+
+const GLCounters& sgl::frameCounters () {
+    return __sglLastFrame;
+}
+
+uint64_t sgl::counterFrame () {
+    return __sglCounterFrame;
+}
+
+void sgl::endCounterFrame () {
+    difference(__sglCounters, __sglFrameStart, __sglLastFrame);
+    __sglFrameStart = __sglCounters;
+    __sglCounterFrame += 1;
+}
+
+void sgl::resetCounters () {
+    memset(&__sglCounters, 0, sizeof(GLCounters));
+    memset(&__sglFrameStart, 0, sizeof(GLCounters));
+    memset(&__sglLastFrame, 0, sizeof(GLCounters));
+    __sglCounterFrame = 0;
+}
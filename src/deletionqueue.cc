@@ -0,0 +1,206 @@
+#include <SimpleGL/deletionqueue.h>
+#include <SimpleGL/bindcache.h>
+#include <SimpleGL/utils.h>
+#include <SimpleGL/vertexlayout.h>
+
+#include <string.h>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+std::atomic<DeletionQueue*> sgl::detail::__sglDeletionQueue{nullptr};
+
+// Kind used to clear the bind cache for each family
+static const GLenum __familyKinds[DELETE_FAMILY_COUNT] = {
+    GL_ARRAY_BUFFER, GL_TEXTURE_2D, GL_FRAMEBUFFER, GL_RENDERBUFFER, GL_VERTEX_ARRAY, GL_PROGRAM, GL_NONE
+};
+
+int sgl::detail::deletionFamily (GLenum kind) {
+    switch (kind) {
+    case GL_ARRAY_BUFFER:
+    case GL_ELEMENT_ARRAY_BUFFER:
+    case GL_COPY_READ_BUFFER:
+    case GL_COPY_WRITE_BUFFER:
+    case GL_PIXEL_PACK_BUFFER:
+    case GL_PIXEL_UNPACK_BUFFER:
+    case GL_QUERY_BUFFER:
+    case GL_TEXTURE_BUFFER:
+    case GL_TRANSFORM_FEEDBACK_BUFFER:
+    case GL_DRAW_INDIRECT_BUFFER:
+    case GL_ATOMIC_COUNTER_BUFFER:
+    case GL_DISPATCH_INDIRECT_BUFFER:
+    case GL_SHADER_STORAGE_BUFFER:
+    case GL_UNIFORM_BUFFER:
+        return DELETE_BUFFER;
+    case GL_TEXTURE_1D:
+    case GL_PROXY_TEXTURE_1D:
+    case GL_TEXTURE_2D:
+    case GL_PROXY_TEXTURE_2D:
+    case GL_TEXTURE_RECTANGLE:
+    case GL_TEXTURE_CUBE_MAP:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+    case GL_TEXTURE_3D:
+    case GL_TEXTURE_1D_ARRAY:
+    case GL_TEXTURE_2D_ARRAY:
+    case GL_TEXTURE_CUBE_MAP_ARRAY:
+    case GL_TEXTURE_2D_MULTISAMPLE:
+    case GL_TEXTURE_2D_MULTISAMPLE_ARRAY:
+        return DELETE_TEXTURE;
+    case GL_FRAMEBUFFER:
+    case GL_DRAW_FRAMEBUFFER:
+    case GL_READ_FRAMEBUFFER:
+        return DELETE_FRAMEBUFFER;
+    case GL_RENDERBUFFER:
+        return DELETE_RENDERBUFFER;
+    case GL_VERTEX_ARRAY:
+        return DELETE_VERTEX_ARRAY;
+    case GL_PROGRAM:
+        return DELETE_PROGRAM;
+    case GL_VERTEX_SHADER:
+    case GL_FRAGMENT_SHADER:
+    case GL_GEOMETRY_SHADER:
+    case GL_TESS_CONTROL_SHADER:
+    case GL_TESS_EVALUATION_SHADER:
+    case GL_COMPUTE_SHADER:
+        return DELETE_SHADER;
+    default:
+        return DELETE_NONE;
+    }
+}
+
+void sgl::detail::deleteNames (int family, size_t len, const GLuint* ids) {
+    switch (family) {
+    case DELETE_BUFFER:       glDeleteBuffers(len, ids); break;
+    case DELETE_TEXTURE:      glDeleteTextures(len, ids); break;
+    case DELETE_FRAMEBUFFER:  glDeleteFramebuffers(len, ids); break;
+    case DELETE_RENDERBUFFER: glDeleteRenderbuffers(len, ids); break;
+    case DELETE_VERTEX_ARRAY:
+        forgetVertexLayouts(len, ids);
+        glDeleteVertexArrays(len, ids);
+        break;
+    case DELETE_PROGRAM:
+        for (size_t i = 0; i < len; i++) glDeleteProgram(ids[i]);
+        break;
+    case DELETE_SHADER:
+        for (size_t i = 0; i < len; i++) glDeleteShader(ids[i]);
+        break;
+    default: return;
+    }
+    sglCountDeletion(len);
+}
+
+bool DeletionBatch::empty () const {
+    for (const auto& names : this->names) {
+        if (!names.empty()) return false;
+    }
+    return true;
+}
+
+DeletionQueue::DeletionQueue (size_t maxFramesInFlight) :
+    _maxFramesInFlight(maxFramesInFlight),
+    _frame(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+DeletionQueue::~DeletionQueue () {
+    DeletionQueue* self = this;
+    detail::__sglDeletionQueue.compare_exchange_strong(self, nullptr);
+}
+
+bool DeletionQueue::enqueue (GLenum kind, size_t len, const GLuint* ids) {
+    int family = detail::deletionFamily(kind);
+    if (family == DELETE_NONE) {
+        sglDbgPrint("DeletionQueue: can't delete objects of kind 0x%x\n", kind);
+        return true;
+    }
+    if (!detail::sharedFamily(family)) return false;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    std::vector<GLuint>& names = _incoming.names[family];
+    names.insert(names.end(), ids, ids + len);
+    _stats.enqueued += len;
+    return true;
+}
+
+void DeletionQueue::destroy (DeletionBatch& batch) {
+    BindCache* cache = detail::currentBindCache();
+    for (int family = 0; family < DELETE_FAMILY_COUNT; family++) {
+        std::vector<GLuint>& names = batch.names[family];
+        if (names.empty()) continue;
+        // Names may have been bound again since they were released
+        if (cache != nullptr && __familyKinds[family] != GL_NONE) cache->forget(__familyKinds[family], names.size(), &names[0]);
+        detail::deleteNames(family, names.size(), &names[0]);
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _stats.deleted += names.size();
+            _stats.deleteCalls += 1;
+        }
+        names.clear();
+    }
+    if (batch.fence != nullptr) glDeleteSync(batch.fence);
+    batch.fence = nullptr;
+}
+
+void DeletionQueue::endFrame () {
+    detail::DeletionBatch batch;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        std::swap(batch, _incoming);
+    }
+
+    _frame += 1;
+    if (!batch.empty()) {
+        batch.fence = SGL_SYNC_SUPPORTED ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+        batch.frame = _frame;
+        _inflight.push_back(std::move(batch));
+    }
+    retire();
+}
+
+void DeletionQueue::retire () {
+    while (!_inflight.empty()) {
+        DeletionBatch& batch = _inflight.front();
+        if (batch.fence != nullptr) {
+            GLenum status = glClientWaitSync(batch.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) break;
+        } else if (_frame - batch.frame < _maxFramesInFlight) {
+            break;
+        }
+        destroy(batch);
+        _inflight.pop_front();
+    }
+    sglDbgCatchGLError();
+}
+
+void DeletionQueue::flush () {
+    DeletionBatch batch;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        std::swap(batch, _incoming);
+    }
+
+    for (auto& b : _inflight) destroy(b);
+    _inflight.clear();
+    destroy(batch);
+}
+
+size_t DeletionQueue::pending () const {
+    size_t count = 0;
+    for (const auto& batch : _inflight) {
+        for (const auto& names : batch.names) count += names.size();
+    }
+    std::lock_guard<std::mutex> guard(_lock);
+    for (const auto& names : _incoming.names) count += names.size();
+    return count;
+}
+
+DeletionQueueStats DeletionQueue::stats () const {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _stats;
+}
@@ -0,0 +1,256 @@
+#include <SimpleGL/gpuprofiler.h>
+#include <SimpleGL/utils.h>
+
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+thread_local GpuProfiler* sgl::detail::__sglGpuProfiler = nullptr;
+
+void sgl::setGpuProfiler (GpuProfiler* profiler) {
+    __sglGpuProfiler = profiler;
+}
+
+static const GLenum STATISTICS_TARGETS[] = {
+    GL_VERTICES_SUBMITTED_ARB,
+    GL_PRIMITIVES_SUBMITTED_ARB,
+    GL_VERTEX_SHADER_INVOCATIONS_ARB,
+    GL_FRAGMENT_SHADER_INVOCATIONS_ARB,
+    GL_COMPUTE_SHADER_INVOCATIONS_ARB
+};
+
+static const size_t STATISTICS_COUNT = sizeof(STATISTICS_TARGETS) / sizeof(GLenum);
+
+GpuProfiler::GpuProfiler (bool pipelineStatistics) :
+    _frame(0),
+    _dropped(0),
+    _statisticsDepth(-1),
+    _pipelineStatistics(pipelineStatistics)
+{
+    for (auto& frame : _frames) {
+        frame.usedTimestamps = 0;
+        frame.usedStatistics = 0;
+        frame.frame = 0;
+        frame.pending = false;
+    }
+}
+
+bool GpuProfiler::enabled () const {
+    return SGL_TIMERQUERY_SUPPORTED;
+}
+
+uint32_t GpuProfiler::scopeId (const char* name) {
+    auto it = _scopeIds.find(name);
+    if (it != _scopeIds.end()) return it->second;
+
+    uint32_t id = _scopes.size();
+    ScopeHistory history;
+    history.name = name;
+    history.count = 0;
+    history.next = 0;
+    history.frameMs = 0;
+    history.seen = false;
+    memset(&history.pipeline, 0, sizeof(history.pipeline));
+    _scopes.push_back(history);
+    _scopeIds.insert(std::make_pair(history.name, id));
+    return id;
+}
+
+// Next unused timestamp query of frame, growing its pool if needed
+GLuint GpuProfiler::timestampQuery (ProfilerFrame& frame) {
+    if (frame.usedTimestamps == frame.timestamps.size()) {
+        size_t grow = std::max<size_t>(16, frame.timestamps.size());
+        frame.timestamps.resize(frame.timestamps.size() + grow);
+        glGenQueries(grow, &frame.timestamps[frame.timestamps.size() - grow]);
+    }
+    return frame.timestamps[frame.usedTimestamps++];
+}
+
+void GpuProfiler::begin (const char* name) {
+    if (!enabled()) return;
+    ProfilerFrame& frame = _frames[_frame % SGL_PROFILER_FRAMES];
+
+    PendingScope scope;
+    scope.scope = scopeId(name);
+    scope.depth = _stack.size();
+    scope.query = frame.usedTimestamps;
+    scope.statistics = -1;
+    glQueryCounter(timestampQuery(frame), GL_TIMESTAMP);
+    timestampQuery(frame);
+
+    // Statistics queries of a target can't nest, so only the outermost scope collects them
+    if (_pipelineStatistics && SGL_PIPELINESTATISTICS_SUPPORTED && _statisticsDepth < 0) {
+        if (frame.usedStatistics + STATISTICS_COUNT > frame.statistics.size()) {
+            size_t grow = STATISTICS_COUNT * 4;
+            frame.statistics.resize(frame.statistics.size() + grow);
+            glGenQueries(grow, &frame.statistics[frame.statistics.size() - grow]);
+        }
+        scope.statistics = frame.usedStatistics;
+        for (size_t i = 0; i < STATISTICS_COUNT; i++) {
+            glBeginQuery(STATISTICS_TARGETS[i], frame.statistics[frame.usedStatistics++]);
+        }
+        _statisticsDepth = scope.depth;
+    }
+
+    _stack.push_back(frame.scopes.size());
+    frame.scopes.push_back(scope);
+    sglDbgCatchGLError();
+}
+
+void GpuProfiler::end () {
+    if (!enabled()) return;
+    if (_stack.empty()) throw std::runtime_error("GpuProfiler: end without begin");
+    ProfilerFrame& frame = _frames[_frame % SGL_PROFILER_FRAMES];
+    const PendingScope& scope = frame.scopes[_stack.back()];
+    _stack.pop_back();
+
+    // Statistics end first so the closing timestamp comes after them
+    if (scope.statistics >= 0) {
+        for (size_t i = 0; i < STATISTICS_COUNT; i++) glEndQuery(STATISTICS_TARGETS[i]);
+        _statisticsDepth = -1;
+    }
+    glQueryCounter(frame.timestamps[scope.query + 1], GL_TIMESTAMP);
+    sglDbgCatchGLError();
+}
+
+void GpuProfiler::endFrame () {
+    if (!enabled()) return;
+    if (!_stack.empty()) throw std::runtime_error("GpuProfiler: frame ended with open scopes");
+
+    ProfilerFrame& current = _frames[_frame % SGL_PROFILER_FRAMES];
+    current.frame = _frame;
+    current.pending = !current.scopes.empty();
+    _frame += 1;
+
+    resolve();
+
+    // The next frame reuses this slot's queries. Drop it rather than wait.
+    ProfilerFrame& next = _frames[_frame % SGL_PROFILER_FRAMES];
+    if (next.pending) _dropped += 1;
+    next.pending = false;
+    next.scopes.clear();
+    next.usedTimestamps = 0;
+    next.usedStatistics = 0;
+}
+
+// Resolve pending frames in order, stopping at the first that isn't ready
+void GpuProfiler::resolve () {
+    for (uint64_t f = _frame > SGL_PROFILER_FRAMES ? _frame - SGL_PROFILER_FRAMES : 0; f < _frame; f++) {
+        ProfilerFrame& frame = _frames[f % SGL_PROFILER_FRAMES];
+        if (!frame.pending || frame.frame != f) continue;
+
+        // Queries complete in order, so the last one being ready means they all are.
+        // Statistics are checked too, as drivers needn't order them with timestamps.
+        GLuint available = 0;
+        glGetQueryObjectuiv(frame.timestamps[frame.usedTimestamps - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available && frame.usedStatistics > 0) {
+            glGetQueryObjectuiv(frame.statistics[frame.usedStatistics - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        }
+        if (!available) break;
+        resolve(frame);
+        frame.pending = false;
+    }
+}
+
+void GpuProfiler::resolve (ProfilerFrame& frame) {
+    _resolved.clear();
+    for (const auto& scope : frame.scopes) {
+        GpuSample sample;
+        sample.scope = scope.scope;
+        sample.depth = scope.depth;
+        sample.frame = frame.frame;
+        glGetQueryObjectui64v(frame.timestamps[scope.query], GL_QUERY_RESULT, &sample.beginNs);
+        glGetQueryObjectui64v(frame.timestamps[scope.query + 1], GL_QUERY_RESULT, &sample.endNs);
+        _resolved.push_back(sample);
+
+        ScopeHistory& history = _scopes[scope.scope];
+        history.frameMs += (sample.endNs - sample.beginNs) / 1e6;
+        if (!history.seen) memset(&history.pipeline, 0, sizeof(history.pipeline));
+        history.seen = true;
+
+        if (scope.statistics >= 0) {
+            GLuint64 values[STATISTICS_COUNT];
+            for (size_t i = 0; i < STATISTICS_COUNT; i++) {
+                glGetQueryObjectui64v(frame.statistics[scope.statistics + i], GL_QUERY_RESULT, &values[i]);
+            }
+            history.pipeline.verticesSubmitted += values[0];
+            history.pipeline.primitivesSubmitted += values[1];
+            history.pipeline.vertexShaderInvocations += values[2];
+            history.pipeline.fragmentShaderInvocations += values[3];
+            history.pipeline.computeShaderInvocations += values[4];
+        }
+    }
+
+    for (auto& history : _scopes) {
+        if (!history.seen) continue;
+        history.samples[history.next] = history.frameMs;
+        history.next = (history.next + 1) % SGL_PROFILER_HISTORY;
+        history.count = std::min<size_t>(history.count + 1, SGL_PROFILER_HISTORY);
+        history.frameMs = 0;
+        history.seen = false;
+    }
+    sglDbgCatchGLError();
+}
+
+static void summarize (const ScopeHistory& history, GpuScopeStats& dest) {
+    dest.name = history.name;
+    dest.frames = history.count;
+    dest.pipeline = history.pipeline;
+    dest.lastMs = dest.minMs = dest.avgMs = dest.p99Ms = dest.maxMs = 0;
+    if (history.count == 0) return;
+
+    std::vector<double> samples(history.samples, history.samples + history.count);
+    dest.lastMs = history.samples[(history.next + SGL_PROFILER_HISTORY - 1) % SGL_PROFILER_HISTORY];
+    double total = 0;
+    for (double s : samples) total += s;
+    dest.avgMs = total / samples.size();
+    dest.minMs = *std::min_element(samples.begin(), samples.end());
+    dest.maxMs = *std::max_element(samples.begin(), samples.end());
+    size_t p99 = (samples.size() * 99) / 100;
+    if (p99 >= samples.size()) p99 = samples.size() - 1;
+    std::nth_element(samples.begin(), samples.begin() + p99, samples.end());
+    dest.p99Ms = samples[p99];
+}
+
+std::vector<GpuScopeStats> GpuProfiler::stats () const {
+    std::vector<GpuScopeStats> result(_scopes.size());
+    for (size_t i = 0; i < _scopes.size(); i++) summarize(_scopes[i], result[i]);
+    return result;
+}
+
+bool GpuProfiler::stats (const char* name, GpuScopeStats& dest) const {
+    auto it = _scopeIds.find(name);
+    if (it == _scopeIds.end() || _scopes[it->second].count == 0) return false;
+    summarize(_scopes[it->second], dest);
+    return true;
+}
+
+void GpuProfiler::reset () {
+    for (auto& history : _scopes) {
+        history.count = 0;
+        history.next = 0;
+        history.frameMs = 0;
+        history.seen = false;
+        memset(&history.pipeline, 0, sizeof(history.pipeline));
+    }
+    _resolved.clear();
+    _dropped = 0;
+}
+
+void GpuProfiler::release () {
+    for (auto& frame : _frames) {
+        if (!frame.timestamps.empty()) glDeleteQueries(frame.timestamps.size(), &frame.timestamps[0]);
+        if (!frame.statistics.empty()) glDeleteQueries(frame.statistics.size(), &frame.statistics[0]);
+        frame.timestamps.clear();
+        frame.statistics.clear();
+        frame.scopes.clear();
+        frame.usedTimestamps = 0;
+        frame.usedStatistics = 0;
+        frame.pending = false;
+    }
+    _stack.clear();
+    _statisticsDepth = -1;
+}
@@ -0,0 +1,42 @@
+#include <SimpleGL/handlepool.h>
+
+#include <string.h>
+#include <algorithm>
+
+using namespace sgl;
+
+thread_local HandlePool* sgl::detail::__sglHandlePool = nullptr;
+
+HandlePool::HandlePool (size_t chunk) :
+    _chunk(std::max<size_t>(chunk, 1))
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void HandlePool::refill (Bucket& bucket, size_t len, detail::PoolCreator creator) {
+    size_t count = std::max(_chunk, len - bucket.available.size());
+    size_t offset = bucket.available.size();
+    bucket.available.resize(offset + count);
+    creator(count, &bucket.available[offset]);
+    _stats.created += count;
+    _stats.createCalls += 1;
+}
+
+void HandlePool::flush (Bucket& bucket) {
+    if (bucket.released.empty()) return;
+    bucket.destroy(bucket.released.size(), &bucket.released[0]);
+    bucket.released.clear();
+    _stats.destroyCalls += 1;
+}
+
+void HandlePool::flush () {
+    for (auto& bucket : _buckets) flush(bucket);
+}
+
+void HandlePool::clear () {
+    for (auto& bucket : _buckets) {
+        bucket.released.insert(bucket.released.end(), bucket.available.begin(), bucket.available.end());
+        bucket.available.clear();
+        flush(bucket);
+    }
+}
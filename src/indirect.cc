@@ -0,0 +1,89 @@
+#include <SimpleGL/indirect.h>
+#include <SimpleGL/utils.h>
+
+#include <stdint.h>
+#include <stdexcept>
+
+using namespace sgl;
+
+static inline const void* commandOffset (size_t idx, size_t stride) {
+    return reinterpret_cast<const void*>(static_cast<uintptr_t>(idx * stride));
+}
+
+static inline size_t indexSize (GLenum type) {
+    switch (type) {
+    case GL_UNSIGNED_BYTE:  return 1;
+    case GL_UNSIGNED_SHORT: return 2;
+    default:                return 4;
+    }
+}
+
+static inline void requireIndirect () {
+    if (!SGL_DRAWINDIRECT_SUPPORTED) throw std::runtime_error("Indirect draws need OpenGL 4.0 or ES 3.1");
+}
+
+void sgl::multiDrawElementsIndirect (GLuint vao, GLuint buffer, GLenum mode, GLenum type, size_t first, size_t count) {
+    if (count == 0) return;
+    requireIndirect();
+    const size_t stride = sizeof(DrawElementsIndirectCommand);
+    sgl::bind<GL_VERTEX_ARRAY>(vao);
+    sgl::bind<GL_DRAW_INDIRECT_BUFFER>(buffer);
+    if (SGL_MULTIDRAWINDIRECT_SUPPORTED) {
+        glMultiDrawElementsIndirect(mode, type, commandOffset(first, stride), count, stride);
+        sglCountDraw();
+    } else {
+        for (size_t i = first; i < first + count; i++) {
+            glDrawElementsIndirect(mode, type, commandOffset(i, stride));
+            sglCountDraw();
+        }
+    }
+    sglDbgCatchGLError();
+}
+
+void sgl::multiDrawArraysIndirect (GLuint vao, GLuint buffer, GLenum mode, size_t first, size_t count) {
+    if (count == 0) return;
+    requireIndirect();
+    const size_t stride = sizeof(DrawArraysIndirectCommand);
+    sgl::bind<GL_VERTEX_ARRAY>(vao);
+    sgl::bind<GL_DRAW_INDIRECT_BUFFER>(buffer);
+    if (SGL_MULTIDRAWINDIRECT_SUPPORTED) {
+        glMultiDrawArraysIndirect(mode, commandOffset(first, stride), count, stride);
+        sglCountDraw();
+    } else {
+        for (size_t i = first; i < first + count; i++) {
+            glDrawArraysIndirect(mode, commandOffset(i, stride));
+            sglCountDraw();
+        }
+    }
+    sglDbgCatchGLError();
+}
+
+void sgl::detail::drawCommands (GLuint vao, GLenum mode, GLenum type, const DrawElementsIndirectCommand* commands, size_t count) {
+    sgl::bind<GL_VERTEX_ARRAY>(vao);
+    for (size_t i = 0; i < count; i++) {
+        const DrawElementsIndirectCommand& cmd = commands[i];
+        if (cmd.instanceCount == 0) continue;
+        if (cmd.baseInstance != 0) throw std::runtime_error("Indirect draws: baseInstance needs OpenGL 4.0 or ES 3.1");
+        const void* offset = commandOffset(cmd.firstIndex, indexSize(type));
+#ifdef SGL_USE_GLES
+        if (cmd.baseVertex != 0) throw std::runtime_error("Indirect draws: baseVertex needs ES 3.1");
+        glDrawElementsInstanced(mode, cmd.count, type, offset, cmd.instanceCount);
+#else
+        glDrawElementsInstancedBaseVertex(mode, cmd.count, type, offset, cmd.instanceCount, cmd.baseVertex);
+#endif
+        sglCountDraw();
+    }
+    sglDbgCatchGLError();
+}
+
+void sgl::detail::drawCommands (GLuint vao, GLenum mode, const DrawArraysIndirectCommand* commands, size_t count) {
+    sgl::bind<GL_VERTEX_ARRAY>(vao);
+    for (size_t i = 0; i < count; i++) {
+        const DrawArraysIndirectCommand& cmd = commands[i];
+        if (cmd.instanceCount == 0) continue;
+        if (cmd.baseInstance != 0) throw std::runtime_error("Indirect draws: baseInstance needs OpenGL 4.0 or ES 3.1");
+        glDrawArraysInstanced(mode, cmd.first, cmd.count, cmd.instanceCount);
+        sglCountDraw();
+    }
+    sglDbgCatchGLError();
+}
@@ -0,0 +1,865 @@
+#include <SimpleGL/nulldriver.h>
+#include <SimpleGL/bindcache.h>
+
+#include <string.h>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+NullDriver* sgl::detail::__sglNullDriver = nullptr;
+
+enum NullString {
+    STRING_VERSION = 0,
+    STRING_VENDOR,
+    STRING_RENDERER,
+    STRING_SHADING_LANGUAGE,
+    STRING_EXTENSIONS,
+    STRING_FIRST_EXTENSION
+};
+
+// Binding points the driver answers glGet queries for
+static const GLenum __nullTargets[] = {
+    GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+    GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_QUERY_BUFFER, GL_TEXTURE_BUFFER,
+    GL_TRANSFORM_FEEDBACK_BUFFER, GL_DRAW_INDIRECT_BUFFER, GL_ATOMIC_COUNTER_BUFFER,
+    GL_DISPATCH_INDIRECT_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_UNIFORM_BUFFER,
+    GL_DRAW_FRAMEBUFFER, GL_READ_FRAMEBUFFER, GL_RENDERBUFFER, GL_VERTEX_ARRAY, GL_PROGRAM,
+    GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_RECTANGLE, GL_TEXTURE_CUBE_MAP,
+    GL_TEXTURE_1D_ARRAY, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP_ARRAY,
+    GL_TEXTURE_2D_MULTISAMPLE, GL_TEXTURE_2D_MULTISAMPLE_ARRAY
+};
+
+static std::string format (const char* what, GLuint name) {
+    std::stringstream msg;
+    msg << what << " " << name;
+    return msg.str();
+}
+
+// Locations and block indices are derived from the name, so they are stable across runs
+static GLint nameHash (const GLchar* name) {
+    uint32_t hash = 2166136261u;
+    for (const GLchar* c = name; *c != '\0'; c++) hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    return static_cast<GLint>(hash & 0x7fff);
+}
+
+namespace sgl {
+namespace detail {
+
+// Every replaced entry point. Unless replaced by one of the functions below
+// an entry point only counts the call.
+struct NullStubs {
+    template <NullCall id, class R, class... A>
+    struct Record {
+        static R APIENTRY call (A...) {
+            __sglNullDriver->call(id);
+            return R();
+        }
+    };
+
+    // Uniform sets and dispatches need a program in use
+    template <NullCall id, class R, class... A>
+    struct Program {
+        static R APIENTRY call (A...) {
+            __sglNullDriver->call(id);
+            __sglNullDriver->requireProgram(id);
+            return R();
+        }
+    };
+
+    // Draws need a program and a vertex array
+    template <NullCall id, class R, class... A>
+    struct Draw {
+        static R APIENTRY call (A...) {
+            __sglNullDriver->call(id);
+            __sglNullDriver->requireDraw(id);
+            return R();
+        }
+    };
+
+    template <template <NullCall, class, class...> class Policy, NullCall id, class R, class... A>
+    static void replace (R (APIENTRY *&fn)(A...)) {
+        fn = &Policy<id, R, A...>::call;
+    }
+
+    // Objects
+
+    static void gen (NullObject kind, GLsizei n, GLuint* names) {
+        for (GLsizei i = 0; i < n; i++) names[i] = __sglNullDriver->genName(kind);
+    }
+
+    static void remove (NullObject kind, GLsizei n, const GLuint* names) {
+        for (GLsizei i = 0; i < n; i++) __sglNullDriver->deleteName(kind, names[i]);
+    }
+
+    static void APIENTRY genBuffers (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glGenBuffers);
+        for (GLsizei i = 0; i < n; i++) names[i] = __sglNullDriver->genBuffer();
+    }
+
+    static void APIENTRY createBuffers (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glCreateBuffers);
+        for (GLsizei i = 0; i < n; i++) names[i] = __sglNullDriver->genBuffer();
+    }
+
+    static void APIENTRY deleteBuffers (GLsizei n, const GLuint* names) {
+        __sglNullDriver->call(NULL_glDeleteBuffers);
+        for (GLsizei i = 0; i < n; i++) __sglNullDriver->deleteBuffer(names[i]);
+    }
+
+    static void APIENTRY genTextures (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glGenTextures);
+        gen(NULL_OBJECT_TEXTURE, n, names);
+    }
+
+    static void APIENTRY createTextures (GLenum, GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glCreateTextures);
+        gen(NULL_OBJECT_TEXTURE, n, names);
+    }
+
+    static void APIENTRY deleteTextures (GLsizei n, const GLuint* names) {
+        __sglNullDriver->call(NULL_glDeleteTextures);
+        remove(NULL_OBJECT_TEXTURE, n, names);
+    }
+
+    static void APIENTRY genFramebuffers (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glGenFramebuffers);
+        gen(NULL_OBJECT_FRAMEBUFFER, n, names);
+    }
+
+    static void APIENTRY createFramebuffers (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glCreateFramebuffers);
+        gen(NULL_OBJECT_FRAMEBUFFER, n, names);
+    }
+
+    static void APIENTRY deleteFramebuffers (GLsizei n, const GLuint* names) {
+        __sglNullDriver->call(NULL_glDeleteFramebuffers);
+        remove(NULL_OBJECT_FRAMEBUFFER, n, names);
+    }
+
+    static void APIENTRY genRenderbuffers (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glGenRenderbuffers);
+        gen(NULL_OBJECT_RENDERBUFFER, n, names);
+    }
+
+    static void APIENTRY createRenderbuffers (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glCreateRenderbuffers);
+        gen(NULL_OBJECT_RENDERBUFFER, n, names);
+    }
+
+    static void APIENTRY deleteRenderbuffers (GLsizei n, const GLuint* names) {
+        __sglNullDriver->call(NULL_glDeleteRenderbuffers);
+        remove(NULL_OBJECT_RENDERBUFFER, n, names);
+    }
+
+    static void APIENTRY genVertexArrays (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glGenVertexArrays);
+        gen(NULL_OBJECT_VERTEX_ARRAY, n, names);
+    }
+
+    static void APIENTRY createVertexArrays (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glCreateVertexArrays);
+        gen(NULL_OBJECT_VERTEX_ARRAY, n, names);
+    }
+
+    static void APIENTRY deleteVertexArrays (GLsizei n, const GLuint* names) {
+        __sglNullDriver->call(NULL_glDeleteVertexArrays);
+        remove(NULL_OBJECT_VERTEX_ARRAY, n, names);
+    }
+
+    static void APIENTRY genQueries (GLsizei n, GLuint* names) {
+        __sglNullDriver->call(NULL_glGenQueries);
+        gen(NULL_OBJECT_QUERY, n, names);
+    }
+
+    static void APIENTRY deleteQueries (GLsizei n, const GLuint* names) {
+        __sglNullDriver->call(NULL_glDeleteQueries);
+        remove(NULL_OBJECT_QUERY, n, names);
+    }
+
+    static GLuint APIENTRY createProgram () {
+        __sglNullDriver->call(NULL_glCreateProgram);
+        return __sglNullDriver->genName(NULL_OBJECT_PROGRAM);
+    }
+
+    static void APIENTRY deleteProgram (GLuint name) {
+        __sglNullDriver->call(NULL_glDeleteProgram);
+        __sglNullDriver->deleteName(NULL_OBJECT_PROGRAM, name);
+    }
+
+    static GLuint APIENTRY createShader (GLenum) {
+        __sglNullDriver->call(NULL_glCreateShader);
+        return __sglNullDriver->genName(NULL_OBJECT_SHADER);
+    }
+
+    static void APIENTRY deleteShader (GLuint name) {
+        __sglNullDriver->call(NULL_glDeleteShader);
+        __sglNullDriver->deleteName(NULL_OBJECT_SHADER, name);
+    }
+
+    static GLsync APIENTRY fenceSync (GLenum, GLbitfield) {
+        __sglNullDriver->call(NULL_glFenceSync);
+        return reinterpret_cast<GLsync>(__sglNullDriver);
+    }
+
+    static GLenum APIENTRY clientWaitSync (GLsync, GLbitfield, GLuint64) {
+        __sglNullDriver->call(NULL_glClientWaitSync);
+        return GL_ALREADY_SIGNALED;
+    }
+
+    // Bindings
+
+    static void APIENTRY activeTexture (GLenum unit) {
+        __sglNullDriver->call(NULL_glActiveTexture);
+        __sglNullDriver->_textureUnit = unit - GL_TEXTURE0;
+    }
+
+    static void APIENTRY bindBuffer (GLenum target, GLuint name) {
+        __sglNullDriver->bindBuffer(NULL_glBindBuffer, target, name);
+    }
+
+    // Indexed binds also bind the generic binding point
+    static void APIENTRY bindBufferBase (GLenum target, GLuint, GLuint name) {
+        __sglNullDriver->bindBuffer(NULL_glBindBufferBase, target, name);
+    }
+
+    static void APIENTRY bindBufferRange (GLenum target, GLuint, GLuint name, GLintptr, GLsizeiptr) {
+        __sglNullDriver->bindBuffer(NULL_glBindBufferRange, target, name);
+    }
+
+    static void APIENTRY bindTexture (GLenum target, GLuint name) {
+        __sglNullDriver->bind(NULL_glBindTexture, target, NULL_OBJECT_TEXTURE, name);
+    }
+
+    static void APIENTRY bindFramebuffer (GLenum target, GLuint name) {
+        NullDriver* driver = __sglNullDriver;
+        if (target != GL_FRAMEBUFFER) {
+            driver->bind(NULL_glBindFramebuffer, target, NULL_OBJECT_FRAMEBUFFER, name);
+            return;
+        }
+        driver->bind(NULL_glBindFramebuffer, GL_DRAW_FRAMEBUFFER, NULL_OBJECT_FRAMEBUFFER, name);
+        driver->_bindings[GL_READ_FRAMEBUFFER] = driver->_bindings[GL_DRAW_FRAMEBUFFER];
+    }
+
+    static void APIENTRY bindRenderbuffer (GLenum target, GLuint name) {
+        __sglNullDriver->bind(NULL_glBindRenderbuffer, target, NULL_OBJECT_RENDERBUFFER, name);
+    }
+
+    static void APIENTRY bindVertexArray (GLuint name) {
+        __sglNullDriver->bind(NULL_glBindVertexArray, GL_VERTEX_ARRAY, NULL_OBJECT_VERTEX_ARRAY, name);
+    }
+
+    static void APIENTRY useProgram (GLuint name) {
+        __sglNullDriver->bind(NULL_glUseProgram, GL_PROGRAM, NULL_OBJECT_PROGRAM, name);
+    }
+
+    // Buffers
+
+    static void allocate (NullCall call, NullBuffer* buffer, GLsizeiptr size, bool immutable) {
+        if (buffer == nullptr) return;
+        if (buffer->immutable) {
+            __sglNullDriver->error(call, GL_INVALID_OPERATION, "Buffer has immutable storage");
+            return;
+        }
+        if (size < 0) {
+            __sglNullDriver->error(call, GL_INVALID_VALUE, "Negative buffer size");
+            return;
+        }
+        buffer->size = size;
+        buffer->immutable = immutable;
+        buffer->mapped = false;
+    }
+
+    static void write (NullCall call, NullBuffer* buffer, GLintptr offset, GLsizeiptr size) {
+        if (buffer == nullptr) return;
+        if (offset < 0 || size < 0 || size_t(offset + size) > buffer->size) {
+            __sglNullDriver->error(call, GL_INVALID_VALUE, "Write outside of the buffer's data store");
+        }
+    }
+
+    static void* map (NullCall call, NullBuffer* buffer, GLintptr offset, GLsizeiptr length) {
+        if (buffer == nullptr) return nullptr;
+        if (buffer->mapped) {
+            __sglNullDriver->error(call, GL_INVALID_OPERATION, "Buffer is already mapped");
+            return nullptr;
+        }
+        if (offset < 0 || length <= 0 || size_t(offset + length) > buffer->size) {
+            __sglNullDriver->error(call, GL_INVALID_VALUE, "Mapped range outside of the buffer's data store");
+            return nullptr;
+        }
+        if (buffer->storage.size() < buffer->size) buffer->storage.resize(buffer->size);
+        buffer->mapped = true;
+        return &buffer->storage[offset];
+    }
+
+    static GLboolean unmap (NullCall call, NullBuffer* buffer) {
+        if (buffer == nullptr) return GL_FALSE;
+        if (!buffer->mapped) {
+            __sglNullDriver->error(call, GL_INVALID_OPERATION, "Buffer isn't mapped");
+            return GL_FALSE;
+        }
+        buffer->mapped = false;
+        return GL_TRUE;
+    }
+
+    static void parameter (NullBuffer* buffer, GLenum pname, GLint64& dest) {
+        dest = 0;
+        if (buffer == nullptr) return;
+        switch (pname) {
+        case GL_BUFFER_SIZE:              dest = buffer->size; break;
+        case GL_BUFFER_MAPPED:            dest = buffer->mapped; break;
+        case GL_BUFFER_IMMUTABLE_STORAGE: dest = buffer->immutable; break;
+        default: break;
+        }
+    }
+
+    static void APIENTRY bufferData (GLenum target, GLsizeiptr size, const void*, GLenum) {
+        __sglNullDriver->call(NULL_glBufferData);
+        allocate(NULL_glBufferData, __sglNullDriver->boundBuffer(NULL_glBufferData, target), size, false);
+    }
+
+    static void APIENTRY bufferStorage (GLenum target, GLsizeiptr size, const void*, GLbitfield) {
+        __sglNullDriver->call(NULL_glBufferStorage);
+        allocate(NULL_glBufferStorage, __sglNullDriver->boundBuffer(NULL_glBufferStorage, target), size, true);
+    }
+
+    static void APIENTRY bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const void*) {
+        __sglNullDriver->call(NULL_glBufferSubData);
+        write(NULL_glBufferSubData, __sglNullDriver->boundBuffer(NULL_glBufferSubData, target), offset, size);
+    }
+
+    static void APIENTRY namedBufferData (GLuint name, GLsizeiptr size, const void*, GLenum) {
+        __sglNullDriver->call(NULL_glNamedBufferData);
+        allocate(NULL_glNamedBufferData, __sglNullDriver->buffer(NULL_glNamedBufferData, name), size, false);
+    }
+
+    static void APIENTRY namedBufferStorage (GLuint name, GLsizeiptr size, const void*, GLbitfield) {
+        __sglNullDriver->call(NULL_glNamedBufferStorage);
+        allocate(NULL_glNamedBufferStorage, __sglNullDriver->buffer(NULL_glNamedBufferStorage, name), size, true);
+    }
+
+    static void APIENTRY namedBufferSubData (GLuint name, GLintptr offset, GLsizeiptr size, const void*) {
+        __sglNullDriver->call(NULL_glNamedBufferSubData);
+        write(NULL_glNamedBufferSubData, __sglNullDriver->buffer(NULL_glNamedBufferSubData, name), offset, size);
+    }
+
+    static void* APIENTRY mapBuffer (GLenum target, GLenum) {
+        __sglNullDriver->call(NULL_glMapBuffer);
+        NullBuffer* buffer = __sglNullDriver->boundBuffer(NULL_glMapBuffer, target);
+        return map(NULL_glMapBuffer, buffer, 0, buffer != nullptr ? buffer->size : 0);
+    }
+
+    static void* APIENTRY mapBufferRange (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield) {
+        __sglNullDriver->call(NULL_glMapBufferRange);
+        return map(NULL_glMapBufferRange, __sglNullDriver->boundBuffer(NULL_glMapBufferRange, target), offset, length);
+    }
+
+    static void* APIENTRY mapNamedBuffer (GLuint name, GLenum) {
+        __sglNullDriver->call(NULL_glMapNamedBuffer);
+        NullBuffer* buffer = __sglNullDriver->buffer(NULL_glMapNamedBuffer, name);
+        return map(NULL_glMapNamedBuffer, buffer, 0, buffer != nullptr ? buffer->size : 0);
+    }
+
+    static void* APIENTRY mapNamedBufferRange (GLuint name, GLintptr offset, GLsizeiptr length, GLbitfield) {
+        __sglNullDriver->call(NULL_glMapNamedBufferRange);
+        return map(NULL_glMapNamedBufferRange, __sglNullDriver->buffer(NULL_glMapNamedBufferRange, name), offset, length);
+    }
+
+    static GLboolean APIENTRY unmapBuffer (GLenum target) {
+        __sglNullDriver->call(NULL_glUnmapBuffer);
+        return unmap(NULL_glUnmapBuffer, __sglNullDriver->boundBuffer(NULL_glUnmapBuffer, target));
+    }
+
+    static GLboolean APIENTRY unmapNamedBuffer (GLuint name) {
+        __sglNullDriver->call(NULL_glUnmapNamedBuffer);
+        return unmap(NULL_glUnmapNamedBuffer, __sglNullDriver->buffer(NULL_glUnmapNamedBuffer, name));
+    }
+
+    static void APIENTRY getBufferParameteriv (GLenum target, GLenum pname, GLint* params) {
+        __sglNullDriver->call(NULL_glGetBufferParameteriv);
+        GLint64 value;
+        parameter(__sglNullDriver->boundBuffer(NULL_glGetBufferParameteriv, target), pname, value);
+        *params = static_cast<GLint>(value);
+    }
+
+    static void APIENTRY getBufferParameteri64v (GLenum target, GLenum pname, GLint64* params) {
+        __sglNullDriver->call(NULL_glGetBufferParameteri64v);
+        parameter(__sglNullDriver->boundBuffer(NULL_glGetBufferParameteri64v, target), pname, *params);
+    }
+
+    static void APIENTRY getNamedBufferParameteriv (GLuint name, GLenum pname, GLint* params) {
+        __sglNullDriver->call(NULL_glGetNamedBufferParameteriv);
+        GLint64 value;
+        parameter(__sglNullDriver->buffer(NULL_glGetNamedBufferParameteriv, name), pname, value);
+        *params = static_cast<GLint>(value);
+    }
+
+    static GLboolean APIENTRY isBuffer (GLuint name) {
+        __sglNullDriver->call(NULL_glIsBuffer);
+        return __sglNullDriver->_buffers.count(name) != 0;
+    }
+
+    // Shaders always compile and link
+
+    static void APIENTRY getShaderiv (GLuint, GLenum pname, GLint* params) {
+        __sglNullDriver->call(NULL_glGetShaderiv);
+        *params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY getProgramiv (GLuint, GLenum pname, GLint* params) {
+        __sglNullDriver->call(NULL_glGetProgramiv);
+        *params = pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS ? GL_TRUE : 0;
+    }
+
+    static void infoLog (GLsizei maxLength, GLsizei* length, GLchar* log) {
+        if (length != nullptr) *length = 0;
+        if (log != nullptr && maxLength > 0) log[0] = '\0';
+    }
+
+    static void APIENTRY getShaderInfoLog (GLuint, GLsizei maxLength, GLsizei* length, GLchar* log) {
+        __sglNullDriver->call(NULL_glGetShaderInfoLog);
+        infoLog(maxLength, length, log);
+    }
+
+    static void APIENTRY getProgramInfoLog (GLuint, GLsizei maxLength, GLsizei* length, GLchar* log) {
+        __sglNullDriver->call(NULL_glGetProgramInfoLog);
+        infoLog(maxLength, length, log);
+    }
+
+    static GLint APIENTRY getUniformLocation (GLuint program, const GLchar* name) {
+        __sglNullDriver->call(NULL_glGetUniformLocation);
+        if (!__sglNullDriver->exists(NULL_OBJECT_PROGRAM, program)) {
+            __sglNullDriver->error(NULL_glGetUniformLocation, GL_INVALID_VALUE, format("Unknown program", program));
+            return -1;
+        }
+        return nameHash(name);
+    }
+
+    static GLuint APIENTRY getUniformBlockIndex (GLuint program, const GLchar* name) {
+        __sglNullDriver->call(NULL_glGetUniformBlockIndex);
+        if (!__sglNullDriver->exists(NULL_OBJECT_PROGRAM, program)) {
+            __sglNullDriver->error(NULL_glGetUniformBlockIndex, GL_INVALID_VALUE, format("Unknown program", program));
+            return GL_INVALID_INDEX;
+        }
+        return nameHash(name);
+    }
+
+    // Queries
+
+    static GLenum APIENTRY getError () {
+        __sglNullDriver->call(NULL_glGetError);
+        return __sglNullDriver->popError();
+    }
+
+    static void APIENTRY getIntegerv (GLenum pname, GLint* data) {
+        __sglNullDriver->call(NULL_glGetIntegerv);
+        GLint64 value = 0;
+        __sglNullDriver->getInteger(pname, value);
+        *data = static_cast<GLint>(value);
+    }
+
+    static void APIENTRY getInteger64v (GLenum pname, GLint64* data) {
+        __sglNullDriver->call(NULL_glGetInteger64v);
+        if (pname == GL_TIMESTAMP) {
+            auto t = std::chrono::steady_clock::now().time_since_epoch();
+            *data = std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+            return;
+        }
+        *data = 0;
+        __sglNullDriver->getInteger(pname, *data);
+    }
+
+    static const GLubyte* APIENTRY getString (GLenum name) {
+        __sglNullDriver->call(NULL_glGetString);
+        return __sglNullDriver->string(name);
+    }
+
+    static const GLubyte* APIENTRY getStringi (GLenum name, GLuint index) {
+        __sglNullDriver->call(NULL_glGetStringi);
+        if (name != GL_EXTENSIONS) {
+            __sglNullDriver->error(NULL_glGetStringi, GL_INVALID_ENUM, "glGetStringi only lists extensions");
+            return nullptr;
+        }
+        return __sglNullDriver->extension(index);
+    }
+
+    // Queries complete immediately
+    static void APIENTRY getQueryObjectuiv (GLuint, GLenum pname, GLuint* params) {
+        __sglNullDriver->call(NULL_glGetQueryObjectuiv);
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY getQueryObjectui64v (GLuint, GLenum pname, GLuint64* params) {
+        __sglNullDriver->call(NULL_glGetQueryObjectui64v);
+        *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY getTexParameteriv (GLenum, GLenum, GLint* params) {
+        __sglNullDriver->call(NULL_glGetTexParameteriv);
+        *params = 0;
+    }
+
+    static void APIENTRY getTexParameterfv (GLenum, GLenum, GLfloat* params) {
+        __sglNullDriver->call(NULL_glGetTexParameterfv);
+        *params = 0;
+    }
+
+    static void APIENTRY getRenderbufferParameteriv (GLenum, GLenum, GLint* params) {
+        __sglNullDriver->call(NULL_glGetRenderbufferParameteriv);
+        *params = 0;
+    }
+
+    static void install () {
+#define SGL_NULL_RECORD(name) replace<Record, NULL_##name>(epoxy_##name);
+        SGL_NULL_DRIVER_CALLS(SGL_NULL_RECORD)
+#undef SGL_NULL_RECORD
+
+        replace<Program, NULL_glUniform1f>(epoxy_glUniform1f);
+        replace<Program, NULL_glUniform1fv>(epoxy_glUniform1fv);
+        replace<Program, NULL_glUniform1i>(epoxy_glUniform1i);
+        replace<Program, NULL_glUniform2fv>(epoxy_glUniform2fv);
+        replace<Program, NULL_glUniform3fv>(epoxy_glUniform3fv);
+        replace<Program, NULL_glUniform4fv>(epoxy_glUniform4fv);
+        replace<Program, NULL_glUniformMatrix2fv>(epoxy_glUniformMatrix2fv);
+        replace<Program, NULL_glUniformMatrix3fv>(epoxy_glUniformMatrix3fv);
+        replace<Program, NULL_glUniformMatrix4fv>(epoxy_glUniformMatrix4fv);
+        replace<Program, NULL_glDispatchCompute>(epoxy_glDispatchCompute);
+
+        replace<Draw, NULL_glDrawArrays>(epoxy_glDrawArrays);
+        replace<Draw, NULL_glDrawArraysIndirect>(epoxy_glDrawArraysIndirect);
+        replace<Draw, NULL_glDrawArraysInstanced>(epoxy_glDrawArraysInstanced);
+        replace<Draw, NULL_glDrawElements>(epoxy_glDrawElements);
+        replace<Draw, NULL_glDrawElementsBaseVertex>(epoxy_glDrawElementsBaseVertex);
+        replace<Draw, NULL_glDrawElementsIndirect>(epoxy_glDrawElementsIndirect);
+        replace<Draw, NULL_glDrawElementsInstanced>(epoxy_glDrawElementsInstanced);
+        replace<Draw, NULL_glDrawElementsInstancedBaseVertex>(epoxy_glDrawElementsInstancedBaseVertex);
+        replace<Draw, NULL_glMultiDrawArraysIndirect>(epoxy_glMultiDrawArraysIndirect);
+        replace<Draw, NULL_glMultiDrawElementsIndirect>(epoxy_glMultiDrawElementsIndirect);
+
+        epoxy_glGenBuffers = genBuffers;
+        epoxy_glCreateBuffers = createBuffers;
+        epoxy_glDeleteBuffers = deleteBuffers;
+        epoxy_glGenTextures = genTextures;
+        epoxy_glCreateTextures = createTextures;
+        epoxy_glDeleteTextures = deleteTextures;
+        epoxy_glGenFramebuffers = genFramebuffers;
+        epoxy_glCreateFramebuffers = createFramebuffers;
+        epoxy_glDeleteFramebuffers = deleteFramebuffers;
+        epoxy_glGenRenderbuffers = genRenderbuffers;
+        epoxy_glCreateRenderbuffers = createRenderbuffers;
+        epoxy_glDeleteRenderbuffers = deleteRenderbuffers;
+        epoxy_glGenVertexArrays = genVertexArrays;
+        epoxy_glCreateVertexArrays = createVertexArrays;
+        epoxy_glDeleteVertexArrays = deleteVertexArrays;
+        epoxy_glGenQueries = genQueries;
+        epoxy_glDeleteQueries = deleteQueries;
+        epoxy_glCreateProgram = createProgram;
+        epoxy_glDeleteProgram = deleteProgram;
+        epoxy_glCreateShader = createShader;
+        epoxy_glDeleteShader = deleteShader;
+        epoxy_glFenceSync = fenceSync;
+        epoxy_glClientWaitSync = clientWaitSync;
+
+        epoxy_glActiveTexture = activeTexture;
+        epoxy_glBindBuffer = bindBuffer;
+        epoxy_glBindBufferBase = bindBufferBase;
+        epoxy_glBindBufferRange = bindBufferRange;
+        epoxy_glBindTexture = bindTexture;
+        epoxy_glBindFramebuffer = bindFramebuffer;
+        epoxy_glBindRenderbuffer = bindRenderbuffer;
+        epoxy_glBindVertexArray = bindVertexArray;
+        epoxy_glUseProgram = useProgram;
+
+        epoxy_glBufferData = bufferData;
+        epoxy_glBufferStorage = bufferStorage;
+        epoxy_glBufferSubData = bufferSubData;
+        epoxy_glNamedBufferData = namedBufferData;
+        epoxy_glNamedBufferStorage = namedBufferStorage;
+        epoxy_glNamedBufferSubData = namedBufferSubData;
+        epoxy_glMapBuffer = mapBuffer;
+        epoxy_glMapBufferRange = mapBufferRange;
+        epoxy_glMapNamedBuffer = mapNamedBuffer;
+        epoxy_glMapNamedBufferRange = mapNamedBufferRange;
+        epoxy_glUnmapBuffer = unmapBuffer;
+        epoxy_glUnmapNamedBuffer = unmapNamedBuffer;
+        epoxy_glGetBufferParameteriv = getBufferParameteriv;
+        epoxy_glGetBufferParameteri64v = getBufferParameteri64v;
+        epoxy_glGetNamedBufferParameteriv = getNamedBufferParameteriv;
+        epoxy_glIsBuffer = isBuffer;
+
+        epoxy_glGetShaderiv = getShaderiv;
+        epoxy_glGetProgramiv = getProgramiv;
+        epoxy_glGetShaderInfoLog = getShaderInfoLog;
+        epoxy_glGetProgramInfoLog = getProgramInfoLog;
+        epoxy_glGetUniformLocation = getUniformLocation;
+        epoxy_glGetUniformBlockIndex = getUniformBlockIndex;
+
+        epoxy_glGetError = getError;
+        epoxy_glGetIntegerv = getIntegerv;
+        epoxy_glGetInteger64v = getInteger64v;
+        epoxy_glGetString = getString;
+        epoxy_glGetStringi = getStringi;
+        epoxy_glGetQueryObjectuiv = getQueryObjectuiv;
+        epoxy_glGetQueryObjectui64v = getQueryObjectui64v;
+        epoxy_glGetTexParameteriv = getTexParameteriv;
+        epoxy_glGetTexParameterfv = getTexParameterfv;
+        epoxy_glGetRenderbufferParameteriv = getRenderbufferParameteriv;
+    }
+};
+
+} // end namespace
+} // end namespace
+
+NullDriver::NullDriver (int major, int minor, bool directStateAccess) :
+    _major(major),
+    _minor(minor),
+    _directStateAccess(directStateAccess),
+    _installed(false),
+    _recording(false),
+    _error(GL_NO_ERROR),
+    _nextName(1),
+    _textureUnit(0),
+    strict(false)
+{
+    memset(_saved, 0, sizeof(_saved));
+    memset(_calls, 0, sizeof(_calls));
+
+    std::stringstream version;
+    version << major << "." << minor << " SimpleGL null driver";
+    std::stringstream glsl;
+    glsl << major << "." << minor << "0";
+    _strings.push_back(version.str());
+    _strings.push_back("SimpleGL");
+    _strings.push_back("Null driver");
+    _strings.push_back(glsl.str());
+    _strings.push_back(directStateAccess ? "GL_ARB_direct_state_access" : "");
+    if (directStateAccess) _strings.push_back("GL_ARB_direct_state_access");
+}
+
+NullDriver::~NullDriver () {
+    if (_installed) uninstall();
+}
+
+void NullDriver::install () {
+    if (_installed) return;
+    if (__sglNullDriver != nullptr) throw std::runtime_error("NullDriver: another null driver is installed");
+
+#define SGL_NULL_SAVE(name) _saved[NULL_##name] = reinterpret_cast<NullProc>(epoxy_##name);
+    SGL_NULL_DRIVER_CALLS(SGL_NULL_SAVE)
+#undef SGL_NULL_SAVE
+
+    NullStubs::install();
+    __sglNullDriver = this;
+    _installed = true;
+    sgl::sglInitialize(_major, _minor);
+}
+
+void NullDriver::uninstall () {
+    if (!_installed) return;
+
+#define SGL_NULL_RESTORE(name) epoxy_##name = reinterpret_cast<decltype(epoxy_##name)>(_saved[NULL_##name]);
+    SGL_NULL_DRIVER_CALLS(SGL_NULL_RESTORE)
+#undef SGL_NULL_RESTORE
+
+    __sglNullDriver = nullptr;
+    _installed = false;
+}
+
+uint64_t NullDriver::totalCalls () const {
+    uint64_t total = 0;
+    for (uint64_t c : _calls) total += c;
+    return total;
+}
+
+const char* NullDriver::callName (NullCall call) {
+#define SGL_NULL_NAME(name) #name,
+    static const char* names[] = { SGL_NULL_DRIVER_CALLS(SGL_NULL_NAME) };
+#undef SGL_NULL_NAME
+    return call < NULL_CALL_COUNT ? names[call] : "unknown";
+}
+
+void NullDriver::resetCalls () {
+    memset(_calls, 0, sizeof(_calls));
+    _log.clear();
+}
+
+void NullDriver::clearErrors () {
+    _errors.clear();
+    _error = GL_NO_ERROR;
+}
+
+void NullDriver::error (NullCall call, GLenum error, const std::string& message) {
+    _errors.push_back({call, error, message});
+    if (_error == GL_NO_ERROR) _error = error;
+    if (strict) throw std::runtime_error(std::string("NullDriver: ") + callName(call) + ": " + message);
+}
+
+GLenum NullDriver::popError () {
+    GLenum error = _error;
+    _error = GL_NO_ERROR;
+    return error;
+}
+
+// Texture bindings are per texture unit
+uint64_t NullDriver::bindingKey (GLenum target) const {
+    int slot = detail::bindSlot(target);
+    if (slot >= detail::SLOT_GLOBAL_COUNT && slot < detail::SLOT_COUNT) return (uint64_t(_textureUnit) + 1) << 32 | target;
+    return target;
+}
+
+GLuint NullDriver::bound (GLenum target) const {
+    if (target == GL_FRAMEBUFFER) target = GL_DRAW_FRAMEBUFFER;
+    auto it = _bindings.find(bindingKey(target));
+    return it == _bindings.end() ? 0 : it->second;
+}
+
+size_t NullDriver::liveObjects () const {
+    size_t live = _buffers.size();
+    for (const auto& objects : _objects) live += objects.size();
+    return live;
+}
+
+size_t NullDriver::bufferSize (GLuint buffer) const {
+    auto it = _buffers.find(buffer);
+    return it == _buffers.end() ? 0 : it->second.size;
+}
+
+GLuint NullDriver::genName (NullObject kind) {
+    GLuint name = _nextName++;
+    _objects[kind].insert(name);
+    return name;
+}
+
+GLuint NullDriver::genBuffer () {
+    GLuint name = _nextName++;
+    NullBuffer& buffer = _buffers[name];
+    buffer.size = 0;
+    buffer.immutable = false;
+    buffer.mapped = false;
+    return name;
+}
+
+// Deleting a bound object unbinds it, like OpenGL does
+void NullDriver::deleteName (NullObject kind, GLuint name) {
+    if (name == 0 || _objects[kind].erase(name) == 0) return;
+    for (auto& binding : _bindings) {
+        if (binding.second == name) binding.second = 0;
+    }
+}
+
+void NullDriver::deleteBuffer (GLuint name) {
+    if (name == 0 || _buffers.erase(name) == 0) return;
+    for (auto& binding : _bindings) {
+        if (binding.second == name) binding.second = 0;
+    }
+}
+
+bool NullDriver::exists (NullObject kind, GLuint name) const {
+    return _objects[kind].count(name) != 0;
+}
+
+NullBuffer* NullDriver::buffer (NullCall call, GLuint name) {
+    auto it = _buffers.find(name);
+    if (it != _buffers.end()) return &it->second;
+    error(call, GL_INVALID_OPERATION, format("Unknown buffer", name));
+    return nullptr;
+}
+
+NullBuffer* NullDriver::boundBuffer (NullCall call, GLenum target) {
+    GLuint name = bound(target);
+    if (name == 0) {
+        error(call, GL_INVALID_OPERATION, format("No buffer bound to target", target));
+        return nullptr;
+    }
+    return buffer(call, name);
+}
+
+void NullDriver::bind (NullCall call, GLenum target, NullObject kind, GLuint name) {
+    this->call(call);
+    if (name != 0 && !exists(kind, name)) {
+        error(call, GL_INVALID_OPERATION, format("Binding a name that was never generated:", name));
+        return;
+    }
+    _bindings[bindingKey(target)] = name;
+}
+
+void NullDriver::bindBuffer (NullCall call, GLenum target, GLuint name) {
+    this->call(call);
+    if (name != 0 && _buffers.count(name) == 0) {
+        error(call, GL_INVALID_OPERATION, format("Binding a buffer name that was never generated:", name));
+        return;
+    }
+    _bindings[bindingKey(target)] = name;
+}
+
+void NullDriver::requireProgram (NullCall call) {
+    if (bound(GL_PROGRAM) == 0) error(call, GL_INVALID_OPERATION, "No program in use");
+}
+
+void NullDriver::requireDraw (NullCall call) {
+    requireProgram(call);
+    if (bound(GL_VERTEX_ARRAY) == 0) error(call, GL_INVALID_OPERATION, "No vertex array bound");
+}
+
+bool NullDriver::getInteger (GLenum pname, GLint64& dest) const {
+    switch (pname) {
+    case GL_MAJOR_VERSION:                      dest = _major; return true;
+    case GL_MINOR_VERSION:                      dest = _minor; return true;
+    case GL_NUM_EXTENSIONS:                     dest = _strings.size() - STRING_FIRST_EXTENSION; return true;
+    case GL_CONTEXT_PROFILE_MASK:               dest = GL_CONTEXT_CORE_PROFILE_BIT; return true;
+    case GL_ACTIVE_TEXTURE:                     dest = GL_TEXTURE0 + _textureUnit; return true;
+    case GL_PACK_ALIGNMENT:
+    case GL_UNPACK_ALIGNMENT:                   dest = 4; return true;
+    case GL_MAX_TEXTURE_SIZE:
+    case GL_MAX_RENDERBUFFER_SIZE:              dest = 16384; return true;
+    case GL_MAX_3D_TEXTURE_SIZE:
+    case GL_MAX_ARRAY_TEXTURE_LAYERS:           dest = 2048; return true;
+    case GL_MAX_VERTEX_ATTRIBS:
+    case GL_MAX_VERTEX_ATTRIB_BINDINGS:         dest = 16; return true;
+    case GL_MAX_TEXTURE_IMAGE_UNITS:            dest = 32; return true;
+    case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:   dest = 192; return true;
+    case GL_MAX_UNIFORM_BUFFER_BINDINGS:        dest = 84; return true;
+    case GL_MAX_UNIFORM_BLOCK_SIZE:             dest = 65536; return true;
+    case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:    dest = 256; return true;
+    case GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS: dest = 16; return true;
+    case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT: dest = 16; return true;
+    case GL_MIN_MAP_BUFFER_ALIGNMENT:           dest = 64; return true;
+    case GL_MAX_COLOR_ATTACHMENTS:
+    case GL_MAX_DRAW_BUFFERS:
+    case GL_MAX_SAMPLES:                        dest = 8; return true;
+    default: break;
+    }
+
+    for (GLenum target : __nullTargets) {
+        if (detail::bindingQuery(detail::bindSlot(target)) == pname) {
+            dest = bound(target);
+            return true;
+        }
+    }
+    return false;
+}
+
+const GLubyte* NullDriver::string (GLenum name) {
+    size_t idx;
+    switch (name) {
+    case GL_VERSION:                  idx = STRING_VERSION; break;
+    case GL_VENDOR:                   idx = STRING_VENDOR; break;
+    case GL_RENDERER:                 idx = STRING_RENDERER; break;
+    case GL_SHADING_LANGUAGE_VERSION: idx = STRING_SHADING_LANGUAGE; break;
+    case GL_EXTENSIONS:               idx = STRING_EXTENSIONS; break;
+    default:
+        error(NULL_glGetString, GL_INVALID_ENUM, format("Unknown string", name));
+        return nullptr;
+    }
+    return reinterpret_cast<const GLubyte*>(_strings[idx].c_str());
+}
+
+const GLubyte* NullDriver::extension (GLuint index) {
+    if (index >= _strings.size() - STRING_FIRST_EXTENSION) {
+        error(NULL_glGetStringi, GL_INVALID_VALUE, format("Extension index out of range:", index));
+        return nullptr;
+    }
+    return reinterpret_cast<const GLubyte*>(_strings[STRING_FIRST_EXTENSION + index].c_str());
+}
@@ -0,0 +1,125 @@
+#include <SimpleGL/readback.h>
+#include <SimpleGL/bindcache.h>
+
+#include <string.h>
+
+using namespace sgl;
+
+ReadbackQueue::ReadbackQueue (size_t buffers) :
+    _slots(std::max<size_t>(buffers, 1)),
+    _next(0),
+    _serial(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+detail::ReadbackSlot& ReadbackQueue::acquire (size_t size) {
+    detail::ReadbackSlot& slot = _slots[_next];
+    if (slot.mapped) {
+        throw std::runtime_error("ReadbackQueue: every buffer is in use, release a ReadbackView");
+    }
+
+    // OpenGL orders the new read after the old one, so a result nobody
+    // mapped can be dropped without waiting
+    if (slot.pending) _stats.dropped += 1;
+    if (slot.fence != nullptr) glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    slot.pending = false;
+
+    if (slot.capacity < size) {
+        detail::GLBufferInterface<GL_PIXEL_PACK_BUFFER>::initializeMut(slot.buffer, NULL, size, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+    slot.size = size;
+    _next = (_next + 1) % _slots.size();
+    return slot;
+}
+
+ReadbackTicket ReadbackQueue::submit (detail::ReadbackSlot& slot) {
+    if (SGL_SYNC_SUPPORTED) slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.serial = ++_serial;
+    slot.pending = true;
+    _stats.reads += 1;
+    sglDbgCatchGLError();
+    return ReadbackTicket{this, (size_t)(&slot - &_slots[0]), slot.serial};
+}
+
+ReadbackTicket ReadbackQueue::read (GLuint framebuffer, GLint x, GLint y, GLsizei width, GLsizei height,
+                                    GLenum format, GLenum type, GLenum attachment)
+{
+    GLint align = 4;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &align);
+    size_t stride = detail::alignUp(width * traits::formatSize(traits::sizedFormat(format, type)), align);
+
+    detail::ReadbackSlot& slot = acquire(stride * height);
+    slot.width = width;
+    slot.height = height;
+    slot.stride = stride;
+
+    // Headless contexts stand in a framebuffer for 0, which has no back buffer
+    framebuffer = detail::framebufferName(framebuffer);
+    sgl::bind<GL_READ_FRAMEBUFFER>(framebuffer);
+    if (framebuffer == 0 && attachment == GL_COLOR_ATTACHMENT0) attachment = GL_BACK;
+    glReadBuffer(attachment);
+    sgl::bind<GL_PIXEL_PACK_BUFFER>(slot.buffer);
+    glReadPixels(x, y, width, height, format, type, 0);
+    sgl::bind<GL_PIXEL_PACK_BUFFER>(0);
+    return submit(slot);
+}
+
+const void* ReadbackQueue::mapSlot (size_t idx) {
+    detail::ReadbackSlot& slot = _slots[idx];
+    if (detail::waitFence(slot.fence)) _stats.stalls += 1;
+    if (slot.fence != nullptr) glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    const void* data = detail::mapBufferRange<GL_PIXEL_PACK_BUFFER>(slot.buffer, 0, slot.size, GL_MAP_READ_BIT);
+    // Leave pack buffer unbound so later glReadPixels calls read to client memory
+    if (!SGL_DSA_SUPPORTED) sgl::bind<GL_PIXEL_PACK_BUFFER>(0);
+    sglDbgCatchGLError();
+
+    slot.pending = false;
+    slot.mapped = true;
+    _stats.resolved += 1;
+    return data;
+}
+
+void ReadbackQueue::unmapSlot (size_t idx) {
+    detail::ReadbackSlot& slot = _slots[idx];
+    if (!slot.mapped) return;
+    detail::unmapBuffer<GL_PIXEL_PACK_BUFFER>(slot.buffer);
+    if (!SGL_DSA_SUPPORTED) sgl::bind<GL_PIXEL_PACK_BUFFER>(0);
+    slot.mapped = false;
+}
+
+size_t ReadbackQueue::pending () const {
+    size_t count = 0;
+    for (const auto& slot : _slots) {
+        if (slot.pending) count += 1;
+    }
+    return count;
+}
+
+void ReadbackQueue::release () {
+    for (auto& slot : _slots) {
+        if (slot.mapped) unmapSlot(&slot - &_slots[0]);
+        if (slot.fence != nullptr) glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        slot.pending = false;
+        slot.buffer.release();
+    }
+    _slots.clear();
+}
+
+bool ReadbackTicket::valid () const {
+    if (queue == nullptr || slot >= queue->_slots.size()) return false;
+    const detail::ReadbackSlot& s = queue->_slots[slot];
+    return s.serial == serial && s.pending;
+}
+
+bool ReadbackTicket::ready () const {
+    if (!valid()) return false;
+    GLsync fence = queue->_slots[slot].fence;
+    if (fence == nullptr) return true;
+    return glClientWaitSync(fence, 0, 0) != GL_TIMEOUT_EXPIRED;
+}
@@ -0,0 +1,117 @@
+#include <SimpleGL/renderpass.h>
+#include <SimpleGL/utils.h>
+
+#include <string.h>
+#include <stdexcept>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+RenderPass::RenderPass (GLuint framebuffer) :
+    _framebuffer(detail::framebufferName(framebuffer)),
+    _colorCount(0),
+    _clearDepth(1.0f),
+    _clearStencil(0)
+{
+    memset(_colors, 0, sizeof(_colors));
+    memset(&_depth, 0, sizeof(_depth));
+    memset(&_stencil, 0, sizeof(_stencil));
+}
+
+// The default framebuffer names its buffers rather than attachments
+GLenum RenderPass::colorAttachment (GLuint idx) const {
+    return _framebuffer == 0 ? GL_COLOR : GL_COLOR_ATTACHMENT0 + idx;
+}
+
+GLenum RenderPass::depthAttachment () const {
+    return _framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+}
+
+GLenum RenderPass::stencilAttachment () const {
+    return _framebuffer == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+}
+
+RenderPass& RenderPass::color (GLuint idx, LoadAction load, StoreAction store) {
+    if (idx >= SGL_MAX_PASS_COLORS) throw std::runtime_error("RenderPass: color attachment exceeds SGL_MAX_PASS_COLORS");
+    if (_framebuffer == 0 && idx != 0) throw std::runtime_error("RenderPass: the default framebuffer has a single color buffer");
+    PassAttachment& color = _colors[idx];
+    color.used = true;
+    color.load = load;
+    color.store = store;
+    if (idx >= _colorCount) _colorCount = idx + 1;
+    return *this;
+}
+
+RenderPass& RenderPass::clearColor (GLuint idx, GLfloat r, GLfloat g, GLfloat b, GLfloat a, StoreAction store) {
+    color(idx, LOAD_CLEAR, store);
+    GLfloat* clear = _colors[idx].clear;
+    clear[0] = r;
+    clear[1] = g;
+    clear[2] = b;
+    clear[3] = a;
+    return *this;
+}
+
+RenderPass& RenderPass::depth (LoadAction load, StoreAction store, GLfloat clear) {
+    _depth.used = true;
+    _depth.load = load;
+    _depth.store = store;
+    _clearDepth = clear;
+    return *this;
+}
+
+RenderPass& RenderPass::stencil (LoadAction load, StoreAction store, GLint clear) {
+    _stencil.used = true;
+    _stencil.load = load;
+    _stencil.store = store;
+    _clearStencil = clear;
+    return *this;
+}
+
+// Invalidate the attachments discarded on load (atStart) or store
+void RenderPass::invalidate (bool atStart) {
+    GLenum attachments[SGL_MAX_PASS_COLORS + 2];
+    GLsizei count = 0;
+    auto discarded = [atStart] (const PassAttachment& a) {
+        return a.used && (atStart ? a.load == LOAD_DISCARD : a.store == STORE_DISCARD);
+    };
+    for (GLuint i = 0; i < _colorCount; i++) {
+        if (discarded(_colors[i])) attachments[count++] = colorAttachment(i);
+    }
+    if (discarded(_depth)) attachments[count++] = depthAttachment();
+    if (discarded(_stencil)) attachments[count++] = stencilAttachment();
+    if (count == 0 || !SGL_INVALIDATEFRAMEBUFFER_SUPPORTED) return;
+
+    if (SGL_DSA_SUPPORTED) glInvalidateNamedFramebufferData(_framebuffer, count, attachments);
+    else glInvalidateFramebuffer(GL_FRAMEBUFFER, count, attachments);
+}
+
+void RenderPass::begin () {
+    sgl::bind<GL_FRAMEBUFFER>(_framebuffer);
+
+    // Draw buffer i is color attachment i, so glClearBuffer indices match
+    if (_framebuffer != 0 && _colorCount > 0) {
+        GLenum buffers[SGL_MAX_PASS_COLORS];
+        for (GLuint i = 0; i < _colorCount; i++) {
+            buffers[i] = _colors[i].used ? GL_COLOR_ATTACHMENT0 + i : GL_NONE;
+        }
+        glDrawBuffers(_colorCount, buffers);
+    }
+
+    invalidate(true);
+
+    for (GLuint i = 0; i < _colorCount; i++) {
+        if (_colors[i].used && _colors[i].load == LOAD_CLEAR) glClearBufferfv(GL_COLOR, i, _colors[i].clear);
+    }
+    bool clearDepth = _depth.used && _depth.load == LOAD_CLEAR;
+    bool clearStencil = _stencil.used && _stencil.load == LOAD_CLEAR;
+    if (clearDepth && clearStencil) glClearBufferfi(GL_DEPTH_STENCIL, 0, _clearDepth, _clearStencil);
+    else if (clearDepth) glClearBufferfv(GL_DEPTH, 0, &_clearDepth);
+    else if (clearStencil) glClearBufferiv(GL_STENCIL, 0, &_clearStencil);
+    sglDbgCatchGLError();
+}
+
+void RenderPass::end () {
+    invalidate(false);
+    sglDbgCatchGLError();
+}
@@ -0,0 +1,220 @@
+#include <SimpleGL/renderqueue.h>
+#include <SimpleGL/bindcache.h>
+#include <SimpleGL/utils.h>
+
+#include <stdexcept>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+DrawItem& DrawItem::texture (GLuint unit, GLenum target, GLuint name) {
+    if (unit >= SGL_RENDERQUEUE_TEXTURES) throw std::runtime_error("DrawItem: texture unit exceeds SGL_RENDERQUEUE_TEXTURES");
+    textures.targets[unit] = target;
+    textures.names[unit] = name;
+    if (unit >= textureCount) textureCount = unit + 1;
+    return *this;
+}
+
+DrawItem& DrawItem::uniformBlock (GLResource<GL_UNIFORM_BUFFER>& buffer, GLuint unit, size_t offset, size_t size) {
+    ubo = buffer;
+    uboUnit = unit;
+    uboOffset = offset;
+    uboSize = size;
+    return *this;
+}
+
+DrawItem& DrawItem::uniformBlock (UniformArena& arena, const UniformSlot& slot, GLuint unit) {
+    GLResource<GL_UNIFORM_BUFFER> buffer = arena;
+    return uniformBlock(buffer, unit, arena.offset(slot), slot.size);
+}
+
+DrawItem& DrawItem::elements (GLenum mode, GLsizei count, GLenum type, size_t offset, GLint baseVertex) {
+    this->mode = mode;
+    this->count = count;
+    this->indexType = type;
+    this->offset = offset;
+    this->baseVertex = baseVertex;
+    return *this;
+}
+
+DrawItem& DrawItem::arrays (GLenum mode, GLint first, GLsizei count) {
+    this->mode = mode;
+    this->first = first;
+    this->count = count;
+    this->indexType = GL_NONE;
+    return *this;
+}
+
+DrawItem& DrawItem::instanced (GLsizei instances) {
+    this->instances = instances;
+    return *this;
+}
+
+DrawItem& DrawItem::sortLayer (uint8_t layer) {
+    this->layer = layer;
+    return *this;
+}
+
+DrawItem& DrawItem::sortDepth (float depth) {
+    if (depth < 0) depth = 0;
+    if (depth > 1) depth = 1;
+    this->depth = static_cast<uint8_t>(depth * 255.0f);
+    return *this;
+}
+
+// Dense id for value, handing out the next one from first if it hasn't been
+// seen. Ids saturate at 0xffff, which only costs sorting quality.
+template <class Map, class K>
+static uint16_t denseId (Map& ids, const K& value, size_t first = 0) {
+    auto it = ids.find(value);
+    if (it != ids.end()) return it->second;
+    size_t next = first + ids.size();
+    uint16_t id = next < 0xffff ? static_cast<uint16_t>(next) : 0xffff;
+    ids.insert(std::make_pair(value, id));
+    return id;
+}
+
+// Count the state changes needed to go from prev (nullptr at the start) to item
+static void countChanges (const DrawItem* prev, const DrawItem& item, RenderQueueStats& stats) {
+    if (prev == nullptr || prev->program != item.program) stats.programChanges += 1;
+    if (prev == nullptr || prev->vao != item.vao) stats.vaoChanges += 1;
+    for (GLuint unit = 0; unit < item.textureCount; unit++) {
+        if (prev == nullptr || unit >= prev->textureCount || prev->textures.names[unit] != item.textures.names[unit]) stats.textureChanges += 1;
+    }
+    if (item.ubo != 0 && (prev == nullptr || prev->ubo != item.ubo || prev->uboUnit != item.uboUnit ||
+                          prev->uboOffset != item.uboOffset || prev->uboSize != item.uboSize)) {
+        stats.bufferChanges += 1;
+    }
+}
+
+RenderQueue::RenderQueue () {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+DrawItem& RenderQueue::add (GLuint program, GLuint vao) {
+    DrawItem item;
+    memset(&item, 0, sizeof(item));
+    item.program = program;
+    item.vao = vao;
+    item.mode = GL_TRIANGLES;
+    item.indexType = GL_NONE;
+    item.instances = 1;
+    _items.push_back(item);
+    return _items.back();
+}
+
+uint64_t RenderQueue::key (const DrawItem& item) {
+    uint64_t program = denseId(_programs, item.program);
+    uint64_t vao = denseId(_vaos, item.vao);
+    // Texture set ids start at 1, 0 is kept for items without textures
+    uint64_t textures = item.textureCount == 0 ? 0 : denseId(_textureSets, item.textures, 1);
+    return (uint64_t(item.layer) << KEY_LAYER_SHIFT) |
+           (program << KEY_PROGRAM_SHIFT) |
+           (textures << KEY_TEXTURES_SHIFT) |
+           (vao << KEY_VAO_SHIFT) |
+           (uint64_t(item.depth) << KEY_DEPTH_SHIFT);
+}
+
+// LSD radix sort of _keys, carrying _order along. Stable, so items with
+// equal keys are drawn in submission order.
+void RenderQueue::sort () {
+    size_t n = _keys.size();
+    _keysTmp.resize(n);
+    _orderTmp.resize(n);
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t counts[256] = {0};
+        for (size_t i = 0; i < n; i++) counts[(_keys[i] >> shift) & 0xff] += 1;
+        // Every key shares this byte, the pass wouldn't move anything
+        if (counts[(_keys[0] >> shift) & 0xff] == n) continue;
+
+        size_t offsets[256];
+        size_t total = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = total;
+            total += counts[b];
+        }
+        for (size_t i = 0; i < n; i++) {
+            size_t dst = offsets[(_keys[i] >> shift) & 0xff]++;
+            _keysTmp[dst] = _keys[i];
+            _orderTmp[dst] = _order[i];
+        }
+        _keys.swap(_keysTmp);
+        _order.swap(_orderTmp);
+    }
+}
+
+void RenderQueue::flush () {
+    memset(&_stats, 0, sizeof(_stats));
+    if (_items.empty()) return;
+
+    _keys.resize(_items.size());
+    _order.resize(_items.size());
+    for (size_t i = 0; i < _items.size(); i++) {
+        _keys[i] = key(_items[i]);
+        _order[i] = i;
+    }
+    sort();
+
+    // What submission order would have cost
+    RenderQueueStats unsorted;
+    memset(&unsorted, 0, sizeof(unsorted));
+    for (size_t i = 0; i < _items.size(); i++) {
+        countChanges(i == 0 ? nullptr : &_items[i - 1], _items[i], unsorted);
+    }
+
+    BindCache* cache = detail::currentBindCache();
+    const DrawItem* prev = nullptr;
+    for (size_t i = 0; i < _order.size(); i++) {
+        const DrawItem& item = _items[_order[i]];
+        countChanges(prev, item, _stats);
+
+        if (prev == nullptr || prev->program != item.program) sgl::bind<GL_PROGRAM>(item.program);
+        if (prev == nullptr || prev->vao != item.vao) sgl::bind<GL_VERTEX_ARRAY>(item.vao);
+        for (GLuint unit = 0; unit < item.textureCount; unit++) {
+            GLuint name = item.textures.names[unit];
+            if (prev != nullptr && unit < prev->textureCount && prev->textures.names[unit] == name) continue;
+            sgl::activeTexture(unit);
+            sgl::bindTexture(item.textures.targets[unit], name);
+        }
+        if (item.ubo != 0 && (prev == nullptr || prev->ubo != item.ubo || prev->uboUnit != item.uboUnit ||
+                              prev->uboOffset != item.uboOffset || prev->uboSize != item.uboSize)) {
+            if (item.uboSize == 0) glBindBufferBase(GL_UNIFORM_BUFFER, item.uboUnit, item.ubo);
+            else glBindBufferRange(GL_UNIFORM_BUFFER, item.uboUnit, item.ubo, item.uboOffset, item.uboSize);
+            sglCountBind(GL_UNIFORM_BUFFER);
+            if (cache != nullptr) cache->note(GL_UNIFORM_BUFFER, item.ubo);
+        }
+
+        if (item.indexType == GL_NONE) {
+            if (item.instances == 1) glDrawArrays(item.mode, item.first, item.count);
+            else glDrawArraysInstanced(item.mode, item.first, item.count, item.instances);
+        } else {
+            const void* offset = reinterpret_cast<const void*>(item.offset);
+            if (item.baseVertex != 0) glDrawElementsInstancedBaseVertex(item.mode, item.count, item.indexType, offset, item.instances, item.baseVertex);
+            else if (item.instances == 1) glDrawElements(item.mode, item.count, item.indexType, offset);
+            else glDrawElementsInstanced(item.mode, item.count, item.indexType, offset, item.instances);
+        }
+        sglCountDraw();
+        prev = &item;
+    }
+
+    _stats.draws = _items.size();
+    // Layers can force more changes than submission order needed
+    auto saved = [] (uint64_t before, uint64_t after) { return before > after ? before - after : 0; };
+    _stats.programSaved = saved(unsorted.programChanges, _stats.programChanges);
+    _stats.vaoSaved = saved(unsorted.vaoChanges, _stats.vaoChanges);
+    _stats.textureSaved = saved(unsorted.textureChanges, _stats.textureChanges);
+    _stats.bufferSaved = saved(unsorted.bufferChanges, _stats.bufferChanges);
+    _items.clear();
+    sglDbgCatchGLError();
+}
+
+void RenderQueue::clear () {
+    _items.clear();
+}
+
+void RenderQueue::resetIds () {
+    _programs.clear();
+    _vaos.clear();
+    _textureSets.clear();
+}
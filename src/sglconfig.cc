@@ -6,18 +6,35 @@ using namespace sgl::config;
 struct SGL_OPENGL_STATE {
     int version_major = SGL_OPENGL_MAX_MAJOR;
     int version_minor = SGL_OPENGL_MAX_MINOR;
+    bool dsa = false;
+    bool pipelineStatistics = false;
 };
 
 static SGL_OPENGL_STATE __sglOpenGLState__;
 
 bool sgl::config::sglOpenglVersion (int major, int minor) {
-    return __sglOpenGLState__.version_major >= major && __sglOpenGLState__.version_minor >= minor;
+    if (__sglOpenGLState__.version_major != major) return __sglOpenGLState__.version_major > major;
+    return __sglOpenGLState__.version_minor >= minor;
+}
+
+bool sgl::config::sglDirectStateAccess () {
+    return __sglOpenGLState__.dsa;
+}
+
+bool sgl::config::sglPipelineStatistics () {
+    return __sglOpenGLState__.pipelineStatistics;
 }
 
 void sgl::sglInitialize (int major, int minor) {
     __sglOpenGLState__.version_major = major;
     __sglOpenGLState__.version_minor = minor;
+#if !defined(SGL_USE_GLES) && !defined(SGL_NO_GL)
+    // Requires a current context
+    __sglOpenGLState__.dsa = sglOpenglVersion(4,5) || epoxy_has_gl_extension("GL_ARB_direct_state_access");
+    __sglOpenGLState__.pipelineStatistics = sglOpenglVersion(4,6) || epoxy_has_gl_extension("GL_ARB_pipeline_statistics_query");
+#endif
 #if SGL_DEBUG >= 1
     printf("SGL OpenGL Version %d.%d\n", major, minor);
+    printf("SGL Direct State Access %s\n", __sglOpenGLState__.dsa ? "enabled" : "disabled");
 #endif
 }
@@ -1,4 +1,5 @@
 #include <SimpleGL/shader.h>
+#include <SimpleGL/uniformarena.h>
 
 using namespace sgl;
 
@@ -86,6 +87,7 @@ GLint Shader::setUniformMatrix4f (std::string& id, float * matrix){
     int loc = glGetUniformLocation(_id, id.c_str());
     if (loc == -1) return loc;
     glUniformMatrix4fv(loc, 1, false, matrix);
+    sglCountUniform();
     return loc;
 }
 
@@ -93,6 +95,7 @@ GLint Shader::setUniformMatrix4f (const char * id, float * matrix){
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniformMatrix4fv(loc, 1, false, matrix);
+    sglCountUniform();
     return loc;
 }
 
@@ -100,6 +103,7 @@ GLint Shader::setUniformMatrix3f (std::string& id, float * matrix){
     int loc = glGetUniformLocation(_id, id.c_str());
     if (loc == -1) return loc;
     glUniformMatrix3fv(loc, 1, false, matrix);
+    sglCountUniform();
     return loc;
 }
 
@@ -107,6 +111,7 @@ GLint Shader::setUniformMatrix3f (const char * id, float * matrix){
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniformMatrix3fv(loc, 1, false, matrix);
+    sglCountUniform();
     return loc;
 }
 
@@ -114,6 +119,7 @@ GLint Shader::setUniformMatrix2f (std::string& id, float * matrix){
     int loc = glGetUniformLocation(_id, id.c_str());
     if (loc == -1) return loc;
     glUniformMatrix2fv(loc, 1, false, matrix);
+    sglCountUniform();
     return loc;
 }
 
@@ -121,6 +127,7 @@ GLint Shader::setUniformMatrix2f (const char * id, float * matrix){
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniformMatrix2fv(loc, 1, false, matrix);
+    sglCountUniform();
     return loc;
 }
 
@@ -129,6 +136,7 @@ GLint Shader::setUniform1f (const char * id, float v) {
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniform1f(loc, v);
+    sglCountUniform();
     return loc;
 }
 
@@ -136,6 +144,7 @@ GLint Shader::setUniform2fv (std::string& id, float * vector){
     int loc = glGetUniformLocation(_id, id.c_str());
     if (loc == -1) return loc;
     glUniform2fv(loc,1,vector);
+    sglCountUniform();
     return loc;
 }
 
@@ -143,6 +152,7 @@ GLint Shader::setUniform2fv (const char * id, float * vector){
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniform2fv(loc,1,vector);
+    sglCountUniform();
     return loc;
 }
 
@@ -151,6 +161,7 @@ GLint Shader::setUniform2fv (const char * id, float x, float y){
     if (loc == -1) return loc;
     float temp[2] = {x,y};
     glUniform2fv(loc,1,temp);
+    sglCountUniform();
     return loc;
 }
 
@@ -158,6 +169,7 @@ GLint Shader::setUniform3fv (std::string& id, float * vector){
     int loc = glGetUniformLocation(_id, id.c_str());
     if (loc == -1) return loc;
     glUniform3fv(loc,1,vector);
+    sglCountUniform();
     return loc;
 }
 
@@ -165,6 +177,7 @@ GLint Shader::setUniform3fv (const char * id, float * vector){
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniform3fv(loc,1,vector);
+    sglCountUniform();
     return loc;
 }
 
@@ -173,6 +186,7 @@ GLint Shader::setUniform3fv (const char * id, float x, float y, float z) {
     if (loc == -1) return loc;
     float temp[3] = {x,y,z};
     glUniform3fv(loc,1,temp);
+    sglCountUniform();
     return loc;
 }
 
@@ -180,6 +194,7 @@ GLint Shader::setUniform4fv (const char * id, float * vec) {
     int loc = glGetUniformLocation(_id,id);
     if (loc == -1) return loc;
     glUniform4fv(loc,1,vec);
+    sglCountUniform();
     return loc;
 }
 
@@ -187,6 +202,7 @@ GLint Shader::setUniform4fv (std::string& id, float * vec) {
     int loc = glGetUniformLocation(_id,id.c_str());
     if (loc == -1) return loc;
     glUniform4fv(loc,1,vec);
+    sglCountUniform();
     return loc;
 }
 
@@ -195,6 +211,7 @@ GLint Shader::setUniform4fv (const char * id, float x, float y, float z, float w
     if (loc == -1) return loc;
     float temp [4] {x,y,z,w};
     glUniform4fv(loc,1,temp);
+    sglCountUniform();
     return loc;
 }
 
@@ -202,6 +219,7 @@ GLint Shader::setUniformBool (const char * id, bool v){
     int loc = glGetUniformLocation(_id, id);
     if (loc == -1) return loc;
     glUniform1i(loc, v ? 1 : 0);
+    sglCountUniform();
     return loc;
 }
 
@@ -209,8 +227,9 @@ GLint Shader::setTexture (const std::string& id, GLenum target, GLuint handle, i
     int loc = glGetUniformLocation(_id,id.c_str());
     if (loc == -1) return loc;
     glUniform1i(loc, textureUnit);
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    glBindTexture(target, handle);
+    sglCountUniform();
+    sgl::activeTexture(textureUnit);
+    sgl::bindTexture(target, handle);
     return loc;
 }
 
@@ -218,6 +237,24 @@ GLint Shader::setUniformBlock(const char * id, GLResource<GL_UNIFORM_BUFFER>& bu
     unsigned int idx = glGetUniformBlockIndex(_id,id);
     if (idx == GL_INVALID_INDEX) return idx;
     glBindBufferBase(GL_UNIFORM_BUFFER, unit, static_cast<GLuint>(buffer));
+    // glBindBufferBase also binds the generic GL_UNIFORM_BUFFER target
+    BindCache* cache = sgl::getBindCache();
+    if (cache != nullptr) cache->note(GL_UNIFORM_BUFFER, buffer);
     glUniformBlockBinding(_id, idx, unit);
     return idx;
 }
+
+GLint Shader::setUniformBlock(const char * id, GLResource<GL_UNIFORM_BUFFER>& buffer, GLuint unit, size_t offset, size_t size) {
+    unsigned int idx = glGetUniformBlockIndex(_id,id);
+    if (idx == GL_INVALID_INDEX) return idx;
+    glBindBufferRange(GL_UNIFORM_BUFFER, unit, static_cast<GLuint>(buffer), offset, size);
+    BindCache* cache = sgl::getBindCache();
+    if (cache != nullptr) cache->note(GL_UNIFORM_BUFFER, buffer);
+    glUniformBlockBinding(_id, idx, unit);
+    return idx;
+}
+
+GLint Shader::setUniformBlock(const char * id, UniformArena& arena, const UniformSlot& slot, GLuint unit) {
+    GLResource<GL_UNIFORM_BUFFER> buffer = arena;
+    return setUniformBlock(id, buffer, unit, arena.offset(slot), slot.size);
+}
@@ -0,0 +1,210 @@
+#include <SimpleGL/trace.h>
+#include <SimpleGL/gpuprofiler.h>
+#include <SimpleGL/utils.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+std::atomic<Tracer*> sgl::detail::__sglTracer{nullptr};
+
+static std::atomic<uint32_t> __sglNextTraceThread{TRACE_GPU_THREAD + 1};
+
+uint32_t sgl::traceThread () {
+    static thread_local uint32_t id = 0;
+    if (id == 0) id = __sglNextTraceThread.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+static uint64_t steadyNs () {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+}
+
+static size_t ringSize (size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    return size;
+}
+
+Tracer::Tracer (size_t capacity) :
+    _slots(new TraceSlot[ringSize(capacity)]),
+    _mask(ringSize(capacity) - 1),
+    _head(0),
+    _tail(0),
+    _frame(0),
+    _frameBegin(0),
+    _epoch(steadyNs()),
+    _gpuOffset(0),
+    _gpuFrame(0),
+    _calibrated(false)
+{
+    // No index has sequence 0, so fresh slots read as empty
+    for (size_t i = 0; i <= _mask; i++) _slots[i].sequence.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Tracer::now () const {
+    return steadyNs() - _epoch;
+}
+
+void Tracer::record (const char* category, const char* name, uint64_t beginNs, uint64_t endNs,
+                     const char* argName, uint64_t arg) {
+    record(category, name, beginNs, endNs, argName, arg, traceThread(), frame());
+}
+
+void Tracer::record (const char* category, const char* name, uint64_t beginNs, uint64_t endNs,
+                     const char* argName, uint64_t arg, uint32_t thread, uint64_t frame) {
+    uint64_t idx = _head.fetch_add(1, std::memory_order_relaxed);
+    TraceSlot& slot = _slots[idx & _mask];
+
+    // Odd while writing, so readers skip the slot
+    slot.sequence.store(2 * idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceEvent& event = slot.event;
+    strncpy(event.name, name != nullptr ? name : "", SGL_TRACE_NAME - 1);
+    event.name[SGL_TRACE_NAME - 1] = '\0';
+    event.category = category;
+    event.argName = argName;
+    event.arg = arg;
+    event.beginNs = beginNs;
+    event.endNs = std::max(beginNs, endNs);
+    event.frame = frame;
+    event.thread = thread;
+
+    slot.sequence.store(2 * idx + 2, std::memory_order_release);
+}
+
+void Tracer::endFrame () {
+    uint64_t end = now();
+    uint64_t begin = _frameBegin.exchange(end, std::memory_order_relaxed);
+    record("frame", "frame", begin, end, nullptr, 0, traceThread(), frame());
+    _frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Tracer::calibrateGpuClock () {
+    if (!SGL_TIMERQUERY_SUPPORTED) return;
+    GLint64 gpu = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu);
+    _gpuOffset = static_cast<int64_t>(now()) - static_cast<int64_t>(gpu);
+    _calibrated = true;
+    sglDbgCatchGLError();
+}
+
+void Tracer::addGpuFrame (const GpuProfiler& profiler) {
+    const std::vector<GpuSample>& samples = profiler.resolved();
+    if (samples.empty() || samples[0].frame < _gpuFrame) return;
+    _gpuFrame = samples[0].frame + 1;
+
+    if (!_calibrated) calibrateGpuClock();
+    if (!_calibrated) return;
+
+    auto toTracer = [this] (uint64_t ns) {
+        int64_t t = static_cast<int64_t>(ns) + _gpuOffset;
+        return t < 0 ? uint64_t(0) : uint64_t(t);
+    };
+    for (const auto& sample : samples) {
+        record("gpu", profiler.scopeName(sample.scope).c_str(), toTracer(sample.beginNs), toTracer(sample.endNs),
+               nullptr, 0, TRACE_GPU_THREAD, sample.frame);
+    }
+}
+
+std::vector<TraceEvent> Tracer::events () const {
+    uint64_t head = _head.load(std::memory_order_acquire);
+    uint64_t first = _tail.load(std::memory_order_relaxed);
+    if (head > capacity() && head - capacity() > first) first = head - capacity();
+
+    std::vector<TraceEvent> result;
+    result.reserve(head - first);
+    for (uint64_t idx = first; idx < head; idx++) {
+        const TraceSlot& slot = _slots[idx & _mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * idx + 2) continue;
+        TraceEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+        result.push_back(event);
+    }
+
+    std::stable_sort(result.begin(), result.end(), [] (const TraceEvent& a, const TraceEvent& b) {
+        return a.beginNs < b.beginNs;
+    });
+    return result;
+}
+
+uint64_t Tracer::dropped () const {
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    uint64_t tail = _tail.load(std::memory_order_relaxed);
+    return head - tail > capacity() ? head - tail - capacity() : 0;
+}
+
+void Tracer::clear () {
+    _tail.store(_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+static void writeString (std::ostream& out, const char* str) {
+    out << '"';
+    for (const char* c = str; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') out << '\\' << *c;
+        else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            out << escaped;
+        } else out << *c;
+    }
+    out << '"';
+}
+
+static void writeMetadata (std::ostream& out, const char* kind, uint32_t thread, const char* name) {
+    out << "{\"name\":\"" << kind << "\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":";
+    writeString(out, name);
+    out << "}},\n";
+}
+
+void Tracer::write (std::ostream& out) const {
+    std::vector<TraceEvent> events = this->events();
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    writeMetadata(out, "process_name", 0, "SimpleGL");
+    writeMetadata(out, "thread_name", TRACE_GPU_THREAD, "GPU");
+    std::set<uint32_t> threads;
+    for (const auto& event : events) {
+        if (event.thread == TRACE_GPU_THREAD || !threads.insert(event.thread).second) continue;
+        std::string name = "Thread " + std::to_string(event.thread);
+        writeMetadata(out, "thread_name", event.thread, name.c_str());
+    }
+
+    // Timestamps and durations are in microseconds
+    char time[64];
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        out << "{\"name\":";
+        writeString(out, event.name);
+        out << ",\"cat\":";
+        writeString(out, event.category != nullptr ? event.category : "");
+        snprintf(time, sizeof(time), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", event.beginNs / 1e3, (event.endNs - event.beginNs) / 1e3);
+        out << time << ",\"pid\":1,\"tid\":" << event.thread << ",\"args\":{\"frame\":" << event.frame;
+        if (event.argName != nullptr) {
+            out << ',';
+            writeString(out, event.argName);
+            out << ':' << event.arg;
+        }
+        out << "}}" << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+}
+
+void Tracer::save (const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Tracer: unable to open " + path);
+    write(out);
+    if (!out) throw std::runtime_error("Tracer: unable to write " + path);
+}
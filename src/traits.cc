@@ -4,6 +4,7 @@
 size_t sgl::traits::formatSize (GLenum fmt) {
     switch(fmt) {
     case GL_R: return 1;
+    case GL_RED: return 1;
     case GL_R8: return 1;
     case GL_R8_SNORM: return 1;
     case GL_R16F: return 2;
@@ -64,3 +65,45 @@ size_t sgl::traits::formatSize (GLenum fmt) {
     default: return 1;
     }
 }
+
+GLenum sgl::traits::sizedFormat (GLenum iformat, GLenum dataType) {
+    switch (iformat) {
+    case GL_R:
+    case GL_RED:
+        switch (dataType) {
+        case GL_FLOAT: return GL_R32F;
+        case GL_HALF_FLOAT: return GL_R16F;
+        case GL_UNSIGNED_SHORT: return GL_R16;
+        default: return GL_R8;
+        }
+    case GL_RG:
+        switch (dataType) {
+        case GL_FLOAT: return GL_RG32F;
+        case GL_HALF_FLOAT: return GL_RG16F;
+        case GL_UNSIGNED_SHORT: return GL_RG16;
+        default: return GL_RG8;
+        }
+    case GL_RGB:
+        switch (dataType) {
+        case GL_FLOAT: return GL_RGB32F;
+        case GL_HALF_FLOAT: return GL_RGB16F;
+        case GL_UNSIGNED_SHORT: return GL_RGB16;
+        default: return GL_RGB8;
+        }
+    case GL_RGBA:
+        switch (dataType) {
+        case GL_FLOAT: return GL_RGBA32F;
+        case GL_HALF_FLOAT: return GL_RGBA16F;
+        case GL_UNSIGNED_SHORT: return GL_RGBA16;
+        default: return GL_RGBA8;
+        }
+    case GL_DEPTH_COMPONENT:
+        switch (dataType) {
+        case GL_FLOAT: return GL_DEPTH_COMPONENT32F;
+        case GL_UNSIGNED_SHORT: return GL_DEPTH_COMPONENT16;
+        default: return GL_DEPTH_COMPONENT24;
+        }
+    case GL_DEPTH_STENCIL: return GL_DEPTH24_STENCIL8;
+    default: return iformat;
+    }
+}
@@ -0,0 +1,61 @@
+#include <SimpleGL/uniformarena.h>
+#include <SimpleGL/bindcache.h>
+
+#include <string.h>
+#include <algorithm>
+
+using namespace sgl;
+
+UniformArena::UniformArena (size_t capacity, size_t regions) :
+    _buffer(capacity, regions),
+    _alignment(1),
+    _regions(regions),
+    _base(0)
+{
+    GLint align = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    _alignment = std::max<GLint>(align, 1);
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+UniformSlot UniformArena::push (const void* data, size_t size) {
+    size_t offset = detail::alignUp(_staging.size(), _alignment);
+    _staging.resize(offset + size);
+    if (data != nullptr) memcpy(&_staging[offset], data, size);
+    _stats.slots += 1;
+    return UniformSlot{offset, size};
+}
+
+void UniformArena::upload () {
+    if (_staging.empty()) return;
+
+    if (_staging.size() > _buffer.regionSize()) {
+        size_t capacity = std::max(_staging.size(), _buffer.regionSize() * 2);
+        _buffer.release();
+        _buffer = StreamBuffer<GL_UNIFORM_BUFFER, char>(capacity, _regions);
+        _stats.grows += 1;
+    }
+
+    char* dst = _buffer.next();
+    memcpy(dst, &_staging[0], _staging.size());
+    _buffer.commit();
+    _base = _buffer.offset();
+
+    _stats.uploads += 1;
+    _stats.bytes += _staging.size();
+    _staging.clear();
+    sglDbgCatchGLError();
+}
+
+void UniformArena::bind (const UniformSlot& slot, GLuint unit) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, unit, _buffer, _base + slot.offset, slot.size);
+    // glBindBufferRange also binds the generic GL_UNIFORM_BUFFER target
+    BindCache* cache = sgl::getBindCache();
+    if (cache != nullptr) cache->note(GL_UNIFORM_BUFFER, _buffer);
+}
+
+void UniformArena::release () {
+    _buffer.release();
+    _staging.clear();
+    _base = 0;
+}
@@ -0,0 +1,173 @@
+#include <SimpleGL/vertexlayout.h>
+#include <SimpleGL/resource.h>
+#include <SimpleGL/utils.h>
+
+#include <string.h>
+
+using namespace sgl;
+using namespace sgl::detail;
+
+namespace {
+    struct CachedLayout {
+        GLuint vao;
+        uint64_t hash;
+    };
+
+    // Direct mapped on the vertex array name. A collision only costs a re-specification.
+    thread_local CachedLayout __layoutCache[SGL_VERTEX_LAYOUT_CACHE];
+
+    const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    inline void hashValue (uint64_t& hash, uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= FNV_PRIME;
+        }
+    }
+} // end namespace
+
+uint64_t VertexLayout::hash () const {
+    uint64_t hash = FNV_OFFSET;
+    for (uint32_t i = 0; i < attribCount; i++) {
+        const VertexAttrib& a = attribs[i];
+        hashValue(hash, (uint64_t(a.type) << 32) | a.offset);
+        hashValue(hash, (uint64_t(a.components) << 32) | a.attrib);
+        hashValue(hash, a.binding);
+    }
+    for (uint32_t i = 0; i < bindingCount; i++) {
+        const VertexBinding& b = bindings[i];
+        hashValue(hash, (uint64_t(b.index) << 32) | uint32_t(b.stride));
+        hashValue(hash, b.divisor);
+    }
+    return hash;
+}
+
+bool sgl::detail::vertexLayoutCached (GLuint vao, uint64_t hash) {
+    CachedLayout& entry = __layoutCache[vao % SGL_VERTEX_LAYOUT_CACHE];
+    if (entry.vao == vao && entry.hash == hash) return true;
+    entry.vao = vao;
+    entry.hash = hash;
+    return false;
+}
+
+void sgl::detail::forgetVertexLayouts (size_t len, const GLuint* ids) {
+    for (size_t i = 0; i < len; i++) {
+        CachedLayout& entry = __layoutCache[ids[i] % SGL_VERTEX_LAYOUT_CACHE];
+        if (entry.vao == ids[i]) entry.vao = 0;
+    }
+}
+
+void sgl::invalidateVertexLayoutCache () {
+    memset(__layoutCache, 0, sizeof(__layoutCache));
+}
+
+// Pre 4.3 path: every attribute is specified against its buffer
+static void applyPointers (GLuint vao, GLuint ebo, const VertexLayout& layout) {
+    sgl::bind<GL_VERTEX_ARRAY>(vao);
+    if (ebo != 0) sgl::bind<GL_ELEMENT_ARRAY_BUFFER>(ebo);
+    for (uint32_t b = 0; b < layout.bindingCount; b++) {
+        const VertexBinding& binding = layout.bindings[b];
+        if (binding.index == NO_BINDING) continue;
+        sgl::bind<GL_ARRAY_BUFFER>(binding.buffer);
+        for (uint32_t i = 0; i < layout.attribCount; i++) {
+            const VertexAttrib& attrib = layout.attribs[i];
+            if (attrib.binding != binding.index) continue;
+            glEnableVertexAttribArray(attrib.attrib);
+            glVertexAttribPointer(attrib.attrib, attrib.components, attrib.type, GL_FALSE, binding.stride, (GLvoid*)(binding.offset + attrib.offset));
+            glVertexAttribDivisor(attrib.attrib, binding.divisor);
+        }
+    }
+    sgl::bind<GL_VERTEX_ARRAY>(0);
+}
+
+void sgl::detail::applyVertexLayout (GLuint vao, GLuint ebo, const VertexLayout& layout) {
+    if (!SGL_VERTEXATTRIBBINDING_SUPPORTED) {
+        applyPointers(vao, ebo, layout);
+        sglDbgCatchGLError();
+        return;
+    }
+
+    bool cached = vertexLayoutCached(vao, layout.hash());
+    if (SGL_DSA_SUPPORTED) {
+        if (ebo != 0) glVertexArrayElementBuffer(vao, ebo);
+        if (!cached) {
+            for (uint32_t i = 0; i < layout.attribCount; i++) {
+                const VertexAttrib& attrib = layout.attribs[i];
+                glEnableVertexArrayAttrib(vao, attrib.attrib);
+                glVertexArrayAttribFormat(vao, attrib.attrib, attrib.components, attrib.type, GL_FALSE, attrib.offset);
+                glVertexArrayAttribBinding(vao, attrib.attrib, attrib.binding);
+            }
+        }
+        for (uint32_t b = 0; b < layout.bindingCount; b++) {
+            const VertexBinding& binding = layout.bindings[b];
+            if (binding.index == NO_BINDING) continue;
+            glVertexArrayVertexBuffer(vao, binding.index, binding.buffer, binding.offset, binding.stride);
+            if (!cached) glVertexArrayBindingDivisor(vao, binding.index, binding.divisor);
+        }
+    } else {
+        sgl::bind<GL_VERTEX_ARRAY>(vao);
+        if (ebo != 0) sgl::bind<GL_ELEMENT_ARRAY_BUFFER>(ebo);
+        if (!cached) {
+            for (uint32_t i = 0; i < layout.attribCount; i++) {
+                const VertexAttrib& attrib = layout.attribs[i];
+                glEnableVertexAttribArray(attrib.attrib);
+                glVertexAttribFormat(attrib.attrib, attrib.components, attrib.type, GL_FALSE, attrib.offset);
+                glVertexAttribBinding(attrib.attrib, attrib.binding);
+            }
+        }
+        for (uint32_t b = 0; b < layout.bindingCount; b++) {
+            const VertexBinding& binding = layout.bindings[b];
+            if (binding.index == NO_BINDING) continue;
+            glBindVertexBuffer(binding.index, binding.buffer, binding.offset, binding.stride);
+            if (!cached) glVertexBindingDivisor(binding.index, binding.divisor);
+        }
+        sgl::bind<GL_VERTEX_ARRAY>(0);
+    }
+    sglDbgCatchGLError();
+}
+
+void sgl::detail::applyVertexFormat (GLuint vao, GLuint ebo, GLuint vbo, size_t offset, GLsizei stride, GLuint div,
+                                     GLuint firstAttrib, const FieldFormat* fields, size_t count, uint64_t hash)
+{
+    GLuint binding = firstAttrib;
+    if (!SGL_VERTEXATTRIBBINDING_SUPPORTED) {
+        sgl::bind<GL_VERTEX_ARRAY>(vao);
+        if (ebo != 0) sgl::bind<GL_ELEMENT_ARRAY_BUFFER>(ebo);
+        sgl::bind<GL_ARRAY_BUFFER>(vbo);
+        for (size_t i = 0; i < count; i++) {
+            GLuint attrib = firstAttrib + i;
+            glEnableVertexAttribArray(attrib);
+            glVertexAttribPointer(attrib, fields[i].components, fields[i].type, GL_FALSE, stride, (GLvoid*)(offset + fields[i].offset));
+            glVertexAttribDivisor(attrib, div);
+        }
+        sgl::bind<GL_VERTEX_ARRAY>(0);
+    } else if (SGL_DSA_SUPPORTED) {
+        if (ebo != 0) glVertexArrayElementBuffer(vao, ebo);
+        if (!vertexLayoutCached(vao, hash)) {
+            for (size_t i = 0; i < count; i++) {
+                GLuint attrib = firstAttrib + i;
+                glEnableVertexArrayAttrib(vao, attrib);
+                glVertexArrayAttribFormat(vao, attrib, fields[i].components, fields[i].type, GL_FALSE, fields[i].offset);
+                glVertexArrayAttribBinding(vao, attrib, binding);
+            }
+            glVertexArrayBindingDivisor(vao, binding, div);
+        }
+        glVertexArrayVertexBuffer(vao, binding, vbo, offset, stride);
+    } else {
+        sgl::bind<GL_VERTEX_ARRAY>(vao);
+        if (ebo != 0) sgl::bind<GL_ELEMENT_ARRAY_BUFFER>(ebo);
+        if (!vertexLayoutCached(vao, hash)) {
+            for (size_t i = 0; i < count; i++) {
+                GLuint attrib = firstAttrib + i;
+                glEnableVertexAttribArray(attrib);
+                glVertexAttribFormat(attrib, fields[i].components, fields[i].type, GL_FALSE, fields[i].offset);
+                glVertexAttribBinding(attrib, binding);
+            }
+            glVertexBindingDivisor(binding, div);
+        }
+        glBindVertexBuffer(binding, vbo, offset, stride);
+        sgl::bind<GL_VERTEX_ARRAY>(0);
+    }
+    sglDbgCatchGLError();
+}
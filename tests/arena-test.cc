@@ -0,0 +1,80 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+
+#include "sgl-test.h"
+#include <iostream>
+#include <vector>
+
+// A grid of small meshes sharing one MeshArena, drawn with a single VAO bind.
+// Every other mesh is removed and re-added each second to exercise the
+// allocator and defragmentation.
+
+static sgl::MeshData quad (float x, float y, float size) {
+    sgl::MeshBuilder m;
+    for (int i = 0; i < 4; i++) {
+        sgl::MeshVertex v;
+        v.uvcoord = glm::vec2(i & 1, i >> 1);
+        v.position = glm::vec3(x + v.uvcoord.x * size, y + v.uvcoord.y * size, 0);
+        v.normal = glm::vec3(0,0,1);
+        m.addVertex(v);
+    }
+    m.addFace(0,1,3);
+    m.addFace(0,3,2);
+    return m.data;
+}
+
+int main () {
+    sgl::Context ctx{500, 500, "mesh arena test"};
+
+    sgl::Shader shader = sgl::loadShader(TEST_RES("vs.glsl"), TEST_RES("fs.glsl"));
+
+    const int grid = 40;
+    std::vector<sgl::MeshData> data;
+    for (int i = 0; i < grid; i++) {
+        for (int j = 0; j < grid; j++) {
+            data.push_back(quad(-1 + i * 2.0f / grid, -1 + j * 2.0f / grid, 1.5f / grid));
+        }
+    }
+
+    // Deliberately small so the arena has to grow
+    sgl::MeshArena arena(256, 256);
+    std::vector<sgl::ArenaMesh> meshes;
+    for (const auto& d : data) meshes.push_back(arena.add(d));
+
+    sgl::PerspectiveCamera cam(ctx.attrs.width, ctx.attrs.height);
+    cam.position = {0,0,-3};
+    cam.update();
+
+    glViewport(0, 0, ctx.attrs.width, ctx.attrs.height);
+
+    int frame = 0;
+    while (ctx.isAlive()){
+        glClear(GL_COLOR_BUFFER_BIT);
+        ctx.pollEvents();
+
+        if (++frame % 60 == 0) {
+            std::vector<sgl::ArenaMesh> kept;
+            for (size_t i = 0; i < meshes.size(); i++) {
+                if (i % 2 == 0) kept.push_back(meshes[i]);
+                else meshes[i].release();
+            }
+            arena.defragment(kept);
+            for (size_t i = 1; i < data.size(); i += 2) kept.push_back(arena.add(data[i]));
+            meshes.swap(kept);
+            std::cout << "vertices: " << arena.vertices().used() << "/" << arena.vertices().capacity()
+                      << " fragments: " << arena.vertices().fragments() << std::endl;
+        }
+
+        auto sg = sgl::bind_guard(shader);
+        shader.setUniformMatrix4f("cameraMat", cam.getProjection());
+        shader.setUniformMatrix4f("viewMat", cam.getView());
+
+        auto ag = sgl::bind_guard(arena);
+        for (const auto& mesh : meshes) mesh.draw();
+
+        sglCheckGLError();
+        ctx.swapBuffers();
+    }
+
+    arena.release();
+    shader.release();
+}
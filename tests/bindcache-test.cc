@@ -0,0 +1,55 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include "sgl-test.h"
+#include <iostream>
+
+int main () {
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setSize(500, 500)
+        .setTitle("bind cache test")
+        .setBindCache(true, true)
+        .build();
+
+    sgl::Shader shader = sgl::loadShader(TEST_RES("ident_vs.glsl"), TEST_RES("texture_fs.glsl"));
+    sgl::MeshResource renderQuad = sgl::createPlane(1);
+
+    sgl::Texture2D texA = sgl::TextureBuilder2D().build(ctx.attrs.width, ctx.attrs.height);
+    sgl::Texture2D texB = sgl::TextureBuilder2D().build(ctx.attrs.width, ctx.attrs.height);
+    sgl::Slab2D slab{texA, texB};
+
+    glViewport(0, 0, ctx.attrs.width, ctx.attrs.height);
+
+    int frame = 0;
+    while (ctx.isAlive()) {
+        ctx.pollEvents();
+
+        // Several passes rebinding the same program and mesh
+        for (int i = 0; i < 4; i++) {
+            auto bg = sgl::bind_guard(slab.ping().fbo);
+            shader.bind();
+            shader.setTexture("image", slab.pong().texture, 0);
+            renderQuad.bind();
+            glDrawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT, 0);
+            slab.swap();
+        }
+
+        glClear(GL_COLOR_BUFFER_BIT);
+        shader.bind();
+        shader.setTexture("image", slab.pong().texture, 0);
+        renderQuad.bind();
+        glDrawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT, 0);
+
+        ctx.swapBuffers();
+        sglCatchGLError();
+
+        const sgl::BindCacheStats& stats = ctx.bindCache().lastFrameStats();
+        if (frame++ % 60 == 0) {
+            std::cout << "binds: " << stats.binds
+                      << " elided: " << stats.elided
+                      << " mismatches: " << stats.mismatches << std::endl;
+        }
+    }
+
+    slab.release();
+    renderQuad.release();
+    shader.release();
+}
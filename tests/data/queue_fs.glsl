@@ -0,0 +1,10 @@
+#version 330 core
+
+uniform sampler2D image;
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+void main () {
+    FragColor = texture(image, TexCoord).bgra * 0.5;
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec2 uvcoord;
+
+layout (std140) uniform Object {
+    vec4 transform; // xy offset, z scale
+};
+
+out vec2 TexCoord;
+
+void main () {
+    gl_Position = vec4(position.xy * transform.z + transform.xy, 0, 1);
+    TexCoord = uvcoord;
+}
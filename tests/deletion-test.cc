@@ -0,0 +1,51 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include "sgl-test.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main () {
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setSize(500, 500)
+        .setTitle("deletion queue test")
+        .setDeferredDeletion(true)
+        .build();
+
+    sgl::Shader shader = sgl::loadShader(TEST_RES("ident_vs.glsl"), TEST_RES("texture_fs.glsl"));
+    sgl::MeshResource renderQuad = sgl::createPlane(1);
+
+    std::vector<uint8_t> pixels(64 * 64 * 3, 255);
+
+    glViewport(0, 0, ctx.attrs.width, ctx.attrs.height);
+
+    int frame = 0;
+    while (ctx.isAlive()) {
+        ctx.pollEvents();
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // Draw with a texture that is released while the GPU may still be using it
+        sgl::Texture2D tex = sgl::TextureBuilder2D().build(&pixels[0], 64, 64);
+        shader.bind();
+        shader.setTexture("image", tex, 0);
+        renderQuad.bind();
+        glDrawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT, 0);
+        tex.release();
+
+        // Release from a thread that has no context
+        sgl::ArrayBuffer<float> buffer;
+        std::thread([buffer] () mutable { buffer.release(); }).join();
+
+        ctx.swapBuffers();
+        sglCatchGLError();
+
+        if (frame++ % 60 == 0) {
+            sgl::DeletionQueueStats stats = ctx.deletionQueue()->stats();
+            std::cout << "pending: " << ctx.deletionQueue()->pending()
+                      << " deleted: " << stats.deleted
+                      << " delete calls: " << stats.deleteCalls << std::endl;
+        }
+    }
+
+    renderQuad.release();
+    shader.release();
+}
@@ -1,6 +1,7 @@
 #include <SimpleGL/helpers/SimpleGLHelpers.h>
 #include "sgl-test.h"
 
+#include <cstdio>
 #include <vector>
 #include <random>
 #include <climits>
@@ -162,6 +163,7 @@ private:
 template <GLenum kind>
 void visualize (SimState& state, sgl::GLResource<kind>& texture){
     static_assert(sgl::traits::IsTex2D<kind>::value, "Texture must be a texture2D instance");
+    sglGpuScope("visualize");
     glViewport(0, 0, state.width, state.height);
     sgl::bind<GL_FRAMEBUFFER>(0);
     glClearColor(0,0,0,1);
@@ -306,7 +308,12 @@ void applySubtract (
 }
 
 int main () {
-    sgl::Context ctx(500,900,"fluid sim");
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setSize(500, 900)
+        .setTitle("fluid sim")
+        .setGpuProfiler(true)
+        .setTracer()
+        .build();
     SimState state(ctx.attrs.width, ctx.attrs.height);
 
     const char * slabNames [] = {
@@ -406,6 +413,7 @@ int main () {
     while (ctx.isAlive()){
         ctx.pollEvents();
         if (advectVelocity) {
+            sglGpuScope("advect");
             applyAdvect(state,
                 state.velocity.ping(), state.velocity.ping(),
                 state.obstacles, state.velocity.pong(),
@@ -415,6 +423,7 @@ int main () {
         }
 
         if (advectTemperature){
+            sglGpuScope("advect");
             applyAdvect(
                 state,
                 state.velocity.ping(), state.temperature.ping(),
@@ -426,6 +435,7 @@ int main () {
 
 
         if (advectDensity) {
+            sglGpuScope("advect");
             applyAdvect(
                 state,
                 state.velocity.ping(), state.density.ping(),
@@ -435,41 +445,63 @@ int main () {
             state.density.swap();
         }
 
-        applyBouyancy(
-            state,
-            state.velocity.ping(), state.temperature.ping(),
-            state.density.ping(), state.velocity.pong()
-        );
-        state.velocity.swap();
+        {
+            sglGpuScope("bouyancy");
+            applyBouyancy(
+                state,
+                state.velocity.ping(), state.temperature.ping(),
+                state.density.ping(), state.velocity.pong()
+            );
+            state.velocity.swap();
+        }
 
 
         if (renderStage == 1) { visualize(state, slabs[currentSlab].texture); goto end;}
 
-        applyImpulse(state, state.temperature.ping(), state.position, state.impulseTemperature);
-        applyImpulse(state, state.density.ping(), state.position, state.impulseDensity);
-        applyDivergence(state, state.velocity.ping(), state.obstacles, state.divergence);
+        {
+            sglGpuScope("impulse");
+            applyImpulse(state, state.temperature.ping(), state.position, state.impulseTemperature);
+            applyImpulse(state, state.density.ping(), state.position, state.impulseDensity);
+        }
+        {
+            sglGpuScope("divergence");
+            applyDivergence(state, state.velocity.ping(), state.obstacles, state.divergence);
+        }
 
         if (renderStage == 2) { visualize(state, slabs[currentSlab].texture); goto end;}
 
         clearColor(state.pressure.ping().fbo, 0, 0, 0, 0);
 
         for (int i = 0; i < state.numJacobiIterations; i++){
+            sglGpuScope("jacobi");
             applyJacobi(state, state.pressure.ping(), state.divergence, state.obstacles, state.pressure.pong());
             state.pressure.swap();
         }
 
         if (renderStage == 3) { visualize(state, slabs[currentSlab].texture); goto end;}
 
-        applySubtract(
-            state,
-            state.velocity.ping(), state.pressure.ping(),
-            state.obstacles, state.velocity.pong()
-        );
-        state.velocity.swap();
+        {
+            sglGpuScope("subtract");
+            applySubtract(
+                state,
+                state.velocity.ping(), state.pressure.ping(),
+                state.obstacles, state.velocity.pong()
+            );
+            state.velocity.swap();
+        }
 
 
         visualize(state, slabs[currentSlab].texture);
 end:
         ctx.swapBuffers();
+
+        if (ctx.gpuProfiler()->frame() % 300 == 0) {
+            for (const auto& scope : ctx.gpuProfiler()->stats()) {
+                printf("%-10s avg %.3f ms  min %.3f  p99 %.3f\n", scope.name.c_str(), scope.avgMs, scope.minMs, scope.p99Ms);
+            }
+        }
     }
+
+    // Open in about:tracing or ui.perfetto.dev
+    ctx.tracer()->save("fluid-trace.json");
 }
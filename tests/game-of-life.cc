@@ -1,6 +1,7 @@
 #include <SimpleGL/helpers/SimpleGLHelpers.h>
 #include "sgl-test.h"
 #include <array>
+#include <iostream>
 #include <time.h>
 #include <random>
 #include <chrono>
@@ -11,50 +12,12 @@ float randomFloat (float hi, float lo){
     return lo + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (hi - lo)));
 }
 
-struct Surface {
-    sgl::Framebuffer fbo;
-    sgl::Texture2D texture;
-
-    Surface (sgl::Texture2D& texture) :
-        texture(texture)
-    {
-        fbo.attachTexture(texture);
-    }
-};
-
-struct Slab {
-private:
-    Surface _surfA;
-    Surface _surfB;
-    bool _useSurfA;
-
-public:
-    Slab (sgl::Texture2D& a, sgl::Texture2D& b) :
-        _surfA(a),
-        _surfB(b),
-        _useSurfA(true)
-    {}
-
-    Surface& ping () {
-        if (_useSurfA) return _surfA;
-        else return _surfB;
-    }
-
-    Surface& pong () {
-        if (_useSurfA) return _surfB;
-        else return _surfA;
-    }
-
-    void swap () {
-        _useSurfA = !_useSurfA;
-    }
-};
-
 struct SimState {
     sgl::Context ctx;
     sgl::Shader cellShader;
     sgl::Shader shader;
     sgl::MeshResource renderQuad;
+    sgl::SurfacePool pool;
     bool continueSim;
 
     SimState (int width, int height) :
@@ -68,10 +31,10 @@ struct SimState {
 
 };
 
-void renderGOL (SimState& state, Slab& slab){ 
+void renderGOL (SimState& state, sgl::Slab2D& slab){ 
     while (state.ctx.isAlive() && state.continueSim) {
         state.ctx.pollEvents();
-        Surface& current = slab.ping();
+        sgl::Surface2D& current = slab.ping();
         {
             auto bg = sgl::bind_guard(current.fbo);
 
@@ -115,17 +78,14 @@ int main () {
             texData[(y * width + x) * 3] = 255;
         }
 
-        sgl::Texture2D texA = sgl::TextureBuilder2D()
-            .build(width,height);
-
-        sgl::Texture2D texB = sgl::TextureBuilder2D()
-            .build(&texData[0], width, height);
-
-        Slab slab(texA,texB);
+        // Restarts reuse the previous run's surfaces
+        sgl::Slab2D slab = state.pool.acquireSlab(width, height, GL_RGB, GL_RGB8, GL_UNSIGNED_BYTE);
+        sgl::updateTexture(slab.pong().texture, &texData[0]);
 
         renderGOL(state, slab);
 
-        texA.release();
-        texB.release();
+        state.pool.release(slab);
+        state.pool.endFrame();
+        std::cout << "surface pool hit rate: " << state.pool.hitRate() << std::endl;
     }
 }
@@ -0,0 +1,88 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+
+#include <iostream>
+
+// Renders without a display: needs SimpleGL built with SGL_HEADLESS_CONTEXT.
+// On machines without a GPU run with LIBGL_ALWAYS_SOFTWARE=1.
+
+static int failures = 0;
+
+static void check (bool ok, const char* what) {
+    std::cout << (ok ? "ok    " : "FAIL  ") << what << std::endl;
+    if (!ok) failures += 1;
+}
+
+static bool pixelIs (const sgl::Context& ctx, uint8_t r, uint8_t g, uint8_t b) {
+    uint8_t pixel[4];
+    glReadPixels(ctx.attrs.width / 2, ctx.attrs.height / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    return pixel[0] == r && pixel[1] == g && pixel[2] == b;
+}
+
+int main () {
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setSize(64, 64)
+        .setHeadless(true)
+        .setBindCache(true)
+        .build();
+
+    check(ctx.headless() && ctx.framebuffer() != 0, "context renders offscreen");
+    std::cout << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+
+    GLint bound = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+    check(GLuint(bound) == ctx.framebuffer(), "framebuffer bound on creation");
+
+    sgl::Shader shader = sgl::compileShader(
+        "#version 330 core\n"
+        "void main () {\n"
+        "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+        "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n",
+        "#version 330 core\n"
+        "uniform vec4 Color;\n"
+        "out vec4 color;\n"
+        "void main () { color = Color; }\n");
+    sgl::VertexArray vao;
+
+    glClearColor(1, 0, 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    check(pixelIs(ctx, 255, 0, 0), "clear");
+
+    // Unbinding a framebuffer binds the offscreen one, not 0
+    sgl::Texture2D texture = sgl::TextureBuilder2D().build(16, 16);
+    sgl::Surface2D surface(texture);
+    {
+        auto bg = sgl::bind_guard(surface.fbo);
+        glClearColor(0, 0, 1, 1);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    check(pixelIs(ctx, 255, 0, 0), "unbinding returns to the offscreen framebuffer");
+
+    int frames = 0;
+    while (ctx.isAlive()) {
+        ctx.pollEvents();
+        shader.bind();
+        shader.setUniform4fv("Color", 0, 1, 0, 1);
+        vao.bind();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        ctx.swapBuffers();
+        if (++frames == 3) ctx.close();
+    }
+    check(pixelIs(ctx, 0, 255, 0), "draw");
+
+    // Framebuffer 0 is read from the offscreen framebuffer
+    sgl::ReadbackQueue readback(1);
+    {
+        sgl::ReadbackView<uint8_t> view = readback.read(0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE).map<uint8_t>();
+        check(view[0] == 0 && view[1] == 255 && view[2] == 0, "readback of framebuffer 0");
+    }
+    readback.release();
+    check(glGetError() == GL_NO_ERROR, "no GL errors");
+
+    surface.release();
+    vao.release();
+    shader.release();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include "sgl-test.h"
+#include <iostream>
+#include <vector>
+
+// Textures are generated and uploaded on a loader thread and drawn once handed over
+
+static sgl::Texture2D makeTexture (int seed, int size) {
+    std::vector<uint8_t> pixels(size * size * 3);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            uint8_t* p = &pixels[(y * size + x) * 3];
+            p[0] = (x * seed) & 0xff;
+            p[1] = (y * seed) & 0xff;
+            p[2] = ((x ^ y) * seed) & 0xff;
+        }
+    }
+    return sgl::TextureBuilder2D().build(&pixels[0], size, size);
+}
+
+int main () {
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setSize(500, 500)
+        .setTitle("loader test")
+        .setLoaderThreads(2)
+        .build();
+
+    sgl::Shader shader = sgl::loadShader(TEST_RES("ident_vs.glsl"), TEST_RES("texture_fs.glsl"));
+    sgl::MeshResource renderQuad = sgl::createPlane(1);
+
+    std::vector<sgl::Texture2D> textures;
+    for (int i = 1; i <= 16; i++) {
+        ctx.loader()->load(
+            [=] () { return makeTexture(i, 1024); },
+            [&] (sgl::Texture2D& tex) { textures.push_back(tex); });
+    }
+
+    glViewport(0, 0, ctx.attrs.width, ctx.attrs.height);
+
+    int frame = 0;
+    while (ctx.isAlive()) {
+        ctx.pollEvents();
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        if (!textures.empty()) {
+            shader.bind();
+            shader.setTexture("image", textures[(frame / 30) % textures.size()], 0);
+            renderQuad.bind();
+            glDrawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT, 0);
+        }
+
+        ctx.swapBuffers();
+        sglCatchGLError();
+
+        if (frame++ % 60 == 0) {
+            std::cout << "loaded: " << textures.size() << " pending: " << ctx.loader()->pending() << std::endl;
+        }
+    }
+
+    for (auto& tex : textures) tex.release();
+    renderQuad.release();
+    shader.release();
+}
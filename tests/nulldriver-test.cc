@@ -0,0 +1,141 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include <SimpleGL/nulldriver.h>
+#include <SimpleGL/indirect.h>
+
+#include <iostream>
+
+// Runs without a window or GPU: checks the GL calls the bind cache and
+// command lists make, and that the null driver catches invalid transitions.
+
+static int failures = 0;
+
+static void check (bool ok, const char* what) {
+    std::cout << (ok ? "ok    " : "FAIL  ") << what << std::endl;
+    if (!ok) failures += 1;
+}
+
+int main () {
+    sgl::NullDriver driver;
+    driver.install();
+
+    sgl::Shader shader = sgl::compileShader(
+        "#version 330 core\nvoid main () { gl_Position = vec4(0.0); }\n",
+        "#version 330 core\nuniform float Alpha;\nout vec4 color;\nvoid main () { color = vec4(Alpha); }\n");
+    sgl::VertexArray vao;
+    sgl::ArrayBuffer<sgl::vec4f> buffer;
+    sgl::Texture2D texture = sgl::TextureBuilder2D().build(16, 16);
+    check(driver.errors().empty(), "resources created without errors");
+
+    // Redundant binds are elided once a cache is installed
+    sgl::BindCache cache;
+    sgl::setBindCache(&cache);
+    driver.resetCalls();
+    for (int i = 0; i < 10; i++) {
+        shader.bind();
+        vao.bind();
+    }
+    check(driver.calls(sgl::NULL_glUseProgram) == 1, "bind cache elides glUseProgram");
+    check(driver.calls(sgl::NULL_glBindVertexArray) == 1, "bind cache elides glBindVertexArray");
+    check(driver.bound(GL_PROGRAM) == shader, "program bound");
+
+    // Once the cache is warm, every replay issues the same calls
+    sgl::CommandList list;
+    for (int i = 0; i < 4; i++) {
+        list.bind(shader);
+        list.uniform(shader, "Alpha", 0.5f);
+        list.texture(0, texture);
+        list.bind(vao);
+        list.drawArrays(GL_TRIANGLES, 0, 3);
+    }
+    list.end();
+    list.replay();
+    driver.resetCalls();
+    list.replay();
+    uint64_t first = driver.totalCalls();
+    list.replay();
+    check(driver.totalCalls() == 2 * first, "replays issue the same number of calls");
+    check(driver.calls(sgl::NULL_glDrawArrays) == 8, "every draw replayed");
+    check(driver.calls(sgl::NULL_glUseProgram) == 0, "warm cache elides every program bind");
+    check(driver.errors().empty(), "replay is valid");
+
+    // Array and multisample texture targets replay as texture binds
+    GLuint arrays[2];
+    glGenTextures(2, arrays);
+    sgl::CommandList arrayList;
+    arrayList.bind(GL_TEXTURE_2D_ARRAY, arrays[0]);
+    arrayList.bind(GL_TEXTURE_2D_MULTISAMPLE, arrays[1]);
+    arrayList.end();
+    driver.resetCalls();
+    arrayList.replay();
+    check(driver.calls(sgl::NULL_glBindTexture) == 2 && driver.calls(sgl::NULL_glBindBuffer) == 0, "array textures bound as textures");
+
+    // A texture bind after switching units isn't redundant
+    sgl::CommandList unitList;
+    unitList.bind(GL_TEXTURE_2D, arrays[0]);
+    unitList.texture(1, GL_TEXTURE_2D, arrays[1]);
+    unitList.bind(GL_TEXTURE_2D, arrays[0]);
+    unitList.end();
+    unitList.replay();
+    check(unitList.size() == 3 && driver.bound(GL_TEXTURE_2D) == arrays[0], "texture binds follow the active unit");
+    glDeleteTextures(2, arrays);
+    sgl::setBindCache(nullptr);
+
+    // Without indirect draws a batch draws its commands one at a time
+    sgl::sglInitialize(3, 3);
+    sgl::IndirectBatch<sgl::DrawElementsIndirectCommand> batch;
+    batch.add(sgl::drawElementsCommand(6));
+    batch.add(sgl::drawElementsCommand(3, 6, 4));
+    batch.add(sgl::drawElementsCommand(3, 9, 0, 0));
+    shader.bind();
+    driver.resetCalls();
+    batch.submit(vao, GL_TRIANGLES);
+    check(driver.calls(sgl::NULL_glDrawElementsInstancedBaseVertex) == 2, "batch falls back to instanced draws");
+    check(driver.calls(sgl::NULL_glMultiDrawElementsIndirect) == 0 && driver.calls(sgl::NULL_glDrawElementsIndirect) == 0, "no indirect draws before OpenGL 4.0");
+    batch.release();
+    sgl::sglInitialize(SGL_OPENGL_MAX_MAJOR, SGL_OPENGL_MAX_MINOR);
+
+    // Items without textures sort apart from the first texture set
+    sgl::RenderQueue renderQueue;
+    renderQueue.add(shader, vao).texture(0, texture).arrays(GL_TRIANGLES, 0, 3);
+    renderQueue.add(shader, vao).arrays(GL_TRIANGLES, 0, 3);
+    renderQueue.add(shader, vao).texture(0, texture).arrays(GL_TRIANGLES, 0, 3);
+    renderQueue.flush();
+    check(renderQueue.stats().textureChanges == 1, "untextured items sort before textured ones");
+
+    // Invalid transitions are reported
+    glUseProgram(0);
+    shader.setUniform1f("Alpha", 1.0f);
+    check(driver.errors().size() == 1 && driver.errors()[0].call == sgl::NULL_glUniform1f, "uniform without a program");
+    driver.clearErrors();
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, 16, nullptr);
+    check(driver.errors().size() == 1, "upload to an unbound buffer");
+    driver.clearErrors();
+
+    glBindTexture(GL_TEXTURE_2D, 12345);
+    check(driver.errors().size() == 1 && glGetError() == GL_INVALID_OPERATION, "bind a name never generated");
+    driver.clearErrors();
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    check(driver.errors().size() == 1, "draw without a program");
+    driver.clearErrors();
+
+    // Vertex arrays aren't shared between contexts, so they skip the deletion queue
+    sgl::DeletionQueue queue;
+    sgl::setDeletionQueue(&queue);
+    driver.resetCalls();
+    vao.release();
+    buffer.release();
+    check(driver.calls(sgl::NULL_glDeleteVertexArrays) == 1 && queue.pending() == 1, "vertex arrays deleted immediately");
+    queue.flush();
+    sgl::setDeletionQueue(nullptr);
+
+    texture.release();
+    shader.release();
+    check(driver.liveObjects() == 0, "every object deleted");
+
+    driver.uninstall();
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
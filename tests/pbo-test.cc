@@ -16,6 +16,11 @@ int main () {
 
     sgl::PBOUploader uploader(tex);
 
+    // Sub-rectangle uploads through a second uploader with copy workers
+    sgl::PBOUploader tiles(3, 2);
+    std::array<char,100*100*3> tile;
+    tile.fill(127);
+
     int frame = 0;
     glViewport(0,0,500,500);
 
@@ -27,6 +32,12 @@ int main () {
             data[i] = frame;
         }
         uploader.update(data);
+        tiles.upload(tex, &tile[0], sgl::UploadRegion(200, 200, 100, 100));
+
+        if (frame == 0) {
+            std::cout << "bandwidth: " << uploader.stats().bandwidth() / 1e6 << " MB/s"
+                      << " stalls: " << uploader.stats().stalls << std::endl;
+        }
 
         glClear(GL_COLOR_BUFFER_BIT);
 
@@ -38,4 +49,7 @@ int main () {
 
         ctx.swapBuffers();
     }
+
+    uploader.release();
+    tiles.release();
 }
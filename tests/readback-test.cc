@@ -0,0 +1,84 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include "sgl-test.h"
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include <stdlib.h>
+#include <time.h>
+
+// Game of life on a Slab2D, with the live cell count streamed back to the
+// CPU every frame through a ReadbackQueue instead of a blocking glReadPixels.
+
+int main () {
+    const int width = 500;
+    const int height = 500;
+
+    sgl::Context ctx{width, height, "readback test"};
+    sgl::Shader cellShader = sgl::loadShader(TEST_RES("ident_vs.glsl"), TEST_RES("game-of-life_fs.glsl"));
+    sgl::Shader shader = sgl::loadShader(TEST_RES("ident_vs.glsl"), TEST_RES("texture_fs.glsl"));
+    sgl::MeshResource renderQuad = sgl::createPlane(1);
+
+    srand(time(NULL));
+    std::vector<uint8_t> texData(width * height * 3, 0);
+    for (int i = 0; i < 300 * 100; i++) {
+        texData[(rand() % (width * height)) * 3] = 255;
+    }
+
+    sgl::Texture2D texA = sgl::TextureBuilder2D().build(width, height);
+    sgl::Texture2D texB = sgl::TextureBuilder2D().build(&texData[0], width, height);
+    sgl::Slab2D slab(texA, texB);
+
+    sgl::ReadbackQueue readback(3);
+    std::deque<sgl::ReadbackTicket> tickets;
+
+    glViewport(0, 0, width, height);
+    int frame = 0;
+    while (ctx.isAlive()) {
+        ctx.pollEvents();
+
+        sgl::Surface2D& current = slab.ping();
+        {
+            auto bg = sgl::bind_guard(current.fbo);
+            cellShader.bind();
+            cellShader.setTexture("image", slab.pong().texture, 0);
+            renderQuad.bind();
+            glDrawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT, 0);
+        }
+        tickets.push_back(readback.read(current.fbo, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE));
+        slab.swap();
+
+        // Results arrive a frame or two later
+        while (!tickets.empty() && tickets.front().ready()) {
+            auto view = tickets.front().map<uint8_t>();
+            size_t alive = 0;
+            for (GLsizei y = 0; y < view.height(); y++) {
+                const uint8_t* row = view.row(y);
+                for (GLsizei x = 0; x < view.width(); x++) alive += row[x] > 127;
+            }
+            tickets.pop_front();
+            if (frame % 60 == 0) std::cout << "alive: " << alive << std::endl;
+        }
+        while (!tickets.empty() && !tickets.front().valid()) tickets.pop_front();
+
+        glClear(GL_COLOR_BUFFER_BIT);
+        shader.bind();
+        shader.setTexture("image", current.texture, 0);
+        renderQuad.bind();
+        glDrawElements(GL_TRIANGLES, renderQuad.size, GL_UNSIGNED_INT, 0);
+
+        ctx.swapBuffers();
+        sglCatchGLError();
+        frame += 1;
+    }
+
+    const sgl::ReadbackStats& stats = readback.stats();
+    std::cout << "reads: " << stats.reads << " resolved: " << stats.resolved
+              << " dropped: " << stats.dropped << " stalls: " << stats.stalls << std::endl;
+
+    readback.release();
+    slab.release();
+    renderQuad.release();
+    cellShader.release();
+    shader.release();
+}
@@ -0,0 +1,128 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+
+#include <iostream>
+
+// Multiple render targets through attachColorTextures and RenderPass, read
+// back with a ReadbackQueue. Uses direct state access on OpenGL 4.5; build
+// with SGL_NO_DSA to check the bind to edit path.
+
+static int failures = 0;
+
+static void check (bool ok, const char* what) {
+    std::cout << (ok ? "ok    " : "FAIL  ") << what << std::endl;
+    if (!ok) failures += 1;
+}
+
+// Texel (x, y) of texture is (r, g, b, a)
+static bool texelIs (sgl::ReadbackQueue& readback, sgl::Texture2D& texture, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    sgl::ReadbackView<uint8_t> view = readback.readTexture(texture, GL_RGBA, GL_UNSIGNED_BYTE).map<uint8_t>();
+    const uint8_t* texel = view.row(y) + x * 4;
+    return texel[0] == r && texel[1] == g && texel[2] == b && texel[3] == a;
+}
+
+static sgl::Texture2D rgba8 (GLsizei size) {
+    return sgl::TextureBuilder2D()
+        .format(GL_RGBA, GL_RGBA8)
+        .dataType(GL_UNSIGNED_BYTE)
+        .build(size, size);
+}
+
+int main () {
+    const GLsizei size = 16;
+    sgl::Context ctx = sgl::ContextBuilder()
+        .setSize(64, 64)
+        .setVisible(false)
+        .setHeadless(SGL_HEADLESS_CONTEXT != 0)
+        .build();
+
+    std::cout << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION)
+              << (SGL_DSA_SUPPORTED ? ", DSA" : "") << std::endl;
+
+    sgl::Texture2D a = rgba8(size);
+    sgl::Texture2D b = rgba8(size);
+    sgl::Texture2D c = rgba8(size);
+    sgl::Texture2D depth = sgl::TextureBuilder2D()
+        .format(GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT24)
+        .dataType(GL_UNSIGNED_INT)
+        .build(size, size);
+
+    sgl::Framebuffer fbo;
+    fbo.attachColorTextures(a, b, c);
+    fbo.attachTexture(depth, GL_DEPTH_ATTACHMENT);
+    fbo.bind();
+    check(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "framebuffer complete");
+
+    sgl::ReadbackQueue readback(3);
+
+    // Every output of one draw reaches its attachment
+    sgl::Shader shader = sgl::compileShader(
+        "#version 330 core\n"
+        "void main () {\n"
+        "    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+        "    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);\n"
+        "}\n",
+        "#version 330 core\n"
+        "layout(location = 0) out vec4 out0;\n"
+        "layout(location = 1) out vec4 out1;\n"
+        "layout(location = 2) out vec4 out2;\n"
+        "void main () {\n"
+        "    out0 = vec4(1, 0, 0, 1);\n"
+        "    out1 = vec4(0, 1, 0, 1);\n"
+        "    out2 = vec4(0, 0, 1, 1);\n"
+        "}\n");
+    sgl::VertexArray vao;
+
+    glViewport(0, 0, size, size);
+    shader.bind();
+    vao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    check(texelIs(readback, a, 8, 8, 255, 0, 0, 255), "draw writes attachment 0");
+    check(texelIs(readback, b, 8, 8, 0, 255, 0, 255), "draw writes attachment 1");
+    check(texelIs(readback, c, 8, 8, 0, 0, 255, 255), "draw writes attachment 2");
+
+    // Each attachment cleared to its own value
+    sgl::RenderPass clear(fbo);
+    clear.clearColor(0, 0, 0, 1, 1)
+         .clearColor(1, 1, 1, 0, 1)
+         .clearColor(2, 1, 0, 1, 0)
+         .depth(sgl::LOAD_CLEAR);
+    clear.begin();
+    clear.end();
+    check(texelIs(readback, a, 0, 0, 0, 0, 255, 255), "clear attachment 0");
+    check(texelIs(readback, b, 15, 15, 255, 255, 0, 255), "clear attachment 1");
+    check(texelIs(readback, c, 3, 12, 255, 0, 255, 0), "clear attachment 2");
+
+    // Attachments the pass doesn't describe are left alone
+    sgl::RenderPass last(fbo);
+    last.clearColor(2, 1, 1, 1, 1);
+    last.begin();
+    last.end();
+    check(texelIs(readback, a, 8, 8, 0, 0, 255, 255), "undescribed attachment 0 untouched");
+    check(texelIs(readback, b, 8, 8, 255, 255, 0, 255), "undescribed attachment 1 untouched");
+    check(texelIs(readback, c, 8, 8, 255, 255, 255, 255), "clear attachment 2 by index");
+
+    // Discarding some attachments keeps the preserved ones
+    sgl::RenderPass discard(fbo);
+    discard.color(0)
+           .color(1, sgl::LOAD_DISCARD, sgl::STORE_DISCARD)
+           .clearColor(2, 0, 0, 0, 1)
+           .depth(sgl::LOAD_DISCARD, sgl::STORE_DISCARD);
+    discard.begin();
+    discard.end();
+    check(texelIs(readback, a, 8, 8, 0, 0, 255, 255), "preserved attachment kept");
+    check(texelIs(readback, c, 8, 8, 0, 0, 0, 255), "cleared next to a discarded attachment");
+    check(glGetError() == GL_NO_ERROR, "no GL errors");
+
+    fbo.unbind();
+    readback.release();
+    vao.release();
+    shader.release();
+    fbo.release();
+    depth.release();
+    c.release();
+    b.release();
+    a.release();
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include "sgl-test.h"
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// A grid of quads submitted in random order, drawn sorted by state
+
+struct Object {
+    float transform[4];
+};
+
+int main () {
+    sgl::Context ctx{500, 500, "render queue"};
+    sglClearGLError();
+
+    sgl::Shader shaders[2] = {
+        sgl::loadShader(TEST_RES("queue_vs.glsl"), TEST_RES("texture_fs.glsl")),
+        sgl::loadShader(TEST_RES("queue_vs.glsl"), TEST_RES("queue_fs.glsl"))
+    };
+    // Samplers and block bindings are set once per program, the queue binds
+    // texture i to unit i and each item's uniform range to its unit
+    for (auto& shader : shaders) {
+        shader.bind();
+        shader.setTexture("image", GL_TEXTURE_2D, 0, 0);
+        GLuint idx = glGetUniformBlockIndex(shader, "Object");
+        if (idx != GL_INVALID_INDEX) glUniformBlockBinding(shader, idx, 0);
+    }
+
+    std::vector<sgl::Texture2D> textures;
+    for (int i = 0; i < 4; i++) {
+        std::vector<uint8_t> pixels(16 * 16 * 3);
+        for (size_t p = 0; p < pixels.size(); p++) pixels[p] = (p * (i + 1) * 37) & 0xff;
+        textures.push_back(sgl::TextureBuilder2D().build(&pixels[0], 16, 16));
+    }
+
+    sgl::MeshResource quad = sgl::createPlane(1);
+    sgl::UniformArena arena;
+    sgl::RenderQueue queue;
+
+    const int grid = 64;
+    glViewport(0, 0, ctx.attrs.width, ctx.attrs.height);
+
+    int frame = 0;
+    while (ctx.isAlive()) {
+        ctx.pollEvents();
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        srand(frame / 60);
+        for (int i = 0; i < grid * grid; i++) {
+            Object object = {{ (i % grid) * 2.0f / grid - 1, (i / grid) * 2.0f / grid - 1, 1.0f / grid, 0 }};
+            sgl::UniformSlot slot = arena.push(object);
+            queue.add(shaders[rand() % 2], quad)
+                .texture(0, textures[rand() % textures.size()])
+                .uniformBlock(arena, slot, 0)
+                .elements(GL_TRIANGLES, quad.size);
+        }
+        arena.upload();
+        queue.flush();
+
+        ctx.swapBuffers();
+        sglCatchGLError();
+
+        if (frame++ % 60 == 0) {
+            const sgl::RenderQueueStats& stats = queue.stats();
+            std::cout << "draws: " << stats.draws
+                      << " program changes: " << stats.programChanges << " (saved " << stats.programSaved << ")"
+                      << " texture changes: " << stats.textureChanges << " (saved " << stats.textureSaved << ")"
+                      << " vao changes: " << stats.vaoChanges << std::endl;
+        }
+    }
+
+    for (auto& tex : textures) tex.release();
+    for (auto& shader : shaders) shader.release();
+    arena.release();
+    quad.release();
+}
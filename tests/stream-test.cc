@@ -0,0 +1,66 @@
+#include <SimpleGL/helpers/SimpleGLHelpers.h>
+#include "sgl-test.h"
+#include <iostream>
+#include <vector>
+
+#include <math.h>
+
+// Animated point cloud rewritten every frame through a StreamBuffer
+
+int main () {
+    sgl::Context ctx{500, 500, "stream buffer"};
+    sglClearGLError();
+
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+
+    sgl::PerspectiveCamera cam{ctx.attrs.width, ctx.attrs.height};
+    cam.position = {0,3,5};
+    cam.looking = {0,0,0};
+    cam.update();
+
+    sgl::Shader pcShader = sgl::loadShader(TEST_RES("pointcloud_vs.glsl"),TEST_RES("pointcloud_fs.glsl"));
+
+    const size_t count = 10000;
+    sgl::StreamBuffer<GL_ARRAY_BUFFER, sgl::vec4f> points(count);
+
+    sgl::VertexArray vao;
+    sgl::vertexAttribBuilder(vao)
+        .addBuffer<sgl::vec3f, float>(points)
+        .commit();
+
+    std::cout << "persistent: " << points.isPersistent() << std::endl;
+
+    glViewport(0,0, ctx.attrs.width, ctx.attrs.height);
+    glClearColor(0,0,0,0);
+
+    float t = 0;
+    while (ctx.isAlive()){
+        ctx.pollEvents();
+        t += 0.01f;
+
+        sgl::vec4f* dst = points.next();
+        for (size_t i = 0; i < count; i++) {
+            float a = i * 0.01f + t;
+            float r = (i % 100) / 100.0f;
+            dst[i] = {{ cosf(a) * r, sinf(a * 0.5f), sinf(a) * r, 2.0f }};
+        }
+        points.commit();
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        pcShader.bind();
+        pcShader.setUniformMatrix4f("cameraMat", cam.getProjection());
+        pcShader.setUniformMatrix4f("viewMat", cam.getView());
+
+        auto bg = sgl::bind_guard(vao);
+        glDrawArrays(GL_POINTS, points.first(), count);
+
+        ctx.swapBuffers();
+        sglCatchGLError();
+    }
+
+    std::cout << "frames: " << points.stats().frames << " stalls: " << points.stats().stalls << std::endl;
+    points.release();
+    vao.release();
+    pcShader.release();
+}